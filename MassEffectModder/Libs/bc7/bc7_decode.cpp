@@ -51,12 +51,12 @@ CMP_DWORD BC7BlockDecoder::ReadBit(const CMP_BYTE base[]) {
 }
 
 
-void BC7BlockDecoder::DecompressDualIndexBlock(double  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+void BC7BlockDecoder::DecompressDualIndexBlock(float  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
         CMP_BYTE   in[COMPRESSED_BLOCK_SIZE],
         CMP_DWORD  endpoint[2][MAX_DIMENSION_BIG]) {
     CMP_DWORD i, j, k;
 
-    double  ramp[MAX_DIMENSION_BIG][1<<MAX_INDEX_BITS];
+    float  ramp[MAX_DIMENSION_BIG][1<<MAX_INDEX_BITS];
     CMP_DWORD   blockIndices[2][MAX_SUBSET_SIZE];
 
     CMP_DWORD   clusters[2];
@@ -100,7 +100,7 @@ void BC7BlockDecoder::DecompressDualIndexBlock(double  out[MAX_SUBSET_SIZE][MAX_
     }
 
     // Resolve the component rotation
-    double swap;
+    float swap;
     for(i=0; i<MAX_SUBSET_SIZE; i++) {
         switch(m_rotation) {
         case    0:
@@ -130,7 +130,7 @@ void BC7BlockDecoder::DecompressDualIndexBlock(double  out[MAX_SUBSET_SIZE][MAX_
 
 
 
-void BC7BlockDecoder::DecompressBlock(double  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+void BC7BlockDecoder::DecompressBlock(float  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                                       CMP_BYTE   in[COMPRESSED_BLOCK_SIZE]) {
     CMP_DWORD           i,j;
     CMP_DWORD           *partitionTable;
@@ -279,7 +279,7 @@ void BC7BlockDecoder::DecompressBlock(double  out[MAX_SUBSET_SIZE][MAX_DIMENSION
     clusters[0] = clusters[1] = 1 << bti_cpu[m_blockMode].indexBits[0];
 
     // Colour Ramps
-    double          c[MAX_SUBSETS][MAX_DIMENSION_BIG][1<<MAX_INDEX_BITS];
+    float          c[MAX_SUBSETS][MAX_DIMENSION_BIG][1<<MAX_INDEX_BITS];
 
     for(i=0; i<(int)bti_cpu[m_blockMode].subsetCount; i++) {
         // Unpack the colours
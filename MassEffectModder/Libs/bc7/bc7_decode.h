@@ -31,12 +31,12 @@ class BC7BlockDecoder {
     BC7BlockDecoder() {};
     ~BC7BlockDecoder() {};
 
-    void DecompressBlock(double  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+    void DecompressBlock(float  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                          CMP_BYTE   in[COMPRESSED_BLOCK_SIZE]);
 
   private:
 
-    void DecompressDualIndexBlock(double  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+    void DecompressDualIndexBlock(float  out[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                                   CMP_BYTE   in[COMPRESSED_BLOCK_SIZE],
                                   CMP_DWORD  endpoint[2][MAX_DIMENSION_BIG]);
 
@@ -38,11 +38,11 @@
 // Default FQuality is at 0.1 < g_qFAST_THRESHOLD which will cause the SingleIndex compression to start skipping shape blocks
 // during compression
 // if user sets a value above this then all shapes will be used for compression scan for quality
-double g_qFAST_THRESHOLD  = 0.5;
+float g_qFAST_THRESHOLD  = 0.5;
 
 // This limit is used for DualIndex Block and if fQuality is above this limit then Quantization shaking will always be performed
 // on all indexs
-double g_HIGHQULITY_THRESHOLD = 0.7;
+float g_HIGHQULITY_THRESHOLD = 0.7;
 //
 // For a given block mode this sets up the data needed by the compressor
 //
@@ -291,8 +291,8 @@ void BC7BlockEncoder::EncodeSingleIndexBlock(CMP_DWORD blockMode,
 //BYTE BlankBC7Block[16] = { 0x40, 0xC0, 0x1F, 0xF0, 0x07, 0xFC, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
 
-double BC7BlockEncoder::CompressSingleIndexBlock(
-    double      in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+float BC7BlockEncoder::CompressSingleIndexBlock(
+    float      in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
     CMP_BYTE    out[COMPRESSED_BLOCK_SIZE],
     CMP_DWORD   blockMode) {
     CMP_DWORD   i, k, n;
@@ -310,12 +310,12 @@ double BC7BlockEncoder::CompressSingleIndexBlock(
 
     // Linearly reduce the number of partitions to try as the quality falls below a threshold
     if(m_quality < g_qFAST_THRESHOLD) {
-        partitionsToTry = (CMP_DWORD)floor((double)(partitionsToTry * m_partitionSearchSize) + 0.5);
+        partitionsToTry = (CMP_DWORD)floor((float)(partitionsToTry * m_partitionSearchSize) + 0.5);
         partitionsToTry = MIN(numPartitionModes, MAX(1, partitionsToTry));
     }
 
     CMP_DWORD   blockPartition;
-    double      partition[MAX_SUBSETS][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+    float      partition[MAX_SUBSETS][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
     CMP_DWORD   entryCount[MAX_SUBSETS];
     CMP_DWORD   subset;
 
@@ -332,10 +332,10 @@ double BC7BlockEncoder::CompressSingleIndexBlock(
                   dimension);
 
 
-        double  error = 0.;
-        double  outB[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
-        double  direction[MAX_DIMENSION_BIG];
-        double  step;
+        float  error = 0.;
+        float  outB[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+        float  direction[MAX_DIMENSION_BIG];
+        float  step;
 
         for(subset=0; subset < bti_cpu[blockMode].subsetCount; subset++) {
             int     indices[MAX_SUBSETS][MAX_SUBSET_SIZE];
@@ -403,14 +403,14 @@ double BC7BlockEncoder::CompressSingleIndexBlock(
     }
 
     int     epo_code[MAX_SUBSETS][2][MAX_DIMENSION_BIG];
-    double  epo[2][MAX_DIMENSION_BIG];
-    double  outB[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+    float  epo[2][MAX_DIMENSION_BIG];
+    float  outB[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
 
     int     bestEndpoints[MAX_SUBSETS][2][MAX_DIMENSION_BIG];
     int     bestIndices[MAX_SUBSETS][MAX_SUBSET_SIZE];
     CMP_DWORD   bestEntryCount[MAX_SUBSETS];
     CMP_DWORD   bestPartition = 0;
-    double  bestError = DBL_MAX;
+    float  bestError = FLT_MAX;
 
     // Extensive shaking is most important when the ramp is short, and
     // when we have less indices. On a long ramp the quality of the
@@ -436,7 +436,7 @@ double BC7BlockEncoder::CompressSingleIndexBlock(
 
     // Now do the endpoint shaking
     for(i=0; i < numShakeAttempts; i++) {
-        double error = 0;
+        float error = 0;
 
         blockPartition = m_sortedModes[i];
 
@@ -464,7 +464,7 @@ double BC7BlockEncoder::CompressSingleIndexBlock(
                                            dimension,
                                            epo);
                 } else {
-                    double  tempError[2];
+                    float  tempError[2];
                     int     tempIndices[MAX_SUBSET_SIZE];
                     int     temp_epo_code[2][MAX_DIMENSION_BIG];
 
@@ -724,12 +724,12 @@ void BC7BlockEncoder::EncodeDualIndexBlock(CMP_DWORD blockMode,
 }
 
 
-double BC7BlockEncoder::CompressDualIndexBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+float BC7BlockEncoder::CompressDualIndexBlock(float in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
         CMP_BYTE   out[COMPRESSED_BLOCK_SIZE],
         CMP_DWORD  blockMode) {
     CMP_DWORD   i;
-    double  cBlock[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
-    double  aBlock[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+    float  cBlock[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+    float  aBlock[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
 
     CMP_DWORD maxRotation = 1 << bti_cpu[blockMode].rotationBits;
     CMP_DWORD rotation;
@@ -738,14 +738,14 @@ double BC7BlockEncoder::CompressDualIndexBlock(double in[MAX_SUBSET_SIZE][MAX_DI
     CMP_DWORD indexSelection;
 
     int        indices[2][MAX_SUBSET_SIZE];
-    double  outQ[2][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
-    double  direction[MAX_DIMENSION_BIG];
-    double  step;
+    float  outQ[2][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG];
+    float  direction[MAX_DIMENSION_BIG];
+    float  step;
 
-    double quantizerError;
-    double bestQuantizerError = DBL_MAX;
-    double overallError;
-    double bestOverallError   = DBL_MAX;
+    float quantizerError;
+    float bestQuantizerError = FLT_MAX;
+    float overallError;
+    float bestOverallError   = FLT_MAX;
 
     // Go through each possible rotation and selection of indices
     for(rotation = 0; rotation < maxRotation; rotation++) {
@@ -832,7 +832,7 @@ double BC7BlockEncoder::CompressDualIndexBlock(double in[MAX_SUBSET_SIZE][MAX_DI
 
                 overallError = 0;
                 int     epo_code[2][2][MAX_DIMENSION_BIG];
-                double  epo[2][MAX_DIMENSION_BIG];
+                float  epo[2][MAX_DIMENSION_BIG];
 
                 if(m_blockMaxRange > m_shakerRangeThreshold) {
                     overallError += ep_shaker_2_d(cBlock,
@@ -933,7 +933,7 @@ double BC7BlockEncoder::CompressDualIndexBlock(double in[MAX_SUBSET_SIZE][MAX_DI
 //
 //
 
-double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+float BC7BlockEncoder::CompressBlock(float in[MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                                       CMP_BYTE   out[COMPRESSED_BLOCK_SIZE]) {
     CMP_DWORD   i, j;
     bool    blockNeedsAlpha        = false;
@@ -942,7 +942,7 @@ double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_B
     bool    encodedBlock           = false;
 
         for(i=0; i<MAX_DIMENSION_BIG; i++) {
-            m_blockMin[i] = DBL_MAX;
+            m_blockMin[i] = FLT_MAX;
             m_blockMax[i] = 0.0;
             m_blockRange[i] = 0.0;
         }
@@ -1016,8 +1016,8 @@ double BC7BlockEncoder::CompressBlock(double in[MAX_SUBSET_SIZE][MAX_DIMENSION_B
         // Try all the legal block modes that we flagged
 
         CMP_BYTE    temporaryOutputBlock[COMPRESSED_BLOCK_SIZE];
-        double bestError = DBL_MAX;
-        double thisError;
+        float bestError = FLT_MAX;
+        float thisError;
         CMP_DWORD bestblockMode=99;
 
         // We change the order in which we visit the block modes to try to maximize the chance
@@ -49,7 +49,7 @@ BC_ERROR CMP_InitializeBC7Library() {
 }
 
 
-BC_ERROR CMP_CreateBC7Encoder(double quality, bool restrictColour, bool restrictAlpha, CMP_DWORD modeMask, double performance, BC7BlockEncoder **encoder) {
+BC_ERROR CMP_CreateBC7Encoder(float quality, bool restrictColour, bool restrictAlpha, CMP_DWORD modeMask, float performance, BC7BlockEncoder **encoder) {
     if (!g_LibraryInitialized) {
         return BC_ERROR_LIBRARY_NOT_INITIALIZED;
     }
@@ -88,7 +88,7 @@ BC_ERROR CMP_CreateBC7Decoder(BC7BlockDecoder **decoder) {
 //
 //
 //
-BC_ERROR CMP_EncodeBC7Block(BC7BlockEncoder *encoder, double in[BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG], CMP_BYTE *out) {
+BC_ERROR CMP_EncodeBC7Block(BC7BlockEncoder *encoder, float in[BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG], CMP_BYTE *out) {
     if (!g_LibraryInitialized) {
         return BC_ERROR_LIBRARY_NOT_INITIALIZED;
     }
@@ -107,7 +107,7 @@ BC_ERROR CMP_EncodeBC7Block(BC7BlockEncoder *encoder, double in[BC7_BLOCK_PIXELS
 //
 //
 //
-BC_ERROR CMP_DecodeBC7Block(BC7BlockDecoder *decoder, CMP_BYTE *in, double out[BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG]) {
+BC_ERROR CMP_DecodeBC7Block(BC7BlockDecoder *decoder, CMP_BYTE *in, float out[BC7_BLOCK_PIXELS][MAX_DIMENSION_BIG]) {
     if (!g_LibraryInitialized) {
         return BC_ERROR_LIBRARY_NOT_INITIALIZED;
     }
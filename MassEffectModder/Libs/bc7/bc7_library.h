@@ -119,7 +119,7 @@ BC_ERROR CMP_ShutdownBC7Library();
 //      encoder       - Address of a pointer to an encoder.
 //                      This function will allocate a BC7BlockEncoder object using new
 //
-BC_ERROR CMP_CreateBC7Encoder(double quality, bool restrictColour, bool restrictAlpha, CMP_DWORD modeMask, double performance,
+BC_ERROR CMP_CreateBC7Encoder(float quality, bool restrictColour, bool restrictAlpha, CMP_DWORD modeMask, float performance,
                               BC7BlockEncoder **encoder);
 //
 // CMP_CreateBC7Decoder()  - Creates an decoder object
@@ -135,7 +135,7 @@ BC_ERROR CMP_CreateBC7Decoder(BC7BlockDecoder **decoder);
 // For three-component input images the 4th component (BC7_COMP_ALPHA) should be set to 255 for
 // all pixels to ensure optimal encoding
 //
-BC_ERROR CMP_EncodeBC7Block(BC7BlockEncoder *encoder, double in[BC7_BLOCK_PIXELS][BC7_COMPONENT_COUNT], CMP_BYTE *out);
+BC_ERROR CMP_EncodeBC7Block(BC7BlockEncoder *encoder, float in[BC7_BLOCK_PIXELS][BC7_COMPONENT_COUNT], CMP_BYTE *out);
 
 //
 // CMP_DecodeBC7Block()  - Decode a BC7 block to an uncompressed output
@@ -143,7 +143,7 @@ BC_ERROR CMP_EncodeBC7Block(BC7BlockEncoder *encoder, double in[BC7_BLOCK_PIXELS
 // This function takes a pointer to an encoded BC block as input, decodes it and writes out the result
 //
 //
-BC_ERROR CMP_DecodeBC7Block(BC7BlockDecoder *decoder, CMP_BYTE *in, double out[BC7_BLOCK_PIXELS][BC7_COMPONENT_COUNT]);
+BC_ERROR CMP_DecodeBC7Block(BC7BlockDecoder *decoder, CMP_BYTE *in, float out[BC7_BLOCK_PIXELS][BC7_COMPONENT_COUNT]);
 
 //
 // CMP_DestroyBC7Encoder()  - Deletes a previously allocated encoder object
@@ -1067,8 +1067,8 @@ CMP_DWORD  BC7_FIXUPINDICES[MAX_SUBSETS][MAX_PARTITIONS][3] = {
 //
 
 void    Partition(CMP_DWORD partition,
-                  double in[][MAX_DIMENSION_BIG],
-                  double subsets[MAX_SUBSETS][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
+                  float in[][MAX_DIMENSION_BIG],
+                  float subsets[MAX_SUBSETS][MAX_SUBSET_SIZE][MAX_DIMENSION_BIG],
                   CMP_DWORD count[MAX_SUBSETS],
                   CMP_DWORD blockType,
                   int   dimension) {
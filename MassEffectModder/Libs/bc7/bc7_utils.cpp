@@ -57,7 +57,7 @@ void    WriteBit(CMP_BYTE   *base,
 
 
 // Used by BC7_Decode
-const double  rampLerpWeights[5][1<<MAX_INDEX_BITS] = {
+const float  rampLerpWeights[5][1<<MAX_INDEX_BITS] = {
 #if USE_FINAL_BC7_WEIGHTS
     {0.0},  // 0 bit index
     {0.0, 1.0}, // 1 bit index
@@ -133,10 +133,10 @@ void DecodeEndPoints(CMP_DWORD endpoint[][MAX_DIMENSION_BIG],
 }
 
 void GetRamp(CMP_DWORD endpoint[][MAX_DIMENSION_BIG],
-             double ramp[MAX_DIMENSION_BIG][(1<<MAX_INDEX_BITS)],
+             float ramp[MAX_DIMENSION_BIG][(1<<MAX_INDEX_BITS)],
              const CMP_DWORD clusters[2],
              const CMP_DWORD componentBits[MAX_DIMENSION_BIG]) {
-    double ep[2][MAX_DIMENSION_BIG];
+    float ep[2][MAX_DIMENSION_BIG];
     CMP_DWORD i;
 
     // Expand each endpoint component to 8 bits by shifting the MSB to bit 7
@@ -146,10 +146,10 @@ void GetRamp(CMP_DWORD endpoint[][MAX_DIMENSION_BIG],
         ep[0][i] = 0.;
         ep[1][i] = 0.;
         if(componentBits[i]) {
-            ep[0][i] = (double)(endpoint[0][i] << (8 - componentBits[i]));
-            ep[1][i] = (double)(endpoint[1][i] << (8 - componentBits[i]));
-            ep[0][i] += (double)((CMP_DWORD)ep[0][i] >> componentBits[i]);
-            ep[1][i] += (double)((CMP_DWORD)ep[1][i] >> componentBits[i]);
+            ep[0][i] = (float)(endpoint[0][i] << (8 - componentBits[i]));
+            ep[1][i] = (float)(endpoint[1][i] << (8 - componentBits[i]));
+            ep[0][i] += (float)((CMP_DWORD)ep[0][i] >> componentBits[i]);
+            ep[1][i] += (float)((CMP_DWORD)ep[1][i] >> componentBits[i]);
 
             ep[0][i] = MIN(255., MAX(0., ep[0][i]));
             ep[1][i] = MIN(255., MAX(0., ep[1][i]));
@@ -164,7 +164,7 @@ void GetRamp(CMP_DWORD endpoint[][MAX_DIMENSION_BIG],
 
     CMP_DWORD   rampIndex = clusters[0];
 
-    rampIndex = (CMP_DWORD)(log((double)rampIndex) / log(2.0));
+    rampIndex = (CMP_DWORD)(log((float)rampIndex) / log(2.0));
 
     // Generate colours for the RGB ramp
     for(i=0; i < clusters[0]; i++) {
@@ -187,7 +187,7 @@ void GetRamp(CMP_DWORD endpoint[][MAX_DIMENSION_BIG],
 
 
     rampIndex = clusters[1];
-    rampIndex = (CMP_DWORD)(log((double)rampIndex) / log(2.0));
+    rampIndex = (CMP_DWORD)(log((float)rampIndex) / log(2.0));
 
     if(!componentBits[COMP_ALPHA]) {
         for(i=0; i < clusters[1]; i++) {
@@ -31,7 +31,7 @@ extern void    WriteBit(CMP_BYTE   *base,
                         CMP_BYTE   bitVal);
 
 extern void GetRamp(CMP_DWORD endpoint[][MAX_DIMENSION_BIG],
-                    double ramp[MAX_DIMENSION_BIG][(1<<MAX_INDEX_BITS)],
+                    float ramp[MAX_DIMENSION_BIG][(1<<MAX_INDEX_BITS)],
                     const CMP_DWORD clusters[2],
                     const CMP_DWORD componentBits[MAX_DIMENSION_BIG]);
 
@@ -39,7 +39,7 @@ extern void DecodeEndPoints(CMP_DWORD endpoint[][MAX_DIMENSION_BIG],
                             const CMP_DWORD componentBits[MAX_DIMENSION_BIG],
                             float ep[][MAX_DIMENSION_BIG]);
 
-extern const double  rampLerpWeights[5][1<<MAX_INDEX_BITS];
+extern const float  rampLerpWeights[5][1<<MAX_INDEX_BITS];
 
 #endif
 
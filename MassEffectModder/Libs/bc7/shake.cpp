@@ -223,16 +223,16 @@ int par_vectors_nd[][2*MAX_DIMENSION_BIG][(1<<(2*MAX_DIMENSION_BIG-1))][2][MAX_D
 
 //#define GIG_TABLE
 #ifdef  GIG_TABLE
-static double ramp_err[LOG_CL_RANGE-LOG_CL_BASE][BIT_RANGE-BIT_BASE][256][256][256][16];
+static float ramp_err[LOG_CL_RANGE-LOG_CL_BASE][BIT_RANGE-BIT_BASE][256][256][256][16];
 #endif
 
-static double ramp[LOG_CL_RANGE-LOG_CL_BASE][BIT_RANGE-BIT_BASE][256][256][16];
-static double ep_d[BIT_RANGE-BIT_BASE][256];
+static float ramp[LOG_CL_RANGE-LOG_CL_BASE][BIT_RANGE-BIT_BASE][256][256][16];
+static float ep_d[BIT_RANGE-BIT_BASE][256];
 // inverted table
 // <log2 clusters >,  bits, value, par1, par2, <ep1>
 static int      sp_idx[LOG_CL_RANGE-LOG_CL_BASE][BIT_RANGE-BIT_BASE][256][2][2][MAX_CLUSTERS_BIG][2];
 // <log2 clusters >,  bits, value, par1, par2,
-static double   sp_err[LOG_CL_RANGE-LOG_CL_BASE][BIT_RANGE-BIT_BASE][256][2][2][MAX_CLUSTERS_BIG];
+static float   sp_err[LOG_CL_RANGE-LOG_CL_BASE][BIT_RANGE-BIT_BASE][256][2][2][MAX_CLUSTERS_BIG];
 //#endif
 
 //
@@ -253,7 +253,7 @@ void init_ramps () {
 
     for (bits=BIT_BASE; bits<BIT_RANGE; bits++)
         for (p1=0; p1<(1<<bits); p1++)
-            ep_d[BTT(bits)][p1]=(double) expand_(bits,p1);
+            ep_d[BTT(bits)][p1]=(float) expand_(bits,p1);
 
 
     for (clog1=LOG_CL_BASE; clog1<LOG_CL_RANGE; clog1++)
@@ -263,17 +263,17 @@ void init_ramps () {
                     for (i=0; i<(1<<clog1); i++)
                         ramp[CLT(clog1)][BTT(bits)][p1][p2][i] =
                             floor(
-                                (double) ep_d[BTT(bits)][p1] + rampLerpWeights[clog1][i] * (double)((ep_d[BTT(bits)][p2]- ep_d[BTT(bits)][p1]))
+                                (float) ep_d[BTT(bits)][p1] + rampLerpWeights[clog1][i] * (float)((ep_d[BTT(bits)][p2]- ep_d[BTT(bits)][p1]))
                                 +0.5);
 
 #ifdef GIG_TABLE
-                    double v;
+                    float v;
                     int vi;
                     for (vi=0; vi<256; vi++)
                         for (i=0; i<(1<<clog1); i++)
                             ramp_err[CLT(clog1)][BTT(bits)][p1][p2][vi][i] =
-                                (ramp[CLT(clog1)][BTT(bits)][p1][p2][i]-(double) vi) *
-                                (ramp[CLT(clog1)][BTT(bits)][p1][p2][i]-(double) vi);
+                                (ramp[CLT(clog1)][BTT(bits)][p1][p2][i]-(float) vi) *
+                                (ramp[CLT(clog1)][BTT(bits)][p1][p2][i]-(float) vi);
 #endif
                 }
 
@@ -287,7 +287,7 @@ void init_ramps () {
                     for (o2=0; o2<2; o2++)
                         for(i=0; i<16; i++) {
                             sp_idx[CLT(clog1)][BTT(bits)][j][o1][o2][i][0]=-1;
-                            sp_err[CLT(clog1)][BTT(bits)][j][o1][o2][i]=DBL_MAX;
+                            sp_err[CLT(clog1)][BTT(bits)][j][o1][o2][i]=FLT_MAX;
                         }
 
     for (clog1=LOG_CL_BASE; clog1<LOG_CL_RANGE; clog1++)
@@ -328,8 +328,8 @@ void init_ramps () {
 }
 
 // finds "floor in the set" if exists, otherwise returns min
-inline int ep_find_floor( double v, int bits, int use_par, int odd) {
-    double *p = ep_d[BTT(bits)];
+inline int ep_find_floor( float v, int bits, int use_par, int odd) {
+    float *p = ep_d[BTT(bits)];
     int i1=0;
     int i2=1<<(bits-use_par);
     odd = use_par ? odd : 0;
@@ -344,8 +344,8 @@ inline int ep_find_floor( double v, int bits, int use_par, int odd) {
 }
 
 // find closest one
-inline int ep_find_near( double v, int bits, int use_par, int odd) {
-    double *p = ep_d[BTT(bits)];
+inline int ep_find_near( float v, int bits, int use_par, int odd) {
+    float *p = ep_d[BTT(bits)];
     int p1 = ep_find_floor(v, bits, use_par,odd);
     int p2 = p1+(1<<use_par);
     p2 = p2 < (1<<bits) ? p2 : p1;
@@ -355,7 +355,7 @@ inline int ep_find_near( double v, int bits, int use_par, int odd) {
         return p1;
 }
 
-inline void mean_d (double d[][DIMENSION], double mean[DIMENSION], int n) {
+inline void mean_d (float d[][DIMENSION], float mean[DIMENSION], int n) {
     int i,j;
     for(j=0; j< DIMENSION; j++)
         mean[j] =0;
@@ -363,10 +363,10 @@ inline void mean_d (double d[][DIMENSION], double mean[DIMENSION], int n) {
         for(j=0; j< DIMENSION; j++)
             mean[j] +=d[i][j];
     for(j=0; j< DIMENSION; j++)
-        mean[j] /=(double) n;
+        mean[j] /=(float) n;
 }
 
-inline void mean_d_d (double d[][MAX_DIMENSION_BIG], double mean[MAX_DIMENSION_BIG], int n, int dimension) {
+inline void mean_d_d (float d[][MAX_DIMENSION_BIG], float mean[MAX_DIMENSION_BIG], int n, int dimension) {
     int i,j;
     for(j=0; j< dimension; j++)
         mean[j] =0;
@@ -374,10 +374,10 @@ inline void mean_d_d (double d[][MAX_DIMENSION_BIG], double mean[MAX_DIMENSION_B
         for(j=0; j< dimension; j++)
             mean[j] +=d[i][j];
     for(j=0; j< dimension; j++)
-        mean[j] /=(double) n;
+        mean[j] /=(float) n;
 }
 
-inline int cluster_mean_d (double d[][DIMENSION],  double mean[][DIMENSION], const int index[],int i_comp[],int i_cnt[], int n) {
+inline int cluster_mean_d (float d[][DIMENSION],  float mean[][DIMENSION], const int index[],int i_comp[],int i_cnt[], int n) {
     // unused index values are underfined
     int i,j,k;
 
@@ -397,11 +397,11 @@ inline int cluster_mean_d (double d[][DIMENSION],  double mean[][DIMENSION], con
 
     for(i=0; i< k; i++)
         for(j=0; j< DIMENSION; j++)
-            mean[i_comp[i]][j] /=(double) i_cnt[i_comp[i]];
+            mean[i_comp[i]][j] /=(float) i_cnt[i_comp[i]];
     return k;
 }
 
-inline int cluster_mean_d_d (double d[][MAX_DIMENSION_BIG],  double mean[][MAX_DIMENSION_BIG], const int index[],int i_comp[],int i_cnt[], int n, int dimension) {
+inline int cluster_mean_d_d (float d[][MAX_DIMENSION_BIG],  float mean[][MAX_DIMENSION_BIG], const int index[],int i_comp[],int i_cnt[], int n, int dimension) {
     // unused index values are underfined
     int i,j,k;
 
@@ -421,11 +421,11 @@ inline int cluster_mean_d_d (double d[][MAX_DIMENSION_BIG],  double mean[][MAX_D
 
     for(i=0; i< k; i++)
         for(j=0; j< dimension; j++)
-            mean[i_comp[i]][j] /=(double) i_cnt[i_comp[i]];
+            mean[i_comp[i]][j] /=(float) i_cnt[i_comp[i]];
     return k;
 }
 
-inline int all_same (double d[][DIMENSION],  int n) {
+inline int all_same (float d[][DIMENSION],  int n) {
     int i,j;
     int same = 1;
     for(i=1; i< n; i++)
@@ -435,7 +435,7 @@ inline int all_same (double d[][DIMENSION],  int n) {
     return(same);
 }
 
-inline int all_same_d (double d[][MAX_DIMENSION_BIG],  int n, int dimension) {
+inline int all_same_d (float d[][MAX_DIMENSION_BIG],  int n, int dimension) {
     int i,j;
     int same = 1;
     for(i=1; i< n; i++)
@@ -484,11 +484,11 @@ void index_collapse_ (int index[], int numEntries) {
 //
 //
 
-double BC7BlockEncoder::quant_single_point_d
+float BC7BlockEncoder::quant_single_point_d
 (
-    double data[MAX_ENTRIES][MAX_DIMENSION_BIG],
+    float data[MAX_ENTRIES][MAX_DIMENSION_BIG],
     int numEntries, int index[MAX_ENTRIES],
-    double out[MAX_ENTRIES][MAX_DIMENSION_BIG],
+    float out[MAX_ENTRIES][MAX_DIMENSION_BIG],
     int epo_1[2][MAX_DIMENSION_BIG],
     int Mi_,                // last cluster
     const int bits[3],            // including parity
@@ -497,9 +497,9 @@ double BC7BlockEncoder::quant_single_point_d
 ) {
     int i,j;
 
-    double err_0=DBL_MAX;
+    float err_0=FLT_MAX;
 
-    double err_1=DBL_MAX;
+    float err_1=FLT_MAX;
     int idx = 0;
     int idx_1 = 0;
 
@@ -541,14 +541,14 @@ double BC7BlockEncoder::quant_single_point_d
 
             int dr[MAX_DIMENSION_BIG];
             int dr_0[MAX_DIMENSION_BIG];
-            double tr;
+            float tr;
 
             for (i=0; i< (1<<clog2); i++) {
-                double t=0;
+                float t=0;
                 int t1o[MAX_DIMENSION_BIG],t2o[MAX_DIMENSION_BIG];
 
                 for (j=0; j<dimension; j++) {
-                    double t_=DBL_MAX;
+                    float t_=FLT_MAX;
 
                     for (t1=o1[0][j]; t1<o1[1][j]; t1++) {
                         for (t2=o2[0][j]; t2<o2[1][j]; t2++)
@@ -570,7 +570,7 @@ double BC7BlockEncoder::quant_single_point_d
                                 dr[j]=(int)floor(data[0][j]+0.5);
 
                             tr = sp_err[CLT(clog2)][BTT(bits[j])][dr[j]][t1][t2][i] +
-                                 2*sqrt(sp_err[CLT(clog2)][BTT(bits[j])][dr[j]][t1][t2][i]) * fabs((double)dr[j]-data[0][j])+
+                                 2*sqrt(sp_err[CLT(clog2)][BTT(bits[j])][dr[j]][t1][t2][i]) * fabs((float)dr[j]-data[0][j])+
                                  (dr[j]-data[0][j])* (dr[j]-data[0][j]);
 
                             if (tr < t_) {
@@ -620,18 +620,18 @@ double BC7BlockEncoder::quant_single_point_d
     return err_1 * numEntries;
 }
 
-double BC7BlockEncoder::ep_shaker_2_d(
-    double data[MAX_ENTRIES][MAX_DIMENSION_BIG],
+float BC7BlockEncoder::ep_shaker_2_d(
+    float data[MAX_ENTRIES][MAX_DIMENSION_BIG],
     int numEntries,
     int index_[MAX_ENTRIES],
-    double out[MAX_ENTRIES][MAX_DIMENSION_BIG],
+    float out[MAX_ENTRIES][MAX_DIMENSION_BIG],
     int epo_code[2][MAX_DIMENSION_BIG],
     int size,
     int Mi_,             // last cluster
     int bits,            // total for all channels
     // defined by total numbe of bits and dimensioin
     int dimension,
-    double epo[2][MAX_DIMENSION_BIG]
+    float epo[2][MAX_DIMENSION_BIG]
 
 ) {
     int i,j,k;
@@ -655,7 +655,7 @@ double BC7BlockEncoder::ep_shaker_2_d(
     while (i>>=1)
         clog3++;
 
-    double mean[MAX_DIMENSION_BIG];
+    float mean[MAX_DIMENSION_BIG];
     int index[MAX_ENTRIES];
     int Mi;
 
@@ -670,11 +670,11 @@ double BC7BlockEncoder::ep_shaker_2_d(
 
     int better;
 
-    double err_o = DBL_MAX;
+    float err_o = FLT_MAX;
 
     int epo_0[2][MAX_DIMENSION_BIG];
 
-    double outg[MAX_ENTRIES][MAX_DIMENSION_BIG];
+    float outg[MAX_ENTRIES][MAX_DIMENSION_BIG];
 
     // handled below automatically
     int alls= all_same_d(data, numEntries, dimension);
@@ -688,10 +688,10 @@ double BC7BlockEncoder::ep_shaker_2_d(
         int p, q;
         int p0=-1,q0=-1;
 
-        double err_0 = DBL_MAX;
+        float err_0 = FLT_MAX;
 
         if (Mi==0) {
-            double t;
+            float t;
             // either single point from the beginning or collapsed index
             if (alls) {
                 t =  quant_single_point_d( data,numEntries,index, outg, epo_0,  Mi_, max_bits,type, dimension);
@@ -732,18 +732,18 @@ double BC7BlockEncoder::ep_shaker_2_d(
                 for (k=0; k<numEntries; k++)
                     cidx[k]=index[k] * q + p;
 
-                double epa[2][MAX_DIMENSION_BIG];
+                float epa[2][MAX_DIMENSION_BIG];
 
                 {
                     //
                     // solve RMS problem for center
                     //
 
-                    double im [2][2] = {{0,0},{0,0}};   // matrix /inverse matrix
-                    double rp[2][MAX_DIMENSION_BIG];            // right part for RMS fit problem
+                    float im [2][2] = {{0,0},{0,0}};   // matrix /inverse matrix
+                    float rp[2][MAX_DIMENSION_BIG];            // right part for RMS fit problem
 
                     // get ideal clustr centers
-                    double cc[MAX_CLUSTERS_BIG][MAX_DIMENSION_BIG];
+                    float cc[MAX_CLUSTERS_BIG][MAX_DIMENSION_BIG];
                     int i_cnt[MAX_CLUSTERS_BIG]; // count of index entries
                     int i_comp[MAX_CLUSTERS_BIG];   // compacted index
                     int ncl;                        // number of unique indexes
@@ -771,7 +771,7 @@ double BC7BlockEncoder::ep_shaker_2_d(
                         }
                     }
 
-                    double dd = im[0][0]*im[1][1]-im[0][1]*im[0][1];
+                    float dd = im[0][0]*im[1][1]-im[0][1]*im[0][1];
 
                     // dd=0 means that cidx[k] and (Mi_-cidx[k]) collinear which implies only one active index;
                     // taken care of separately
@@ -790,14 +790,14 @@ double BC7BlockEncoder::ep_shaker_2_d(
                 // shake odd/odd and even/even or                    - same parity
                 // shake odd/odd odd/even , even/odd and even/even   - bcc
 
-                double err_1 = DBL_MAX;
+                float err_1 = FLT_MAX;
                 int epo_1[2][MAX_DIMENSION_BIG];
 
-                double ed[2][2][MAX_DIMENSION_BIG];
+                float ed[2][2][MAX_DIMENSION_BIG];
                 int epo_2_[2][2][2][MAX_DIMENSION_BIG];
 
                 for (j=0; j<dimension; j++) {
-                    double  (*rb) [256][16] =ramp[CLT(clog3)][BTT(max_bits[j])];
+                    float  (*rb) [256][16] =ramp[CLT(clog3)][BTT(max_bits[j])];
 
                     int pp[2]= {0,0};
                     int rr = (use_par ? 2:1);
@@ -818,12 +818,12 @@ double BC7BlockEncoder::ep_shaker_2_d(
                             }
                             int p1,p2, step=(1<<use_par);
 
-                            ed[pp[0]][pp[1]][j]=DBL_MAX;
+                            ed[pp[0]][pp[1]][j]=FLT_MAX;
 
                             for (p1=epi[0][0]; p1<=epi[0][1]; p1+=step)
                                 for (p2=epi[1][0]; p2<=epi[1][1]; p2+=step) {
-                                    double *rbp = rb[p1][p2];
-                                    double t=0;
+                                    float *rbp = rb[p1][p2];
+                                    float t=0;
                                     int    *ci=cidx;
                                     int    m =numEntries;
 
@@ -850,7 +850,7 @@ double BC7BlockEncoder::ep_shaker_2_d(
                 for (pn=0; pn<npv_nd[dimension][type]; pn++) {
                     pv = par_vectors_nd[dimension][type][pn];
                     int j1;
-                    double err_2=0;
+                    float err_2=0;
                     for (j1=0; j1<dimension; j1++)
                         err_2+=ed[pv[0][j1]][pv[1][j1]][j1];
                     if (err_2 < err_1) {
@@ -876,21 +876,21 @@ double BC7BlockEncoder::ep_shaker_2_d(
             }
 
         // requantize
-        double *r[MAX_DIMENSION_BIG];
+        float *r[MAX_DIMENSION_BIG];
         int idg[MAX_ENTRIES];
 
-        double err_r=0;
+        float err_r=0;
 
         for (j=0; j<dimension; j++)
             r[j]= ramp[CLT(clog3)][BTT(max_bits[j])][epo_0[0][j]][epo_0[1][j]];
 
         for (i=0; i<numEntries; i++) {
-            double  cmin = DBL_MAX;
+            float  cmin = FLT_MAX;
             int        ci = 0;
-            double    *d=data[i];
+            float    *d=data[i];
 
             for(j=0; j < (1<<clog3); j++) {
-                double t_=0.;
+                float t_=0.;
 
                 for(k=0; k<dimension; k++) {
                     t_+=(r[k][j]-d[k])*(r[k][j]-d[k]);
@@ -944,11 +944,11 @@ double BC7BlockEncoder::ep_shaker_2_d(
 
 
 
-double BC7BlockEncoder::ep_shaker_d(
-    double data[MAX_ENTRIES][MAX_DIMENSION_BIG],
+float BC7BlockEncoder::ep_shaker_d(
+    float data[MAX_ENTRIES][MAX_DIMENSION_BIG],
     int numEntries,
     int index_[MAX_ENTRIES],
-    double out[MAX_ENTRIES][MAX_DIMENSION_BIG],
+    float out[MAX_ENTRIES][MAX_DIMENSION_BIG],
     int epo_code[2][MAX_DIMENSION_BIG],
     int Mi_,                // last cluster
     int bits[3],            // including parity
@@ -967,7 +967,7 @@ double BC7BlockEncoder::ep_shaker_d(
 
     //###########################
 
-    double mean[MAX_DIMENSION_BIG];
+    float mean[MAX_DIMENSION_BIG];
     int index[MAX_ENTRIES];
     int Mi;
 
@@ -981,7 +981,7 @@ double BC7BlockEncoder::ep_shaker_d(
 
     int better;
 
-    double err_o = DBL_MAX;
+    float err_o = FLT_MAX;
 
     // handled below automatically
     int alls= all_same_d(data, numEntries, dimension);
@@ -996,13 +996,13 @@ double BC7BlockEncoder::ep_shaker_d(
         int p, q;
         int p0=-1,q0=-1;
 
-        double err_2 = DBL_MAX;
-        double out_2[MAX_ENTRIES][MAX_DIMENSION_BIG];
+        float err_2 = FLT_MAX;
+        float out_2[MAX_ENTRIES][MAX_DIMENSION_BIG];
         int idx_2[MAX_ENTRIES];
         int    epo_2[2][MAX_DIMENSION_BIG];
 
         if (Mi==0) {
-            double t;
+            float t;
             int    epo_0[2][MAX_DIMENSION_BIG];
             // either sinle point from the beginning or collapsed index
             if (alls) {
@@ -1040,18 +1040,18 @@ double BC7BlockEncoder::ep_shaker_d(
                     cidx[k]=index[k] * q + p;
                 }
 
-                double epa[2][MAX_DIMENSION_BIG];
+                float epa[2][MAX_DIMENSION_BIG];
 
                 {
                     //
                     // solve RMS problem for center
                     //
 
-                    double im [2][2] = {{0,0},{0,0}};   // matrix /inverse matrix
-                    double rp[2][MAX_DIMENSION_BIG];            // right part for RMS fit problem
+                    float im [2][2] = {{0,0},{0,0}};   // matrix /inverse matrix
+                    float rp[2][MAX_DIMENSION_BIG];            // right part for RMS fit problem
 
                     // get ideal clustr centers
-                    double cc[MAX_CLUSTERS_BIG][MAX_DIMENSION_BIG];
+                    float cc[MAX_CLUSTERS_BIG][MAX_DIMENSION_BIG];
                     int i_cnt[MAX_CLUSTERS_BIG]; // count of index entries
                     int i_comp[MAX_CLUSTERS_BIG];   // compacted index
                     int ncl;                        // number of unique indexes
@@ -1080,7 +1080,7 @@ double BC7BlockEncoder::ep_shaker_d(
                         }
                     }
 
-                    double dd = im[0][0]*im[1][1]-im[0][1]*im[0][1];
+                    float dd = im[0][0]*im[1][1]-im[0][1]*im[0][1];
 
                     // dd=0 means that cidx[k] and (Mi_-cidx[k]) collinear which implies only one active index;
                     // taken care of separately
@@ -1100,8 +1100,8 @@ double BC7BlockEncoder::ep_shaker_d(
                 // shake odd/odd odd/even , even/odd and even/even   - bcc
                 int odd,flip1;
 
-                double err_1 = DBL_MAX;
-                double out_1[MAX_ENTRIES][MAX_DIMENSION_BIG];
+                float err_1 = FLT_MAX;
+                float out_1[MAX_ENTRIES][MAX_DIMENSION_BIG];
                 int idx_1[MAX_ENTRIES];
                 int epo_1[2][MAX_DIMENSION_BIG];
                 int s1 = 0;
@@ -1121,20 +1121,20 @@ double BC7BlockEncoder::ep_shaker_d(
                             }
                         }
 
-                        double *r[MAX_DIMENSION_BIG];
+                        float *r[MAX_DIMENSION_BIG];
 
-                        double ce[MAX_ENTRIES][MAX_CLUSTERS_BIG][MAX_DIMENSION_BIG];
+                        float ce[MAX_ENTRIES][MAX_CLUSTERS_BIG][MAX_DIMENSION_BIG];
 
                         for (j=0; j<dimension; j++)
                             r[j]= ramp[CLT(clog4)][BTT(bits[j])][epi[0][j][0]][epi[1][j][0]];
 
-                        double err_0 = 0;
-                        double out_0[MAX_ENTRIES][MAX_DIMENSION_BIG];
+                        float err_0 = 0;
+                        float out_0[MAX_ENTRIES][MAX_DIMENSION_BIG];
                         int idx_0[MAX_ENTRIES];
 
 
                         for(i=0; i<numEntries; i++) {
-                            double *d=data[i];
+                            float *d=data[i];
                             for(j=0; j<(1<<clog4); j++)
                                 for(k=0; k<dimension; k++)
                                     ce[i][j][k] = (r[k][j]-d[k])*(r[k][j]-d[k]);
@@ -1165,12 +1165,12 @@ double BC7BlockEncoder::ep_shaker_d(
                             err_0 = 0;
 
                             for (i=0; i<numEntries; i++) {
-                                double *d=data[i];
+                                float *d=data[i];
                                 int    ci = 0;
-                                double cmin = DBL_MAX;
+                                float cmin = FLT_MAX;
 
                                 for(j=0; j<(1<<clog4); j++) {
-                                    double t_ = 0.;
+                                    float t_ = 0.;
                                     ce[i][j][j0] = (r[j0][j]-d[j0])*(r[j0][j]-d[j0]);
 
                                     for(k=0; k<dimension; k++) {
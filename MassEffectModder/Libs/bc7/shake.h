@@ -27,11 +27,11 @@
 void init_ramps ();
 
 
-double ep_shaker_2_(
-    double data[MAX_ENTRIES][DIMENSION],
+float ep_shaker_2_(
+    float data[MAX_ENTRIES][DIMENSION],
     int numEntries,
     int index_[MAX_ENTRIES],
-    double out[MAX_ENTRIES][DIMENSION],
+    float out[MAX_ENTRIES][DIMENSION],
     int epo_code[2][DIMENSION],
     int size,
     int Mi_,                // last cluster
@@ -40,11 +40,11 @@ double ep_shaker_2_(
 );
 
 
-double ep_shaker_(
-    double data[MAX_ENTRIES][DIMENSION],
+float ep_shaker_(
+    float data[MAX_ENTRIES][DIMENSION],
     int numEntries,
     int index_[MAX_ENTRIES],
-    double out[MAX_ENTRIES][DIMENSION],
+    float out[MAX_ENTRIES][DIMENSION],
     int epo_code[2][DIMENSION],
     int size,
     int Mi_,                // last cluster
@@ -53,11 +53,11 @@ double ep_shaker_(
 );
 
 
-double ep_shaker_d(
-    double data[MAX_ENTRIES][MAX_DIMENSION_BIG],
+float ep_shaker_d(
+    float data[MAX_ENTRIES][MAX_DIMENSION_BIG],
     int numEntries,
     int index_[MAX_ENTRIES],
-    double out[MAX_ENTRIES][MAX_DIMENSION_BIG],
+    float out[MAX_ENTRIES][MAX_DIMENSION_BIG],
     int epo_code[2][MAX_DIMENSION_BIG],
     int Mi_,                // last cluster
     int bits[3],            // including parity
@@ -41,6 +41,9 @@ void DisplayHelp()
         "  --update-toc --gameid <game id>\n" \
         "     Update TOC files.\n" \
         "\n" \
+        "  --verify-toc --gameid <game id> [--ipc]\n" \
+        "     Compare file sizes listed in TOC files against game data.\n" \
+        "\n" \
         "  --check-game-data-after --gameid <game id> [--ipc]\n" \
         "     Check game data for mods installed after textures installation.\n" \
         "\n" \
@@ -55,8 +58,16 @@ void DisplayHelp()
         "     Check game data for texture markers.\n" \
         "\n" \
         "  --install-mods --gameid <game id> --input <input dir/.mfl file> [--cache-amount <percent>]\n" \
-        "  [--repack] [--skip-markers] [--ipc] [--alot-mode] [--limit-2k] [--verify]\n" \
+        "  [--repack] [--skip-markers] [--ipc] [--alot-mode] [--limit-2k] [--verify] [--dry-run] [--resume]\n" \
+        "  [--dxt-quality <normal|fast>] [--mip-filter <box|kaiser|lanczos>] [--no-block-memo]\n" \
         "     Install MEM mods from input directory or MFL file list.\n" \
+        "     DXT quality: normal uses best fit, fast uses quicker and lower quality DXT1, DXT5 and ATI2 encoding.\n" \
+        "     mip filter: filter used to generate mipmaps: box, kaiser, lanczos. Default: box\n" \
+        "     --no-block-memo: encode every block, even repeated ones already encoded in the same mipmap\n" \
+        "     --dry-run: only print install plan with I/O, memory and time estimation,\n" \
+        "     game files are not modified.\n" \
+        "     --resume: continue interrupted installation of the same mods,\n" \
+        "     packages already installed are skipped.\n" \
         "\n" \
         "  --detect-mods --gameid <game id> [--ipc]\n" \
         "     Detect known compatible mods.\n" \
@@ -67,7 +78,8 @@ void DisplayHelp()
         "  --apply-lods-gfx --gameid <game id>\n" \
         "     Update GFX settings.\n" \
         "\n" \
-        "  --convert-to-mem --gameid <game id> --input <input dir> --output <output file> [--mark-to-convert] [--bc7-format] [--bc7-quality <num>] [--fast-mode] [--ipc]\n" \
+        "  --convert-to-mem --gameid <game id> --input <input dir> --output <output file> [--mark-to-convert] [--bc7-format] [--bc7-quality <num>] [--bc7-profile <name>] [--fast-mode] [--dxt-quality <normal|fast>] [--mip-filter <box|kaiser|lanczos>] [--no-block-memo] [--ipc]\n" \
+        "  [--convert-cache <cache dir>] [--convert-cache-size <MB>] [--convert-cache-max-age <days>]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     input dir: directory to be converted, containing following file extension(s):\n" \
         "        MEM, TPF\n" \
@@ -81,16 +93,24 @@ void DisplayHelp()
         "           Image filename must include texture CRC (0xhhhhhhhh)\n" \
         "        BIK\n" \
         "           Movie filename must include texture CRC (0xhhhhhhhh)\n" \
-        "     fast mode: turn on fast compresson of MEM files\n" \
+        "     fast mode: turn on fast compresson of MEM files and fast DXT quality\n" \
+        "     DXT quality: normal uses best fit, fast uses quicker and lower quality DXT1, DXT5 and ATI2 encoding.\n" \
+        "     mip filter: filter used to generate mipmaps: box, kaiser, lanczos. Default: box\n" \
+        "     --no-block-memo: encode every block, even repeated ones already encoded in the same mipmap\n" \
         "     ipc: turn on IPC traces\n" \
         "     BC7 quality: allow to change BC7 compression quality: 0.0 - 1.0. Default: 0.2\n" \
+        "     BC7 profile: limits BC7 modes search: veryfast, fast, normal, slow. Default: normal\n" \
+        "     cache dir: keeps converted textures keyed by image content and conversion options,\n" \
+        "        unchanged images are copied from it instead of being converted again\n" \
+        "     cache size: least recently used entries are removed above this size. Default: 4096\n" \
+        "     cache max age: entries not used for given days are removed, 0 keeps them. Default: 0\n" \
         "\n" \
         "  --extract-mem --gameid <game id> --input <input dir/file> [--output <output dir>] [--ipc]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     input dir: directory of MEM mod file(s)\n" \
         "     input file: MEM file to be extracted\n" \
         "\n" \
-        "  --convert-game-image --gameid <game id> --input <input image> --output <output image> [--mark-to-convert] [--bc7-quality <num>]\n" \
+        "  --convert-game-image --gameid <game id> --input <input image> --output <output image> [--mark-to-convert] [--bc7-quality <num>] [--bc7-profile <name>]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     Input file with following extension:\n" \
         "        DDS, BMP, TGA, PNG\n" \
@@ -103,8 +123,9 @@ void DisplayHelp()
         "           Image filename must include texture CRC (0xhhhhhhhh)\n" \
         "     Output file is DDS image\n" \
         "     BC7 quality: allow to change BC7 compression quality: 0.0 - 1.0. Default: 0.2\n" \
+        "     BC7 profile: limits BC7 modes search: veryfast, fast, normal, slow. Default: normal\n" \
         "\n" \
-        "  --convert-game-images --gameid <game id> --input <input dir> --output <output dir> [--mark-to-convert] [--bc7-quality <num>]\n" \
+        "  --convert-game-images --gameid <game id> --input <input dir> --output <output dir> [--mark-to-convert] [--bc7-quality <num>] [--bc7-profile <name>]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     input dir: directory to be converted, containing following file extension(s):\n" \
         "        Input files with following extension:\n" \
@@ -117,9 +138,12 @@ void DisplayHelp()
         "              uncompressed ARGB/RGB/RGBX\n" \
         "           Image filename must include texture CRC (0xhhhhhhhh)\n" \
         "     output dir: directory where textures converted to DDS are placed\n" \
+        "        Existing DDS newer than its input image and matching the game texture is kept as is\n" \
         "     BC7 quality: allow to change BC7 compression quality: 0.0 - 1.0. Default: 0.2\n" \
+        "     BC7 profile: limits BC7 modes search: veryfast, fast, normal, slow. Default: normal\n" \
         "\n" \
-        "  --convert-image --format <output pixel format> [--threshold <dxt1 alpha threshold>] --input <input image> --output <output image> [--bc7-quality <num>]\n" \
+        "  --convert-image --format <output pixel format> [--threshold <dxt1 alpha threshold>] --input <input image> --output <output image> [--bc7-quality <num>] [--bc7-profile <name>]\n" \
+        "  [--dxt-quality <normal|fast>] [--mip-filter <box|kaiser|lanczos>] [--no-block-memo]\n" \
         "     input image file types: DDS, BMP, TGA, PNG\n" \
         "           input format supported for DDS images:\n" \
         "              DXT1, DXT3, DTX5, ATI2, V8U8, G8, ARGB, RGB, RGBA, BC5, BC7, RGBE, RGBA10, RGBA16\n" \
@@ -131,8 +155,12 @@ void DisplayHelp()
         "     output pixel format: DXT1 (no alpha), DXT1a (alpha), DXT3, DXT5, ATI2, V8U8, G8, ARGB, RGB, RGBA, BC5, BC7, RGBE, RGBA10, RGBA16\n" \
         "     For DXT1a you have to set the alpha threshold (0-255). 128 is suggested as a default value.\n" \
         "     BC7 quality: allow to change BC7 compression quality: 0.0 - 1.0. Default: 0.2\n" \
+        "     BC7 profile: limits BC7 modes search: veryfast, fast, normal, slow. Default: normal\n" \
+        "     DXT quality: normal uses best fit, fast uses quicker and lower quality DXT1, DXT5 and ATI2 encoding.\n" \
+        "     mip filter: filter used to generate mipmaps: box, kaiser, lanczos. Default: box\n" \
+        "     --no-block-memo: encode every block, even repeated ones already encoded in the same mipmap\n" \
         "\n" \
-        "  --extract-all-dds --gameid <game id> --output <output dir> [--tfc-name <filter name>|--pcc-only|--tfc-only] [--package-path <path>] [--map-crc]\n" \
+        "  --extract-all-dds --gameid <game id> --output <output dir> [--tfc-name <filter name>|--pcc-only|--tfc-only] [--package-path <path>] [--map-crc] [--top-mips <count>]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     output dir: directory where textures converted to DDS are placed\n" \
         "     TFC filter name: it will filter only textures stored in specific TFC file.\n" \
@@ -140,9 +168,11 @@ void DisplayHelp()
         "     Or option: --tfc-only to extract only textures stored in TFC files.\n" \
         "     Package path: single package mode.\n" \
         "     Map Crc: it will try to find vanilla texture crc from texture map.\n" \
+        "     Top mips: store only given number of the largest mipmaps.\n" \
         "     Textures are extracted as they are in game data, only DDS header is added.\n" \
         "\n" \
         "  --extract-all-png --gameid <game id> --output <output dir> [--tfc-name <filter name>|--pcc-only|--tfc-only] [--package-path <path>] [--map-crc] [--clear-alpha]\n" \
+        "  [--png-level <0-9>] [--png-filter <none|sub|up|average|paeth|adaptive>]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
         "     output dir: directory where textures converted to PNG are placed\n" \
         "     TFC filter name: it will filter only textures stored in specific TFC file.\n" \
@@ -152,6 +182,8 @@ void DisplayHelp()
         "     Map Crc: it will try to find vanilla texture crc from texture map.\n" \
         "     Alpha channel can be cleared in PNG output by \"--clear-alpha\".n" \
         "     Textures are extracted with only top mipmap.\n" \
+        "     PNG level: deflate compression level, 0 stores data uncompressed. Default: 6\n" \
+        "     PNG filter: rows filter used before compression. Default: adaptive\n" \
         "\n" \
         "  --extract-all-bik --gameid <game id> --output <output dir> [--tfc-name <filter name>|--pcc-only|--tfc-only] [--package-path <path>] [--map-crc]\n" \
         "     game id: 1 for ME1, 2 for ME2, 3 for ME3\n" \
@@ -175,6 +207,13 @@ void DisplayHelp()
         "\n" \
         "  --list-archive --input <zip/7z/rar file> [--ipc]\n" \
         "     List content of ZIP/7ZIP/RAR archive file.\n" \
+        "\n" \
+        "  --server\n" \
+        "     Keep running and read commands from standard input, one per line,\n" \
+        "     with the same parameters as above. Game files lists, texture maps and\n" \
+        "     MD5 tables stay loaded between commands. Output uses IPC protocol and\n" \
+        "     each command ends with [IPC]COMMAND_DONE <exit code>.\n" \
+        "     'reset' drops loaded game state, 'quit' ends the server.\n" \
         "\n";
 #if !defined(_WIN32)
     help +=
@@ -187,6 +226,8 @@ void DisplayHelp()
         "\n" \
         "\n" \
         "  Additional option to enable debug logs level to all commands: --debug-logs\n" \
+        "  Additional option to set number of packages read ahead while processing: --prefetch-depth <count>\n" \
+        "     Default is 2, 0 disables read ahead.\n" \
         "\n";
     PINFO(help);
 }
@@ -20,14 +20,19 @@
  */
 
 #include <CmdLine/CmdLineParams.h>
+#include <CmdLine/CmdLineServer.h>
 #include <CmdLine/CmdLineTools.h>
 #include <Helpers/MiscHelpers.h>
+#include <Helpers/PackagePrefetcher.h>
 #include <Helpers/Logs.h>
 #include <GameData/GameData.h>
 #include <GameData/TOCFile.h>
+#include <Image/Image.h>
 #include <Misc/Misc.h>
+#include <Misc/ModConvertCache.h>
 #include <Program/ConfigIni.h>
 #include <Types/MemTypes.h>
+#include <Wrappers.h>
 
 static bool hasValue(const QStringList &args, int curPos)
 {
@@ -35,6 +40,18 @@ static bool hasValue(const QStringList &args, int curPos)
 }
 
 int ProcessArguments()
+{
+    QStringList args = QCoreApplication::arguments();
+    if (args.count() != 0)
+        args.removeFirst();
+
+    if (args.contains("--server", Qt::CaseInsensitive))
+        return RunServer();
+
+    return ProcessArguments(args);
+}
+
+int ProcessArguments(QStringList args)
 {
     int errorCode = 0;
     int cmd = CmdType::UNKNOWN;
@@ -45,22 +62,31 @@ int ProcessArguments()
     bool pccOnly = false;
     bool tfcOnly = false;
     bool verify = false;
+    bool dryRun = false;
+    bool resume = false;
     bool mapCRC = false;
     bool flattenPath = false;
     bool clearAlpha = false;
     bool bc7format = false;
     float bc7qualityValue = 0.2f;
     bool fastMode = false;
+    bool blockMemo = true;
+    QString dxtQuality;
+    Image::Bc7Profile bc7Profile = Image::Bc7Profile::Normal;
+    Image::MipFilter mipFilter = Image::MipFilter::Box;
+    QString convertCachePath;
+    int convertCacheSize = 4096;
+    int convertCacheMaxAge = 0;
+    int pngLevel = -1;
+    int pngFilter = PngFilterAdaptive;
     int thresholdValue = 128;
     int cacheAmountValue = -1;
+    int topMipsValue = 0;
+    int prefetchDepth = 2;
     QString input, output, threshold, format, tfcName;
     QString dlcName, path, cacheAmount, filter, bc7quality;
     CmdLineTools tools;
 
-    QStringList args = QCoreApplication::arguments();
-    if (args.count() != 0)
-        args.removeFirst();
-
     for (int l = 0; l < args.count(); l++)
     {
         const QString arg = args[l].toLower();
@@ -74,6 +100,8 @@ int ProcessArguments()
             cmd = CmdType::SCAN_TEXTURES;
         else if (arg == "--update-toc")
             cmd = CmdType::UPDATE_TOC;
+        else if (arg == "--verify-toc")
+            cmd = CmdType::VERIFY_TOC;
         else if (arg == "--convert-to-mem")
             cmd = CmdType::CONVERT_TO_MEM;
         else if (arg == "--convert-game-image")
@@ -187,6 +215,11 @@ int ProcessArguments()
             fastMode = true;
             args.removeAt(l--);
         }
+        else if (arg == "--no-block-memo")
+        {
+            blockMemo = false;
+            args.removeAt(l--);
+        }
         else if (arg == "--mark-to-convert")
         {
             markToConvert = true;
@@ -216,6 +249,16 @@ int ProcessArguments()
             verify = true;
             args.removeAt(l--);
         }
+        else if (arg == "--dry-run")
+        {
+            dryRun = true;
+            args.removeAt(l--);
+        }
+        else if (arg == "--resume")
+        {
+            resume = true;
+            args.removeAt(l--);
+        }
         else if (arg == "--pcc-only")
         {
             if (tfcName != "" || tfcOnly)
@@ -280,6 +323,88 @@ int ProcessArguments()
             args.removeAt(l);
             args.removeAt(l--);
         }
+        else if (arg == "--bc7-profile" && hasValue(args, l))
+        {
+            QString profile = args[l + 1].toLower();
+            if (profile == "veryfast")
+                bc7Profile = Image::Bc7Profile::VeryFast;
+            else if (profile == "fast")
+                bc7Profile = Image::Bc7Profile::Fast;
+            else if (profile == "normal")
+                bc7Profile = Image::Bc7Profile::Normal;
+            else if (profile == "slow")
+                bc7Profile = Image::Bc7Profile::Slow;
+            else
+            {
+                PERROR("BC7 profile param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--mip-filter" && hasValue(args, l))
+        {
+            QString filterName = args[l + 1].toLower();
+            if (filterName == "box")
+                mipFilter = Image::MipFilter::Box;
+            else if (filterName == "kaiser")
+                mipFilter = Image::MipFilter::Kaiser;
+            else if (filterName == "lanczos")
+                mipFilter = Image::MipFilter::Lanczos;
+            else
+            {
+                PERROR("Mip filter param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--dxt-quality" && hasValue(args, l))
+        {
+            dxtQuality = args[l + 1].toLower();
+            if (dxtQuality != "normal" && dxtQuality != "fast")
+            {
+                PERROR("DXT quality param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--png-level" && hasValue(args, l))
+        {
+            bool ok;
+            pngLevel = args[l + 1].toInt(&ok);
+            if (!ok || pngLevel < 0 || pngLevel > 9)
+            {
+                PERROR("PNG level param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--png-filter" && hasValue(args, l))
+        {
+            QString filterName = args[l + 1].toLower();
+            if (filterName == "none")
+                pngFilter = PngFilterNone;
+            else if (filterName == "sub")
+                pngFilter = PngFilterSub;
+            else if (filterName == "up")
+                pngFilter = PngFilterUp;
+            else if (filterName == "average")
+                pngFilter = PngFilterAverage;
+            else if (filterName == "paeth")
+                pngFilter = PngFilterPaeth;
+            else if (filterName == "adaptive")
+                pngFilter = PngFilterAdaptive;
+            else
+            {
+                PERROR("PNG filter param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
         else if (arg == "--format" && hasValue(args, l))
         {
             format = args[l + 1];
@@ -324,6 +449,65 @@ int ProcessArguments()
             args.removeAt(l);
             args.removeAt(l--);
         }
+        else if (arg == "--top-mips" && hasValue(args, l))
+        {
+            bool ok;
+            topMipsValue = args[l + 1].toInt(&ok);
+            if (!ok || topMipsValue < 1)
+            {
+                PERROR("Top mips param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--prefetch-depth" && hasValue(args, l))
+        {
+            bool ok;
+            prefetchDepth = args[l + 1].toInt(&ok);
+            if (!ok || prefetchDepth < 0)
+            {
+                PERROR("Prefetch depth param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--convert-cache" && hasValue(args, l))
+        {
+            convertCachePath = args[l + 1].replace('\\', '/');
+            if (convertCachePath.length() == 0)
+            {
+                PERROR("Conversion cache path param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--convert-cache-size" && hasValue(args, l))
+        {
+            bool ok;
+            convertCacheSize = args[l + 1].toInt(&ok);
+            if (!ok || convertCacheSize < 1)
+            {
+                PERROR("Conversion cache size param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
+        else if (arg == "--convert-cache-max-age" && hasValue(args, l))
+        {
+            bool ok;
+            convertCacheMaxAge = args[l + 1].toInt(&ok);
+            if (!ok || convertCacheMaxAge < 0)
+            {
+                PERROR("Conversion cache max age param wrong!\n");
+                return -1;
+            }
+            args.removeAt(l);
+            args.removeAt(l--);
+        }
         else if ((arg == "--filter-with-ext" || arg == "--filter") && hasValue(args, l))
         {
             filter = args[l + 1];
@@ -347,6 +531,17 @@ int ProcessArguments()
         return 1;
     }
 
+    if (dxtQuality == "fast" || (dxtQuality.isEmpty() && fastMode))
+        Image::SetDxtQuality(Image::DxtQuality::Fast);
+    else
+        Image::SetDxtQuality(Image::DxtQuality::Normal);
+    Image::SetBc7Profile(bc7Profile);
+    Image::SetMipFilter(mipFilter);
+    Image::SetBlockMemo(blockMemo);
+    Image::SetPngOptions(pngLevel, pngFilter);
+    PackagePrefetcher::SetDefaultDepth(prefetchDepth);
+    ModConvertCache::SetDefaults(convertCachePath, (quint64)convertCacheSize * 1024 * 1024, convertCacheMaxAge);
+
     switch (cmd)
     {
     case CmdType::VERSION:
@@ -390,6 +585,18 @@ int ProcessArguments()
             errorCode = 1;
         break;
     }
+    case CmdType::VERIFY_TOC:
+    {
+        if (gameId == MeType::UNKNOWN_TYPE)
+        {
+            PERROR("Invalid game id!\n");
+            errorCode = 1;
+            break;
+        }
+        if (!tools.verifyTOCs(gameId))
+            errorCode = 1;
+        break;
+    }
     case CmdType::CONVERT_TO_MEM:
         if (gameId == MeType::UNKNOWN_TYPE)
         {
@@ -497,7 +704,13 @@ int ProcessArguments()
             errorCode = 1;
             break;
         }
-        if (!tools.InstallMods(gameId, input, alotMode, skipMarkers, verify, cacheAmountValue))
+        if (dryRun && resume)
+        {
+            PERROR("--dry-run and --resume can't be used together\n");
+            errorCode = 1;
+            break;
+        }
+        if (!tools.InstallMods(gameId, input, alotMode, skipMarkers, verify, cacheAmountValue, dryRun, resume))
         {
             errorCode = 1;
         }
@@ -638,7 +851,7 @@ int ProcessArguments()
             errorCode = 1;
             break;
         }
-        if (!tools.extractAllTextures(gameId, output, input, false, pccOnly, tfcOnly, mapCRC, tfcName))
+        if (!tools.extractAllTextures(gameId, output, input, false, pccOnly, tfcOnly, mapCRC, tfcName, false, topMipsValue))
             errorCode = 1;
         break;
     case CmdType::EXTRACT_ALL_PNG:
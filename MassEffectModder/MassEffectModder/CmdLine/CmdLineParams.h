@@ -30,6 +30,7 @@ typedef enum : int
     SCAN,
     SCAN_TEXTURES,
     UPDATE_TOC,
+    VERIFY_TOC,
     CONVERT_TO_MEM,
     CONVERT_GAME_IMAGE,
     CONVERT_GAME_IMAGES,
@@ -59,6 +60,7 @@ typedef enum : int
 } CmdType;
 
 int ProcessArguments();
+int ProcessArguments(QStringList args);
 void DisplayHelp();
 
 #endif
@@ -0,0 +1,112 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <CmdLine/CmdLineParams.h>
+#include <CmdLine/CmdLineServer.h>
+#include <GameData/GameData.h>
+#include <Helpers/MiscHelpers.h>
+#include <Helpers/Logs.h>
+#include <Resources/Resources.h>
+#include <Texture/TextureScan.h>
+
+#include <QProcess>
+
+namespace {
+
+// Game files lists are classified again after commands which change them,
+// changes made outside of server are caught by revalidation before each command
+const char *gameDataCommands[] = {
+    "--install-mods",
+    "--update-toc",
+    "--set-game-data-path",
+#if !defined(_WIN32)
+    "--set-game-user-path",
+#endif
+};
+
+bool ChangesGameData(const QStringList &args)
+{
+    for (const auto &command : gameDataCommands)
+    {
+        if (args.contains(command, Qt::CaseInsensitive))
+            return true;
+    }
+    return false;
+}
+
+void KeepStateLoaded(bool enable)
+{
+    Resources::KeepTablesLoaded(enable);
+    TreeScan::KeepMapsLoaded(enable);
+}
+
+} // namespace
+
+int RunServer()
+{
+    g_ipc = true;
+    KeepStateLoaded(true);
+
+    ConsoleWrite("[IPC]SERVER_READY");
+    ConsoleSync();
+
+    // One command per line, same parameters as command line, results are
+    // reported with IPC output and terminated by COMMAND_DONE
+    QTextStream input(stdin);
+    while (true)
+    {
+        QString line = input.readLine();
+        if (line.isNull())
+            break;
+
+        QStringList args = QProcess::splitCommand(line.trimmed());
+        if (args.count() == 0)
+            continue;
+
+        const QString command = args.first().toLower();
+        if (command == "quit" || command == "exit")
+            break;
+
+        int status = 0;
+        if (command == "reset")
+        {
+            g_GameData->ClosePackagesList();
+            g_GameData->ResetInventory();
+            KeepStateLoaded(false);
+            KeepStateLoaded(true);
+        }
+        else
+        {
+            g_ipc = true;
+            g_GameData->RevalidateInventory();
+            status = ProcessArguments(args);
+            if (ChangesGameData(args))
+                g_GameData->ClosePackagesList();
+        }
+
+        ConsoleWrite(QString("[IPC]COMMAND_DONE %1").arg(status));
+        ConsoleSync();
+    }
+
+    KeepStateLoaded(false);
+
+    return 0;
+}
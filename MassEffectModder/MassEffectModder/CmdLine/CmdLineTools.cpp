@@ -19,11 +19,14 @@
  *
  */
 
+#include <condition_variable>
+
 #include <CmdLine/CmdLineTools.h>
 #include <GameData/GameData.h>
 #include <GameData/UserSettings.h>
 #include <GameData/TOCFile.h>
 #include <Helpers/MiscHelpers.h>
+#include <Helpers/PackagePrefetcher.h>
 #include <Helpers/Logs.h>
 #include <Misc/Misc.h>
 #include <MipMaps/MipMaps.h>
@@ -123,6 +126,20 @@ bool CmdLineTools::updateTOCs(MeType gameId)
     return true;
 }
 
+bool CmdLineTools::verifyTOCs(MeType gameId)
+{
+    ConfigIni configIni = ConfigIni();
+    g_GameData->Init(gameId, configIni);
+    if (!Misc::CheckGamePath())
+        return false;
+
+    PINFO("Verifying TOC files...\n");
+    bool status = TOCBinFile::VerifyAllTOCBinFiles(gameId);
+    PINFO("Finished verifying TOC files.\n\n");
+
+    return status;
+}
+
 bool CmdLineTools::GetGamePaths()
 {
     ConfigIni configIni = ConfigIni();
@@ -246,6 +263,91 @@ bool CmdLineTools::ConvertToMEM(MeType gameId, QString &inputDir, QString &memFi
     return Misc::convertDataModtoMem(list, memFile, gameId, textures, fastMode, markToConvert, bc7format, bc7quality, nullptr, nullptr);
 }
 
+namespace {
+
+// Limits amount of memory held by textures converted at the same time
+class ConvertMemoryBudget
+{
+    std::mutex lock;
+    std::condition_variable released;
+    qint64 limit;
+    qint64 inFlight = 0;
+
+public:
+    explicit ConvertMemoryBudget(qint64 limitBytes) : limit(limitBytes) {}
+
+    void Acquire(qint64 amount)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        released.wait(guard, [&] { return inFlight == 0 || inFlight + amount <= limit; });
+        inFlight += amount;
+    }
+
+    void Release(qint64 amount)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            inFlight -= amount;
+        }
+        released.notify_all();
+    }
+};
+
+struct ConvertImageTask
+{
+    QString inputFile;
+    QString outputFile;
+    TextureMapEntry texture;
+    qint64 memoryUsage;
+};
+
+// Outputs differing only by case are the same file only on case insensitive file system
+QString OutputFileKey(const QString &outputFile)
+{
+#if defined(_WIN32)
+    return outputFile.toLower();
+#else
+    return outputFile;
+#endif
+}
+
+// Decoded float image with mips and the encoded copy, input can be larger than game texture
+qint64 EstimateConvertMemory(const TextureMapEntry &texture, qint64 inputFileSize)
+{
+    qint64 gamePixels = static_cast<qint64>(texture.width) * texture.height;
+    return qMax(gamePixels * 4 * static_cast<qint64>(sizeof(float)), inputFileSize * 32) * 2;
+}
+
+// Output of an earlier run is kept only when its DDS header matches the game texture and
+// the file holds the full mips chain, data is not read so the check stays cheap
+bool IsConvertedOutputValid(const QString &outputFile, const TextureMapEntry &texture, bool markToConvert)
+{
+    QFile file(outputFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    file.close();
+
+    FileStream fs = FileStream(outputFile, FileMode::Open, FileAccess::ReadOnly);
+    if (fs.Length() < 4 + DDS_HEADER_dwSize)
+        return false;
+    Image::DDSHeader header{};
+    if (!Image::ReadDDSHeader(fs, header))
+        return false;
+    if (fs.Length() != header.dataOffset + header.dataSize)
+        return false;
+    if (!markToConvert && header.pixelFormat != texture.pixfmt)
+        return false;
+    int fullMipsCount = 1;
+    while ((qMax(header.width, header.height) >> fullMipsCount) != 0)
+        fullMipsCount++;
+    if (header.mipsCount != (header.pixelFormat == PixelFormat::RGBE ? 1 : fullMipsCount))
+        return false;
+    return header.height != 0 && texture.height != 0 &&
+           header.width / header.height == texture.width / texture.height;
+}
+
+} // namespace
+
 bool CmdLineTools::convertGameTexture(const QString &inputFile,
                                       QString &outputFile, QList<TextureMapEntry> &textures,
                                       bool markToConvert, float bc7quality)
@@ -262,6 +364,12 @@ bool CmdLineTools::convertGameTexture(const QString &inputFile,
         return false;
     }
 
+    return convertGameTexture(inputFile, outputFile, foundTex, markToConvert, bc7quality);
+}
+
+bool CmdLineTools::convertGameTexture(const QString &inputFile, const QString &outputFile,
+                                      TextureMapEntry foundTex, bool markToConvert, float bc7quality)
+{
     Image image = Image(inputFile);
     if (!Misc::CheckImage(image, foundTex, inputFile, -1))
         return false;
@@ -290,12 +398,21 @@ bool CmdLineTools::convertGameTexture(const QString &inputFile,
         }
     }
     image.correctMips(newPixelFormat, dxt1HasAlpha, dxt1Threshold, bc7quality);
-    if (QFile(outputFile).exists())
-        QFile(outputFile).remove();
-    FileStream fs = FileStream(outputFile, FileMode::Create, FileAccess::WriteOnly);
-    ByteBuffer buffer = image.StoreImageToDDS();
-    fs.WriteFromBuffer(buffer);
-    buffer.Free();
+
+    // Written aside and moved in place, so an interrupted run leaves no partial output
+    QString tempFile = outputFile + ".tmp";
+    {
+        FileStream fs = FileStream(tempFile, FileMode::Create, FileAccess::WriteOnly);
+        ByteBuffer buffer = image.StoreImageToDDS();
+        fs.WriteFromBuffer(buffer);
+        buffer.Free();
+    }
+    if (!ReplaceFile(tempFile, outputFile))
+    {
+        PERROR(QString("Failed to write output file: ") + outputFile + "\n");
+        QFile(tempFile).remove();
+        return false;
+    }
 
     return true;
 }
@@ -328,15 +445,98 @@ bool CmdLineTools::convertGameImages(MeType gameId, QString &inputDir, QString &
     outputDir = QDir::cleanPath(outputDir);
     QDir().mkpath(outputDir);
 
-    bool status = true;
+    // Inputs differing only by extension share the output file, the last one is used
+    QStringList outputFiles;
+    QHash<QString, QFileInfo> inputForOutput;
     foreach (QFileInfo file, list)
     {
         QString outputFile = outputDir + "/" + BaseNameWithoutExt(file.fileName()) + ".dds";
-        if (!convertGameTexture(file.absoluteFilePath(), outputFile, textures, markToConvert, bc7quality))
+        QString key = OutputFileKey(outputFile);
+        if (inputForOutput.contains(key))
+        {
+            PINFO(QString("Texture ") + inputForOutput[key].fileName() + " skipped, " +
+                  file.fileName() + " is converted to the same output file.\n");
+        }
+        else
+            outputFiles.push_back(outputFile);
+        inputForOutput[key] = file;
+    }
+
+    bool status = true;
+    int upToDate = 0;
+    QVector<ConvertImageTask> tasks;
+    foreach (const QString &outputFile, outputFiles)
+    {
+        const QFileInfo &file = inputForOutput[OutputFileKey(outputFile)];
+        uint crc = Misc::scanFilenameForCRC(file.absoluteFilePath());
+        if (crc == 0)
+        {
             status = false;
+            continue;
+        }
+        TextureMapEntry foundTex = Misc::FoundTextureInTheMap(textures, crc);
+        if (foundTex.crc == 0)
+        {
+            PINFO(QString("Texture skipped. Texture ") + file.fileName() +
+                         " is not present in your game setup.\n");
+            status = false;
+            continue;
+        }
+
+        QFileInfo outputInfo(outputFile);
+        if (outputInfo.exists() && outputInfo.lastModified() > file.lastModified() &&
+            IsConvertedOutputValid(outputFile, foundTex, markToConvert))
+        {
+            upToDate++;
+            continue;
+        }
+        tasks.push_back({ file.absoluteFilePath(), outputFile, foundTex,
+                          EstimateConvertMemory(foundTex, file.size()) });
+    }
+    if (upToDate != 0)
+        PINFO(QString("Skipped ") + QString::number(upToDate) + " texture(s) with up to date output.\n");
+
+    // Files are converted concurrently, bounded by memory they need in flight.
+    // Parallel loops of encoder are single threaded inside the outer team, so large
+    // files, or all of them when there are fewer than threads, go one by one first.
+    int memoryAmount = DetectAmountMemoryGB();
+    if (memoryAmount == 0)
+        memoryAmount = 16;
+    qint64 budgetLimit = static_cast<qint64>(memoryAmount) * 1024 * 1024 * 1024 / 2;
+    int numThreads = omp_get_max_threads();
+    QVector<ConvertImageTask> serialTasks, parallelTasks;
+    foreach (const ConvertImageTask &task, tasks)
+    {
+        if (task.memoryUsage > budgetLimit / numThreads)
+            serialTasks.push_back(task);
+        else
+            parallelTasks.push_back(task);
+    }
+    if (parallelTasks.count() < numThreads)
+    {
+        serialTasks += parallelTasks;
+        parallelTasks.clear();
     }
 
-    return status;
+    bool failed = false;
+    foreach (const ConvertImageTask &task, serialTasks)
+    {
+        if (!convertGameTexture(task.inputFile, task.outputFile, task.texture, markToConvert, bc7quality))
+            failed = true;
+    }
+
+    ConvertMemoryBudget budget(budgetLimit);
+    #pragma omp parallel for schedule(dynamic, 1) reduction(||:failed)
+    for (int t = 0; t < parallelTasks.count(); t++)
+    {
+        const ConvertImageTask &task = parallelTasks.at(t);
+        budget.Acquire(task.memoryUsage);
+        if (!convertGameTexture(task.inputFile, task.outputFile, task.texture, markToConvert, bc7quality))
+            failed = true;
+        budget.Release(task.memoryUsage);
+    }
+
+    return status && !failed;
 }
 
 bool CmdLineTools::convertImage(QString &inputFile, QString &outputFile, QString &format, int dxt1Threshold, float bc7qualityValue)
@@ -502,7 +702,7 @@ bool CmdLineTools::DetectMods(MeType gameId)
 
 bool CmdLineTools::InstallMods(MeType gameId, QString &inputDir,
                                bool alotMode, bool skipMarkers,
-                               bool verify, int cacheAmount)
+                               bool verify, int cacheAmount, bool dryRun, bool resume)
 {
     Resources resources;
     resources.loadMD5Tables();
@@ -545,14 +745,185 @@ bool CmdLineTools::InstallMods(MeType gameId, QString &inputDir,
             }
         }
     }
+    if (dryRun)
+        return Misc::PlanInstallMods(gameId, resources, modFiles, cacheAmount, nullptr, nullptr);
+
     return Misc::InstallMods(gameId, resources, modFiles,
                              false, alotMode, skipMarkers, verify, cacheAmount,
-                             nullptr, nullptr);
+                             nullptr, nullptr, resume);
+}
+
+namespace {
+
+// Each worker holds a whole package or a fully decoded texture, keep them within memory
+int TextureWorkersCount()
+{
+    int memoryAmount = DetectAmountMemoryGB();
+    if (memoryAmount == 0)
+        memoryAmount = 16;
+    return qMax(1, qMin(omp_get_max_threads(), memoryAmount / 2));
+}
+
+struct ExtractTextureTask
+{
+    Texture *texture;
+    QString name;
+    int exportId;
+    uint crc;
+    PixelFormat pixelFormat;
+    bool storeAs16Bits;
+    bool oneBitAlpha;
+    bool clearAlpha;
+    QString outputFile;
+    QString error;
+};
+
+struct ExtractPackageTasks
+{
+    QVector<ExtractTextureTask> tasks;
+    QStringList errors;
+};
+
+// Runs on a worker thread, collects textures of a package and their CRCs
+void CollectPackageTextures(const QString &packagePath, ExtractPackageTasks &packageTasks,
+                            const QList<TextureMapEntry> &textures, bool pccOnly, bool tfcOnly,
+                            bool mapCrc, const QString &textureTfcFilter)
+{
+    Package package;
+    if (package.Open(g_GameData->GamePath() + packagePath) != 0)
+    {
+        packageTasks.errors.push_back(QString("ERROR: Issue opening package file: ") + packagePath + "\n");
+        return;
+    }
+
+    for (int e = 0; e < package.exportsTable.count(); e++)
+    {
+        Package::ExportEntry& exp = package.exportsTable[e];
+        int id = package.getClassNameId(exp.getClassId());
+        if (id == package.nameIdTexture2D ||
+            id == package.nameIdLightMapTexture2D ||
+            id == package.nameIdShadowMapTexture2D ||
+            id == package.nameIdTextureFlipBook)
+        {
+            ByteBuffer exportData = package.getExportData(e);
+            if (exportData.ptr() == nullptr)
+            {
+                packageTasks.errors.push_back(QString("Error: Texture ") + exp.objectName +
+                                              " has broken export data in package: " +
+                                              packagePath +"\nExport UIndex: " + QString::number(e + 1) + "\nSkipping...\n");
+                continue;
+            }
+            auto texture = new Texture(package, e, exportData);
+            exportData.Free();
+            if (!texture->hasImageData())
+            {
+                delete texture;
+                continue;
+            }
+
+            bool tfcPropExists = texture->getProperties().exists("TextureFileCacheName");
+            if ((pccOnly && tfcPropExists) ||
+                (tfcOnly && !tfcPropExists) ||
+                (tfcOnly && !texture->HasExternalMips()))
+            {
+                delete texture;
+                continue;
+            }
+            if (!pccOnly && !tfcOnly && textureTfcFilter.length() != 0)
+            {
+                if (!tfcPropExists)
+                {
+                    delete texture;
+                    continue;
+                }
+                QString archive = texture->getProperties().getProperty("TextureFileCacheName").getValueName();
+                if (archive != textureTfcFilter ||
+                    !texture->HasExternalMips())
+                {
+                    delete texture;
+                    continue;
+                }
+            }
+
+            ExtractTextureTask task{};
+            task.texture = texture;
+            task.name = exp.objectName;
+            task.exportId = e;
+            if (mapCrc)
+                task.crc = Misc::GetCRCFromTextureMap(textures, e, packagePath);
+            if (task.crc == 0)
+                task.crc = texture->getCrcTopMipmap();
+            task.pixelFormat = Image::getPixelFormatType(texture->getProperties().getProperty("Format").getValueName());
+            if (texture->getProperties().exists("CompressionSettings") &&
+                texture->getProperties().getProperty("CompressionSettings").getValueName() == "TC_HighDynamicRange")
+            {
+                task.pixelFormat = PixelFormat::RGBE;
+            }
+            task.oneBitAlpha = texture->getProperties().exists("CompressionSettings") &&
+                               texture->getProperties().getProperty("CompressionSettings").getValueName() == "TC_OneBitAlpha";
+            task.storeAs16Bits = task.pixelFormat == PixelFormat::RGBE ||
+                                 task.pixelFormat == PixelFormat::R10G10B10A2 ||
+                                 task.pixelFormat == PixelFormat::R16G16B16A16;
+            packageTasks.tasks.push_back(task);
+        }
+    }
+}
+
+void ExtractTexture(ExtractTextureTask &task, bool png, int topMips)
+{
+    Texture &texture = *task.texture;
+    const QString &outputFile = task.outputFile;
+    if (png)
+    {
+        Texture::TextureMipMap mipmap = texture.getTopMipmap();
+        ByteBuffer data = texture.getTopImageData();
+        if (data.ptr() != nullptr)
+        {
+            Image::saveToPng(data, mipmap.width, mipmap.height, task.pixelFormat, outputFile,
+                             !task.storeAs16Bits, task.clearAlpha);
+            data.Free();
+        }
+    }
+    else
+    {
+        texture.removeEmptyMips();
+        int mipsCount = texture.mipMapsList.count();
+        if (topMips > 0)
+            mipsCount = qMin(mipsCount, topMips);
+
+        // Stored mips are already in DDS layout, stream them out one by one
+        // and fill in the header once it is known which of them are readable
+        FileStream fs = FileStream(outputFile, FileMode::Create, FileAccess::WriteOnly);
+        DDSStreamWriter writer(fs, task.pixelFormat);
+        for (int k = 0; k < mipsCount; k++)
+        {
+            ByteBuffer data = texture.getMipMapDataByIndex(k);
+            if (data.ptr() == nullptr)
+            {
+                continue;
+            }
+            writer.WriteMipMap(data, texture.mipMapsList[k].width, texture.mipMapsList[k].height);
+            data.Free();
+        }
+        if (writer.getMipsCount() != 0)
+        {
+            writer.Finish();
+        }
+        else
+        {
+            fs.Close();
+            QFile(outputFile).remove();
+            task.error = QString("Texture skipped. Texture ") + task.name +
+                         QString::asprintf("_0x%08X", task.crc) + " is broken in game data!\n";
+        }
+    }
 }
 
+} // namespace
+
 bool CmdLineTools::extractAllTextures(MeType gameId, QString &outputDir, QString &inputFile,
                                       bool png, bool pccOnly, bool tfcOnly, bool mapCrc,
-                                      QString &textureTfcFilter, bool clearAlpha)
+                                      QString &textureTfcFilter, bool clearAlpha, int topMips)
 {
     Resources resources;
     resources.loadMD5Tables();
@@ -584,144 +955,83 @@ bool CmdLineTools::extractAllTextures(MeType gameId, QString &outputDir, QString
 
     QDir().mkpath(outputDir);
 
+    // Packages are read in batches on workers. Output names and the DXT1
+    // clear alpha state are resolved serially in package order, so results
+    // match a sequential run. Textures of the batch are then extracted on workers.
+    QSet<QString> claimedFiles;
+    int workers = TextureWorkersCount();
+    QStringList packagesList;
     for (int p = 0; p < packages.count(); p++)
+        packagesList.append(g_GameData->GamePath() + packages[p]);
+    PackagePrefetcher::ResetStageStats();
+    PackagePrefetcher prefetcher(packagesList);
+    for (int batchStart = 0; batchStart < packages.count(); batchStart += workers)
     {
-        PINFO(QString("Package ") + QString::number(p + 1) + "/" +
-                             QString::number(packages.count()) + " : " +
-                             packages[p] + "\n");
+        int batchCount = qMin(workers, packages.count() - batchStart);
+        prefetcher.Advance(batchStart + batchCount - 1);
 
-        Package package;
-        if (package.Open(g_GameData->GamePath() + packages[p]) != 0)
+        QVector<ExtractPackageTasks> batch(batchCount);
+        ExtractPackageTasks *batchPtr = batch.data();
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(workers)
+        for (int b = 0; b < batchCount; b++)
         {
-            PERROR(QString("ERROR: Issue opening package file: ") + packages[p] + "\n");
-            continue;
+            CollectPackageTextures(packages.at(batchStart + b), batchPtr[b], textures,
+                                   pccOnly, tfcOnly, mapCrc, textureTfcFilter);
         }
 
-        for (int e = 0; e < package.exportsTable.count(); e++)
+        QVector<ExtractTextureTask> tasks;
+        for (int b = 0; b < batchCount; b++)
         {
-            Package::ExportEntry& exp = package.exportsTable[e];
-            int id = package.getClassNameId(exp.getClassId());
-            if (id == package.nameIdTexture2D ||
-                id == package.nameIdLightMapTexture2D ||
-                id == package.nameIdShadowMapTexture2D ||
-                id == package.nameIdTextureFlipBook)
+            int p = batchStart + b;
+            PINFO(QString("Package ") + QString::number(p + 1) + "/" +
+                                 QString::number(packages.count()) + " : " +
+                                 packages[p] + "\n");
+            foreach (QString error, batch[b].errors)
+                PERROR(error);
+
+            foreach (ExtractTextureTask task, batch[b].tasks)
             {
-                ByteBuffer exportData = package.getExportData(e);
-                if (exportData.ptr() == nullptr)
-                {
-                    PERROR(QString("Error: Texture ") + exp.objectName +
-                                 " has broken export data in package: " +
-                                 packages[p] +"\nExport UIndex: " + QString::number(e + 1) + "\nSkipping...\n");
-                    continue;
-                }
-                Texture texture(package, e, exportData);
-                exportData.Free();
-                if (!texture.hasImageData())
-                {
-                    continue;
-                }
-
-                bool tfcPropExists = texture.getProperties().exists("TextureFileCacheName");
-                if ((pccOnly && tfcPropExists) ||
-                    (tfcOnly && !tfcPropExists) ||
-                    (tfcOnly && !texture.HasExternalMips()))
+                if (task.crc == 0)
                 {
+                    PERROR(QString("Error: Texture ") + task.name + " is broken in package: " +
+                           packages[p] +"\nExport UIndex: " + QString::number(task.exportId + 1) + "\nSkipping...\n");
+                    delete task.texture;
                     continue;
                 }
-                if (!pccOnly && !tfcOnly && textureTfcFilter.length() != 0)
+                task.outputFile = outputDir + "/" + task.name + QString::asprintf("_0x%08X", task.crc) +
+                                  (png ? ".png" : ".dds");
+                // Textures shared between packages map to the same output and are exported once
+                if (claimedFiles.contains(task.outputFile) || QFile(task.outputFile).exists())
                 {
-                    if (!tfcPropExists)
-                        continue;
-                    QString archive = texture.getProperties().getProperty("TextureFileCacheName").getValueName();
-                    if (archive != textureTfcFilter ||
-                        !texture.HasExternalMips())
-                    {
-                        continue;
-                    }
-                }
-                QString name = exp.objectName;
-                uint crc = 0;
-                if (mapCrc)
-                    crc = Misc::GetCRCFromTextureMap(textures, e, packages[p]);
-                if (crc == 0)
-                    crc = texture.getCrcTopMipmap();
-                if (crc == 0)
-                {
-                    PERROR(QString("Error: Texture ") + name + " is broken in package: " +
-                                 packages[p] +"\nExport UIndex: " + QString::number(e + 1) + "\nSkipping...\n");
+                    delete task.texture;
                     continue;
                 }
-                QString outputFile = outputDir + "/" +  name + QString::asprintf("_0x%08X", crc);
-                if (png)
-                {
-                    outputFile += ".png";
-                }
-                else
-                {
-                    outputFile += ".dds";
-                }
-                if (QFile(outputFile).exists())
-                    continue;
-                PixelFormat pixelFormat = Image::getPixelFormatType(texture.getProperties().getProperty("Format").getValueName());
-                if (texture.getProperties().exists("CompressionSettings") &&
-                    texture.getProperties().getProperty("CompressionSettings").getValueName() == "TC_HighDynamicRange")
-                {
-                    pixelFormat = PixelFormat::RGBE;
-                }
-                bool oneBitAlpha = texture.getProperties().exists("CompressionSettings") &&
-                                   texture.getProperties().getProperty("CompressionSettings").getValueName() == "TC_OneBitAlpha";
-                bool storeAs16Bits = false;
-                if (pixelFormat == PixelFormat::RGBE ||
-                    pixelFormat == PixelFormat::R10G10B10A2 ||
-                    pixelFormat == PixelFormat::R16G16B16A16)
-                {
-                    storeAs16Bits = true;
-                }
+                claimedFiles.insert(task.outputFile);
+                // Once set by a DXT1 texture, clearing alpha stays on for the rest of the run
                 if (!clearAlpha)
-                    clearAlpha = (pixelFormat == PixelFormat::DXT1) && !oneBitAlpha;
-                if (png)
-                {
-                    Texture::TextureMipMap mipmap = texture.getTopMipmap();
-                    ByteBuffer data = texture.getTopImageData();
-                    if (data.ptr() != nullptr)
-                    {
-                        if (QFile(outputFile).exists())
-                            QFile(outputFile).remove();
-                        Image::saveToPng(data, mipmap.width, mipmap.height, pixelFormat, outputFile, !storeAs16Bits, clearAlpha);
-                        data.Free();
-                    }
-                }
-                else
-                {
-                    texture.removeEmptyMips();
-                    QList<MipMap *> mipmaps = QList<MipMap *>();
-                    for (int k = 0; k < texture.mipMapsList.count(); k++)
-                    {
-                        ByteBuffer data = texture.getMipMapDataByIndex(k);
-                        if (data.ptr() == nullptr)
-                        {
-                            continue;
-                        }
-                        mipmaps.push_back(new MipMap(data, texture.mipMapsList[k].width, texture.mipMapsList[k].height, pixelFormat));
-                        data.Free();
-                    }
-                    Image image = Image(mipmaps, pixelFormat);
-                    if (image.getMipMaps().count() != 0)
-                    {
-                        if (QFile(outputFile).exists())
-                            QFile(outputFile).remove();
-                        FileStream fs = FileStream(outputFile, FileMode::Create, FileAccess::WriteOnly);
-                        image.StoreImageToDDS(fs);
-                    }
-                    else
-                    {
-                        PERROR(QString("Texture skipped. Texture ") + name +
-                                     QString::asprintf("_0x%08X", crc) + " is broken in game data!\n");
-                    }
-                }
+                    clearAlpha = (task.pixelFormat == PixelFormat::DXT1) && !task.oneBitAlpha;
+                task.clearAlpha = clearAlpha;
+                tasks.push_back(task);
             }
+            batch[b].tasks.clear();
+        }
+
+        ExtractTextureTask *tasksPtr = tasks.data();
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(workers)
+        for (int t = 0; t < tasks.count(); t++)
+        {
+            ExtractTexture(tasksPtr[t], png, topMips);
+            delete tasksPtr[t].texture;
+            tasksPtr[t].texture = nullptr;
+        }
+
+        for (int t = 0; t < tasks.count(); t++)
+        {
+            if (tasks[t].error.length() != 0)
+                PERROR(tasks[t].error);
         }
     }
+    PackagePrefetcher::ReportStageStats();
 
     PINFO("Extracting textures completed.\n\n");
     return true;
@@ -761,16 +1071,21 @@ bool CmdLineTools::extractAllMovieTextures(MeType gameId, QString &outputDir, QS
 
     QDir().mkpath(outputDir);
 
+    // Movies are mostly I/O, packages are processed concurrently and payloads
+    // are copied from the package or TFC straight into the output file
+    QSet<QString> claimedFiles;
+    std::mutex claimLock;
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(TextureWorkersCount())
     for (int p = 0; p < packages.count(); p++)
     {
         PINFO(QString("Package ") + QString::number(p + 1) + "/" +
                              QString::number(packages.count()) + " : " +
-                             packages[p] + "\n");
+                             packages.at(p) + "\n");
 
         Package package;
-        if (package.Open(g_GameData->GamePath() + packages[p]) != 0)
+        if (package.Open(g_GameData->GamePath() + packages.at(p)) != 0)
         {
-            PERROR(QString("ERROR: Issue opening package file: ") + packages[p] + "\n");
+            PERROR(QString("ERROR: Issue opening package file: ") + packages.at(p) + "\n");
             continue;
         }
 
@@ -785,7 +1100,7 @@ bool CmdLineTools::extractAllMovieTextures(MeType gameId, QString &outputDir, QS
                 {
                     PERROR(QString("Error: Movie Texture ") + exp.objectName +
                                  " has broken export data in package: " +
-                                 packages[p] +"\nExport UIndex: " + QString::number(e + 1) + "\nSkipping...\n");
+                                 packages.at(p) +"\nExport UIndex: " + QString::number(e + 1) + "\nSkipping...\n");
                     continue;
                 }
                 TextureMovie textureMovie(package, e, exportData);
@@ -817,22 +1132,28 @@ bool CmdLineTools::extractAllMovieTextures(MeType gameId, QString &outputDir, QS
                 QString name = exp.objectName;
                 uint crc = 0;
                 if (mapCrc)
-                    crc = Misc::GetCRCFromTextureMap(textures, e, packages[p]);
+                    crc = Misc::GetCRCFromTextureMap(textures, e, packages.at(p));
                 if (crc == 0)
                     crc = textureMovie.getCrcData();
                 if (crc == 0)
                 {
                     PERROR(QString("Error: Movie Texture ") + name + " is broken in package: " +
-                                 packages[p] +"\nExport UIndex: " + QString::number(e + 1) + "\nSkipping...\n");
+                                 packages.at(p) +"\nExport UIndex: " + QString::number(e + 1) + "\nSkipping...\n");
                     continue;
                 }
                 QString outputFile = outputDir + "/" +  name + QString::asprintf("_0x%08X.bik", crc);
-                if (QFile(outputFile).exists())
-                    continue;
-                auto data = textureMovie.getData();
+                {
+                    std::lock_guard<std::mutex> guard(claimLock);
+                    if (claimedFiles.contains(outputFile) || QFile(outputFile).exists())
+                        continue;
+                    claimedFiles.insert(outputFile);
+                }
                 FileStream output = FileStream(outputFile, FileMode::Create, FileAccess::ReadWrite);
-                output.WriteFromBuffer(data);
-                data.Free();
+                if (!textureMovie.copyData(output))
+                {
+                    output.Close();
+                    QFile(outputFile).remove();
+                }
             }
         }
     }
@@ -841,89 +1162,131 @@ bool CmdLineTools::extractAllMovieTextures(MeType gameId, QString &outputDir, QS
     return true;
 }
 
-bool CmdLineTools::CheckTextures(MeType gameId)
+namespace {
+
+struct PackageCheckReport
 {
-    ConfigIni configIni = ConfigIni();
-    g_GameData->Init(gameId, configIni);
-    if (!Misc::CheckGamePath())
-        return false;
+    QStringList messages;
+    bool done;
+};
 
-    PINFO("Starting checking textures...\n");
+void AddCheckError(QStringList &messages, const QString &ipcMessage, const QString &message)
+{
+    if (g_ipc)
+        messages.push_back(QString("[IPC]ERROR_TEXTURE_SCAN_DIAGNOSTIC ") + ipcMessage);
+    else
+        messages.push_back(message);
+}
 
-    int lastProgress = -1;
-    for (int i = 0; i < g_GameData->packageFiles.count(); i++)
+// Runs on a worker thread, every package and TFC reader is private to the call
+void CheckPackageTextures(const QString &packagePath, QStringList &messages)
+{
+    Package package;
+    if (package.Open(g_GameData->GamePath() + packagePath) != 0)
     {
-        Package package;
-        if (g_ipc)
-        {
-            ConsoleWrite(QString("[IPC]PROCESSING_FILE ") + g_GameData->packageFiles[i]);
-        }
-        else
+        QString err = "";
+        err += "---- Start --------------------------------------------\n\n" ;
+        err += "Error opening package file: " + packagePath + "\n\n";
+        err += "---- End ----------------------------------------------\n\n";
+        AddCheckError(messages, QString("Error opening package file: ") + packagePath, err);
+        return;
+    }
+
+    for (int e = 0; e < package.exportsTable.count(); e++)
+    {
+        int id = package.getClassNameId(package.exportsTable[e].getClassId());
+        if (id == package.nameIdTexture2D ||
+            id == package.nameIdLightMapTexture2D ||
+            id == package.nameIdShadowMapTexture2D ||
+            id == package.nameIdTextureFlipBook)
         {
-            PINFO(QString("Package ") + QString::number(i + 1) + " of " +
-                         QString::number(g_GameData->packageFiles.count()) + " - " +
-                         g_GameData->packageFiles[i] + "\n");
+            ByteBuffer exportData = package.getExportData(e);
+            Texture texture(package, e, exportData);
+            exportData.Free();
+            texture.removeEmptyMips();
+            for (int m = 0; m < texture.mipMapsList.count(); m++)
+            {
+                ByteBuffer data = texture.getMipMapDataByIndex(m);
+                if (data.ptr() == nullptr)
+                {
+                    AddCheckError(messages,
+                                  QString("Issue accessing texture data: ") +
+                                  package.exportsTable[e].objectName + ", mipmap: " + QString::number(m) + ", package: " +
+                                  packagePath + ", Export UIndex: " + QString::number(e + 1),
+                                  QString("Error: Issue accessing texture data: ") +
+                                  package.exportsTable[e].objectName + "\nMipmap: " + QString::number(m) + "\nPackage: " +
+                                  packagePath + "\nExport UIndex: " + QString::number(e + 1) + "\n");
+                }
+                data.Free();
+            }
         }
-        int newProgress = (i + 1) * 100 / g_GameData->packageFiles.count();
-        if (g_ipc && lastProgress != newProgress)
+    }
+}
+
+void ReportPackageCheck(int index, int count, const QString &packagePath,
+                        const QStringList &messages, int &lastProgress)
+{
+    if (g_ipc)
+    {
+        ConsoleWrite(QString("[IPC]PROCESSING_FILE ") + packagePath);
+    }
+    else
+    {
+        PINFO(QString("Package ") + QString::number(index + 1) + " of " +
+                     QString::number(count) + " - " + packagePath + "\n");
+    }
+    int newProgress = (index + 1) * 100 / count;
+    if (g_ipc && lastProgress != newProgress)
+    {
+        ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+        ConsoleSync();
+        lastProgress = newProgress;
+    }
+    foreach (QString message, messages)
+    {
+        if (g_ipc)
         {
-            ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+            ConsoleWrite(message);
             ConsoleSync();
-            lastProgress = newProgress;
         }
-        if (package.Open(g_GameData->GamePath() + g_GameData->packageFiles[i]) != 0)
+        else
         {
-            if (g_ipc)
-            {
-                ConsoleWrite(QString("[IPC]ERROR_TEXTURE_SCAN_DIAGNOSTIC Error opening package file: ") +
-                             g_GameData->packageFiles[i]);
-                ConsoleSync();
-            }
-            else
-            {
-                QString err = "";
-                err += "---- Start --------------------------------------------\n\n" ;
-                err += "Error opening package file: " + g_GameData->packageFiles[i] + "\n\n";
-                err += "---- End ----------------------------------------------\n\n";
-                PERROR(err);
-            }
-            continue;
+            PERROR(message);
         }
+    }
+}
 
-        for (int e = 0; e < package.exportsTable.count(); e++)
+} // namespace
+
+bool CmdLineTools::CheckTextures(MeType gameId)
+{
+    ConfigIni configIni = ConfigIni();
+    g_GameData->Init(gameId, configIni);
+    if (!Misc::CheckGamePath())
+        return false;
+
+    PINFO("Starting checking textures...\n");
+
+    int count = g_GameData->packageFiles.count();
+    QVector<PackageCheckReport> reports(count, PackageCheckReport{ QStringList(), false });
+    PackageCheckReport *reportsPtr = reports.data();
+    std::mutex reportLock;
+    int nextReport = 0;
+    int lastProgress = -1;
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(TextureWorkersCount())
+    for (int i = 0; i < count; i++)
+    {
+        CheckPackageTextures(g_GameData->packageFiles.at(i), reportsPtr[i].messages);
+
+        // Reports are flushed in package order as soon as all earlier packages are done
+        std::lock_guard<std::mutex> guard(reportLock);
+        reportsPtr[i].done = true;
+        while (nextReport < count && reportsPtr[nextReport].done)
         {
-            int id = package.getClassNameId(package.exportsTable[e].getClassId());
-            if (id == package.nameIdTexture2D ||
-                id == package.nameIdLightMapTexture2D ||
-                id == package.nameIdShadowMapTexture2D ||
-                id == package.nameIdTextureFlipBook)
-            {
-                ByteBuffer exportData = package.getExportData(e);
-                Texture texture(package, e, exportData);
-                exportData.Free();
-                texture.removeEmptyMips();
-                for (int m = 0; m < texture.mipMapsList.count(); m++)
-                {
-                    ByteBuffer data = texture.getMipMapDataByIndex(m);
-                    if (data.ptr() == nullptr)
-                    {
-                        if (g_ipc)
-                        {
-                            ConsoleWrite(QString("[IPC]ERROR_TEXTURE_SCAN_DIAGNOSTIC Issue accessing texture data: ") +
-                                        package.exportsTable[e].objectName + ", mipmap: " + QString::number(m) + ", package: " +
-                                        g_GameData->packageFiles[i] + ", Export UIndex: " + QString::number(e + 1));
-                            ConsoleSync();
-                        }
-                        else
-                        {
-                            PERROR(QString("Error: Issue accessing texture data: ") +
-                                   package.exportsTable[e].objectName + "\nMipmap: " + QString::number(m) + "\nPackage: " +
-                                   g_GameData->packageFiles[i] + "\nExport UIndex: " + QString::number(e + 1) + "\n");
-                        }
-                    }
-                    data.Free();
-                }
-            }
+            ReportPackageCheck(nextReport, count, g_GameData->packageFiles.at(nextReport),
+                               reportsPtr[nextReport].messages, lastProgress);
+            reportsPtr[nextReport].messages.clear();
+            nextReport++;
         }
     }
     PINFO("Finished checking textures.\n\n");
@@ -35,6 +35,7 @@ public:
     int scanTextures(MeType gameId);
     int scan(MeType gameId);
     bool updateTOCs(MeType gameId);
+    bool verifyTOCs(MeType gameId);
     bool GetGamePaths();
     bool unpackArchive(const QString &inputFile, QString &outputDir, QString &filterWithExt, bool flattenPath);
     bool listArchive(const QString &inputFile);
@@ -42,6 +43,8 @@ public:
     bool ConvertToMEM(MeType gameId, QString &inputDir, QString &memFile, bool fastMode, bool markToConvert, bool bc7format, float bc7quality);
     bool convertGameTexture(const QString &inputFile, QString &outputFile,
                             QList<TextureMapEntry> &textures, bool markToConvert, float bc7quality);
+    bool convertGameTexture(const QString &inputFile, const QString &outputFile,
+                            TextureMapEntry foundTex, bool markToConvert, float bc7quality);
     bool convertGameImage(MeType gameId, QString &inputFile, QString &outputFile, bool markToConvert, float bc7quality);
     bool convertGameImages(MeType gameId, QString &inputDir, QString &outputDir, bool markToConvert, float bc7quality);
     bool convertImage(QString &inputFile, QString &outputFile, QString &format, int dxt1Threshold, float bc7qualityValue);
@@ -54,10 +57,11 @@ public:
     bool DetectMods(MeType gameId);
     void AddMarkers();
     bool InstallMods(MeType gameId, QString &inputDir,
-                     bool alotInstaller, bool skipMarkers, bool verify, int cacheAmount);
+                     bool alotInstaller, bool skipMarkers, bool verify, int cacheAmount,
+                     bool dryRun, bool resume);
     bool extractAllTextures(MeType gameId, QString &outputDir, QString &inputFile,
                             bool png, bool pccOnly, bool tfcOnly, bool mapCrc,
-                            QString &textureTfcFilter, bool clearAlpha = false);
+                            QString &textureTfcFilter, bool clearAlpha = false, int topMips = 0);
     bool extractAllMovieTextures(MeType gameId, QString &outputDir, QString &inputFile,
                                     bool pccOnly, bool tfcOnly, bool mapCrc,
                                     QString &textureTfcFilter);
@@ -31,10 +31,198 @@ bool comparePath(const QString &e1, const QString &e2)
     return AsciiStringCompareCaseIgnore(e1, e2) < 0;
 }
 
+namespace {
+
+bool IsDirectChild(const QString &path, const QString &dirPrefix)
+{
+    return path.startsWith(dirPrefix, Qt::CaseInsensitive) &&
+           path.indexOf(QChar('/'), dirPrefix.length()) == -1;
+}
+
+} // namespace
+
+void GameData::ScanInventory()
+{
+    inventory.clear();
+    inventoryIndex.clear();
+    inventoryDirty.clear();
+    inventoryRoot = _path + "/Game/ME" + QString::number((int)gameType);
+    if (_path == "")
+        return;
+
+#ifdef GUI
+    QElapsedTimer timer;
+    timer.start();
+#endif
+    int pathLen = _path.length();
+    const QString roots[] = { inventoryRoot, _path + "/Game/Launcher" };
+    for (const auto &root : roots)
+    {
+        QDirIterator iterator(root, QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
+        while (iterator.hasNext())
+        {
+#ifdef GUI
+            if (timer.elapsed() > 100)
+            {
+                QApplication::processEvents();
+                timer.restart();
+            }
+#endif
+            iterator.next();
+            QFileInfo info = iterator.fileInfo();
+            GameFileInfo file{ iterator.filePath().mid(pathLen), info.size(),
+                               info.lastModified().toMSecsSinceEpoch() };
+            inventoryIndex.insert(file.path, inventory.count());
+            inventory.push_back(file);
+        }
+    }
+}
+
+void GameData::RefreshInventory()
+{
+    bool removed = false;
+    foreach (QString path, inventoryDirty)
+    {
+        QFileInfo info(_path + path);
+        int index = inventoryIndex.value(path, -1);
+        if (!info.exists())
+        {
+            if (index != -1)
+            {
+                inventory[index].size = -1;
+                removed = true;
+            }
+            continue;
+        }
+        GameFileInfo file{ path, info.size(), info.lastModified().toMSecsSinceEpoch() };
+        if (index == -1)
+        {
+            inventoryIndex.insert(path, inventory.count());
+            inventory.push_back(file);
+        }
+        else
+        {
+            inventory[index] = file;
+        }
+    }
+    inventoryDirty.clear();
+
+    if (removed)
+    {
+        inventory.erase(std::remove_if(inventory.begin(), inventory.end(),
+                                       [](const GameFileInfo &file) { return file.size == -1; }),
+                        inventory.end());
+        inventoryIndex.clear();
+        for (int i = 0; i < inventory.count(); i++)
+            inventoryIndex.insert(inventory[i].path, i);
+    }
+}
+
+void GameData::SyncInventory()
+{
+    if (inventoryRoot != _path + "/Game/ME" + QString::number((int)gameType))
+        ScanInventory();
+    else if (!inventoryDirty.isEmpty())
+        RefreshInventory();
+}
+
+QVector<GameFileInfo> GameData::Inventory()
+{
+    std::lock_guard<std::mutex> guard(inventoryLock);
+    SyncInventory();
+    return inventory;
+}
+
+qint64 GameData::InventoryFileSize(const QString &path)
+{
+    {
+        std::lock_guard<std::mutex> guard(inventoryLock);
+        SyncInventory();
+        int index = inventoryIndex.value(path, -1);
+        if (index != -1)
+            return inventory[index].size;
+    }
+    return QFileInfo(_path + path).size();
+}
+
+void GameData::InvalidateInventoryFile(const QString &path)
+{
+    std::lock_guard<std::mutex> guard(inventoryLock);
+    if (inventoryRoot.length() == 0)
+        return;
+    if (path.startsWith(_path + "/"))
+        inventoryDirty.insert(path.mid(_path.length()));
+    else
+        inventoryDirty.insert(path);
+}
+
+void GameData::ResetInventory()
+{
+    std::lock_guard<std::mutex> guard(inventoryLock);
+    inventory.clear();
+    inventoryIndex.clear();
+    inventoryDirty.clear();
+    inventoryRoot = "";
+}
+
+// Game files could be changed by other tools meanwhile, so files kept from
+// previous scan are compared with current state and lists derived from them
+// are dropped if anything was added, removed or modified
+void GameData::RevalidateInventory()
+{
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> guard(inventoryLock);
+        if (inventoryRoot.length() == 0)
+            return;
+        SyncInventory();
+        QVector<GameFileInfo> previous = inventory;
+        QHash<QString, int> previousIndex = inventoryIndex;
+        ScanInventory();
+        if (previous.count() != inventory.count())
+        {
+            changed = true;
+        }
+        else
+        {
+            foreach (const GameFileInfo &file, inventory)
+            {
+                int index = previousIndex.value(file.path, -1);
+                if (index == -1 || previous[index].size != file.size ||
+                    previous[index].modified != file.modified)
+                {
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (changed)
+        ClosePackagesList();
+}
+
+bool GameData::SplitDLCPath(const QString &path, QString &DLCDir, QString &subPath)
+{
+    QString DLCPrefix = DLCData().mid(_path.length()) + "/";
+    if (!path.startsWith(DLCPrefix, Qt::CaseInsensitive))
+        return false;
+    int separator = path.indexOf(QChar('/'), DLCPrefix.length());
+    if (separator == -1)
+        return false;
+    DLCDir = path.mid(DLCPrefix.length(), separator - DLCPrefix.length());
+    if (!DLCDir.startsWith("DLC_", Qt::CaseInsensitive))
+        return false;
+    subPath = path.mid(separator);
+    return true;
+}
+
 void GameData::ScanGameFiles(bool force, const QString &filterPath)
 {
     if (force)
+    {
         ClosePackagesList();
+        ResetInventory();
+    }
 
     if (_path == "")
     {
@@ -42,6 +230,11 @@ void GameData::ScanGameFiles(bool force, const QString &filterPath)
         return;
     }
 
+    // Lists are kept between commands only for the same game and filter
+    QString scanKey = _path + "/Game/ME" + QString::number((int)gameType) + "|" + filterPath;
+    if (scannedFilesKey != scanKey)
+        ClosePackagesList();
+
     if (packageFiles.count() == 0)
     {
         bool status = false;
@@ -69,21 +262,19 @@ void GameData::ScanGameFiles(bool force, const QString &filterPath)
         QElapsedTimer timer;
         timer.start();
 #endif
-        QStringList files;
-        QDirIterator iterator(MainData(), QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
+        const QVector<GameFileInfo> files = Inventory();
         int pathLen = _path.length();
-        while (iterator.hasNext())
-        {
-#ifdef GUI
-            if (timer.elapsed() > 100)
-            {
-                QApplication::processEvents();
-                timer.restart();
-            }
-#endif
-            iterator.next();
-            files.append(iterator.filePath().mid(pathLen));
-        }
+        QString mainPrefix = MainData().mid(pathLen) + "/";
+        QString splashPath = bioGamePath().mid(pathLen) + "/Splash/PC/Splash.bmp";
+        QString shadersPrefix = "/Game/ME" + QString::number((int)gameType) + "/Engine/Shaders/";
+        QString moviesPrefix = bioGamePath().mid(pathLen) + "/Movies/";
+        QString isactPrefix = bioGamePath().mid(pathLen) + "/Content/Packages/ISACT/";
+        QString launcherPrefix = "/Game/Launcher/";
+        QString DLCContentPrefix = DLCDataSuffix() + "/";
+        QString DLCMountPath = DLCDataSuffix() + "/Mount.dlc";
+        QStringList splash, shaders, movies, isacts, launcher, DLCs;
+        QHash<QString, QStringList> DLCsFiles, DLCsMovies;
+        QSet<QString> validDLCs;
 
         for (int f = 0; f < files.count(); f++)
         {
@@ -94,176 +285,147 @@ void GameData::ScanGameFiles(bool force, const QString &filterPath)
                 timer.restart();
             }
 #endif
-            const QString &path = files[f];
-            if (AsciiStringEndsWith(files[f], EXTENSION_TFC, EXTENSION_TFC_LEN))
-            {
-                tfcFiles.push_back(path);
-                continue;
-            }
-            if (AsciiStringEndsWith(files[f], GLOBALPERIST, GLOBALPERIST_LEN))
-                continue;
-            if (AsciiStringEndsWith(files[f], GUIDCACHE_PCC, GUIDCACHE_PCC_LEN))
-                continue;
-            if (AsciiBaseNameStringStartsWith(files[f], GUIDCACHE, GUIDCACHE_LEN))
-                continue;
-            if (AsciiBaseNameStringStartsWith(files[f], COALESCED, COALESCED_LEN))
+            const QString &path = files[f].path;
+            QString DLCDir, subPath;
+            if (path.startsWith(mainPrefix, Qt::CaseInsensitive))
             {
-                othersFiles.push_back(path);
-                continue;
-            }
-
-            if (gameType == MeType::ME2_TYPE ||
-                gameType == MeType::ME3_TYPE)
-            {
-                if (AsciiStringEndsWith(files[f], EXTENSION_AFC, EXTENSION_AFC_LEN))
+                if (AsciiStringEndsWith(path, EXTENSION_TFC, EXTENSION_TFC_LEN))
                 {
-                    othersFiles.push_back(path);
+                    tfcFiles.push_back(path);
                     continue;
                 }
-                if (AsciiStringEndsWith(files[f], EXTENSION_TLK, EXTENSION_TLK_LEN))
+                if (AsciiStringEndsWith(path, GLOBALPERIST, GLOBALPERIST_LEN))
+                    continue;
+                if (AsciiStringEndsWith(path, GUIDCACHE_PCC, GUIDCACHE_PCC_LEN))
+                    continue;
+                if (AsciiBaseNameStringStartsWith(path, GUIDCACHE, GUIDCACHE_LEN))
+                    continue;
+                if (AsciiBaseNameStringStartsWith(path, COALESCED, COALESCED_LEN))
                 {
                     othersFiles.push_back(path);
                     continue;
                 }
-            }
-            mainFiles.push_back(path);
-        };
-
-        QString splashPath = bioGamePath() + "/Splash/PC/Splash.bmp";
-        QString path = splashPath.mid(pathLen);
-        if (QFile::exists(splashPath))
-        {
-            othersFiles.push_back(path);
-        }
 
-        QDirIterator iterator2(_path + "/Game/ME" + QString::number((int)gameType) + "/Engine/Shaders", QDir::Files | QDir::NoSymLinks);
-        while (iterator2.hasNext())
-        {
-            iterator2.next();
-            QString path = iterator2.filePath().mid(pathLen);
-            if (AsciiStringEndsWith(path, EXTENSION_USF, EXTENSION_USF_LEN))
-            {
-                othersFiles.push_back(path);
-            }
-        }
-
-        QDirIterator iterator3(bioGamePath() + "/Movies", QDir::Files | QDir::NoSymLinks);
-        while (iterator3.hasNext())
-        {
-            iterator3.next();
-            QString path = iterator3.filePath().mid(pathLen);
-            if (AsciiStringEndsWith(path, EXTENSION_BIK, EXTENSION_BIK_LEN))
-            {
-                othersFiles.push_back(path);
-            }
-        }
-
-        QDirIterator iterator4(bioGamePath() + "/Content/Packages/ISACT", QDir::Files | QDir::NoSymLinks);
-        while (iterator4.hasNext())
-        {
-            iterator4.next();
-            QString path = iterator4.filePath().mid(pathLen);
-            if (AsciiStringEndsWith(path, EXTENSION_ISB, EXTENSION_ISB_LEN))
-            {
-                othersFiles.push_back(path);
-            }
-        }
-
-        if (QDir(DLCData()).exists())
-        {
-            QStringList DLCs = QDir(DLCData(), "DLC_*", QDir::NoSort, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks).entryList();
-            foreach (QString DLCDir, DLCs)
-            {
-                QStringList files;
-                bool isValid = false;
-                QString validDlcPath = DLCData() + "/" + DLCDir + DLCDataSuffix() + "/Mount.dlc";
-                if (QFile::exists(validDlcPath))
-                    isValid = true;
-                validDlcPath = DLCData() + "/" + DLCDir + "/AutoLoad.ini";
-                if (QFile::exists(validDlcPath))
-                    isValid = true;
-                if (!isValid)
-                    continue;
-
-                QDirIterator iterator(DLCData() + "/" + DLCDir + DLCDataSuffix(), QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-                while (iterator.hasNext())
+                if (gameType == MeType::ME2_TYPE ||
+                    gameType == MeType::ME3_TYPE)
                 {
-#ifdef GUI
-                    if (timer.elapsed() > 100)
+                    if (AsciiStringEndsWith(path, EXTENSION_AFC, EXTENSION_AFC_LEN))
                     {
-                        QApplication::processEvents();
-                        timer.restart();
+                        othersFiles.push_back(path);
+                        continue;
                     }
-#endif
-                    iterator.next();
-                    QString path = iterator.filePath().mid(pathLen);
+                    if (AsciiStringEndsWith(path, EXTENSION_TLK, EXTENSION_TLK_LEN))
+                    {
+                        othersFiles.push_back(path);
+                        continue;
+                    }
+                }
+                mainFiles.push_back(path);
+            }
+            else if (SplitDLCPath(path, DLCDir, subPath))
+            {
+                if (!DLCsFiles.contains(DLCDir))
+                {
+                    DLCs.push_back(DLCDir);
+                    DLCsFiles.insert(DLCDir, QStringList());
+                }
+                if (subPath.compare(DLCMountPath, Qt::CaseInsensitive) == 0 ||
+                    subPath.compare("/AutoLoad.ini", Qt::CaseInsensitive) == 0)
+                {
+                    validDLCs.insert(DLCDir);
+                }
+                if (subPath.startsWith(DLCContentPrefix, Qt::CaseInsensitive))
+                {
                     if (filterPath.length() != 0 && !path.contains(filterPath, Qt::CaseInsensitive))
                         continue;
                     if (AsciiBaseNameStringStartsWith(path, GUIDCACHE, GUIDCACHE_LEN))
                         continue;
-                    files.push_back(path);
+                    DLCsFiles[DLCDir].push_back(path);
                 }
-
-                QDirIterator iterator2(DLCData() + "/" + DLCDir + "/Movies", QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-                while (iterator2.hasNext())
+                else if (subPath.startsWith("/Movies/", Qt::CaseInsensitive) &&
+                         AsciiStringEndsWith(path, EXTENSION_BIK, EXTENSION_BIK_LEN))
                 {
-                    iterator2.next();
-                    QString path = iterator2.filePath().mid(pathLen);
-                    if (AsciiStringEndsWith(path, EXTENSION_BIK, EXTENSION_BIK_LEN))
-                    {
-                        othersFiles.push_back(path);
-                    }
+                    DLCsMovies[DLCDir].push_back(path);
                 }
-                DLCFiles += files;
             }
-
-            if (gameType == MeType::ME1_TYPE)
+            else if (path.compare(splashPath, Qt::CaseInsensitive) == 0)
             {
-                for (int i = 0; i < DLCFiles.count(); i++)
-                {
-                    if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TFC, EXTENSION_TFC_LEN))
-                        tfcFiles.push_back(DLCFiles[i]);
-                }
+                splash.push_back(path);
             }
-            else if (gameType == MeType::ME2_TYPE)
+            else if (IsDirectChild(path, shadersPrefix))
             {
-                for (int i = 0; i < DLCFiles.count(); i++)
-                {
-                    if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TFC, EXTENSION_TFC_LEN))
-                        tfcFiles.push_back(DLCFiles[i]);
-                    else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_AFC, EXTENSION_AFC_LEN))
-                        othersFiles.push_back(DLCFiles[i]);
-                    else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TLK, EXTENSION_TLK_LEN))
-                        othersFiles.push_back(DLCFiles[i]);
-                    else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_INI, EXTENSION_INI_LEN))
-                        othersFiles.push_back(DLCFiles[i]);
-                }
+                if (AsciiStringEndsWith(path, EXTENSION_USF, EXTENSION_USF_LEN))
+                    shaders.push_back(path);
             }
-            else if (gameType == MeType::ME3_TYPE)
+            else if (IsDirectChild(path, moviesPrefix))
             {
-                for (int i = 0; i < DLCFiles.count(); i++)
-                {
-                    if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TFC, EXTENSION_TFC_LEN))
-                        tfcFiles.push_back(DLCFiles[i]);
-                    else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_AFC, EXTENSION_AFC_LEN))
-                        othersFiles.push_back(DLCFiles[i]);
-                    else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TLK, EXTENSION_TLK_LEN))
-                        othersFiles.push_back(DLCFiles[i]);
-                }
+                if (AsciiStringEndsWith(path, EXTENSION_BIK, EXTENSION_BIK_LEN))
+                    movies.push_back(path);
+            }
+            else if (IsDirectChild(path, isactPrefix))
+            {
+                if (AsciiStringEndsWith(path, EXTENSION_ISB, EXTENSION_ISB_LEN))
+                    isacts.push_back(path);
+            }
+            else if (path.startsWith(launcherPrefix, Qt::CaseInsensitive))
+            {
+                if (AsciiStringEndsWith(path, EXTENSION_EXE, EXTENSION_EXE_LEN))
+                    continue;
+                if (AsciiStringEndsWith(path, EXTENSION_DLL, EXTENSION_DLL_LEN))
+                    continue;
+                launcher.push_back(path);
             }
         }
 
-        QDirIterator iterator5(_path + "/Game/Launcher", QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-        while (iterator5.hasNext())
+        othersFiles += splash;
+        othersFiles += shaders;
+        othersFiles += movies;
+        othersFiles += isacts;
+
+        foreach (QString DLCDir, DLCs)
         {
-            iterator5.next();
-            QString path = iterator5.filePath().mid(pathLen);
-            if (AsciiStringEndsWith(path, EXTENSION_EXE, EXTENSION_EXE_LEN))
-                continue;
-            if (AsciiStringEndsWith(path, EXTENSION_DLL, EXTENSION_DLL_LEN))
+            if (!validDLCs.contains(DLCDir))
                 continue;
-            othersFiles.push_back(path);
+            othersFiles += DLCsMovies.value(DLCDir);
+            DLCFiles += DLCsFiles.value(DLCDir);
+        }
+
+        if (gameType == MeType::ME1_TYPE)
+        {
+            for (int i = 0; i < DLCFiles.count(); i++)
+            {
+                if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TFC, EXTENSION_TFC_LEN))
+                    tfcFiles.push_back(DLCFiles[i]);
+            }
+        }
+        else if (gameType == MeType::ME2_TYPE)
+        {
+            for (int i = 0; i < DLCFiles.count(); i++)
+            {
+                if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TFC, EXTENSION_TFC_LEN))
+                    tfcFiles.push_back(DLCFiles[i]);
+                else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_AFC, EXTENSION_AFC_LEN))
+                    othersFiles.push_back(DLCFiles[i]);
+                else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TLK, EXTENSION_TLK_LEN))
+                    othersFiles.push_back(DLCFiles[i]);
+                else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_INI, EXTENSION_INI_LEN))
+                    othersFiles.push_back(DLCFiles[i]);
+            }
         }
+        else if (gameType == MeType::ME3_TYPE)
+        {
+            for (int i = 0; i < DLCFiles.count(); i++)
+            {
+                if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TFC, EXTENSION_TFC_LEN))
+                    tfcFiles.push_back(DLCFiles[i]);
+                else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_AFC, EXTENSION_AFC_LEN))
+                    othersFiles.push_back(DLCFiles[i]);
+                else if (AsciiStringEndsWith(DLCFiles[i], EXTENSION_TLK, EXTENSION_TLK_LEN))
+                    othersFiles.push_back(DLCFiles[i]);
+            }
+        }
+
+        othersFiles += launcher;
 
         std::sort(tfcFiles.begin(), tfcFiles.end(), comparePath);
 
@@ -287,6 +449,7 @@ void GameData::ScanGameFiles(bool force, const QString &filterPath)
         }
 
         std::sort(packageFiles.begin(), packageFiles.end(), comparePath);
+        scannedFilesKey = scanKey;
     }
 }
 
@@ -104,13 +104,29 @@ bool comparePath(const QString &e1, const QString &e2);
 #define LIB_EXT            ".so"
 #endif
 
+struct GameFileInfo
+{
+    QString path; // relative to game path
+    qint64  size;
+    qint64  modified;
+};
+
 class GameData
 {
 private:
     QString _path;
+    QVector<GameFileInfo> inventory;
+    QHash<QString, int> inventoryIndex;
+    QSet<QString> inventoryDirty;
+    std::mutex inventoryLock;
+    QString inventoryRoot;
+    QString scannedFilesKey;
 
     void InternalInit(MeType type, ConfigIni &configIni);
     void ScanGameFiles(bool force, const QString &filterPath);
+    void ScanInventory();
+    void RefreshInventory();
+    void SyncInventory();
 
 public:
     static MeType gameType;
@@ -136,6 +152,13 @@ public:
     const QString ConfigIniPath(MeType type);
     const QString EngineConfigIniPath(MeType type);
     void ClosePackagesList();
+
+    QVector<GameFileInfo> Inventory();
+    qint64 InventoryFileSize(const QString &path);
+    void InvalidateInventoryFile(const QString &path);
+    void ResetInventory();
+    void RevalidateInventory();
+    bool SplitDLCPath(const QString &path, QString &DLCDir, QString &subPath);
 };
 
 extern GameData *g_GameData;
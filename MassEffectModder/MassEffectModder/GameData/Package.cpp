@@ -935,6 +935,7 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
                 QString str(MEMendFileMarker);
                 fs->WriteStringASCII(str);
                 delete fs;
+                g_GameData->InvalidateInventoryFile(packagePath);
             }
         }
         return true;
@@ -1105,8 +1106,11 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
 
     packageStream->Close();
 
-    std::unique_ptr<FileStream> fs (new FileStream(g_GameData->GamePath() + packagePath,
-                                                   FileMode::Create, FileAccess::WriteOnly));
+    // Package is written aside and moved over the original once complete,
+    // so interruption never leaves a truncated package behind
+    QString filePath = g_GameData->GamePath() + packagePath;
+    QString tempPath = SaveTempPath(filePath);
+    std::unique_ptr<FileStream> fs (new FileStream(tempPath, FileMode::Create, FileAccess::WriteOnly));
     if (fs == nullptr) {
         PERROR(QString("FATAL ERROR: Failed to open file for writing: %1").arg(packagePath));
         return false;
@@ -1187,7 +1191,9 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
                 {
                     PERROR(QString("FATAL ERROR: Out of memory! - amount: ") +
                            QString::number(block.uncomprSize));
-                    return -1;
+                    fs.reset();
+                    QFile(tempPath).remove();
+                    return false;
                 }
                 tempOutput.ReadToBuffer(block.uncompressedBuffer, block.uncomprSize);
                 chunk.blocks.push_back(block);
@@ -1238,6 +1244,8 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
 
             if (errorStatus)
             {
+                fs.reset();
+                QFile(tempPath).remove();
                 return false;
             }
 
@@ -1291,6 +1299,17 @@ bool Package::SaveToFile(bool forceCompressed, bool forceDecompressed, bool appe
         fs->WriteStringASCII(str);
     }
 
+    fs->Sync();
+    fs.reset();
+    bool replaced = ReplaceFile(tempPath, filePath);
+    g_GameData->InvalidateInventoryFile(packagePath);
+    if (!replaced)
+    {
+        PERROR(QString("FATAL ERROR: Failed to replace package file: %1\n").arg(packagePath));
+        QFile(tempPath).remove();
+        return false;
+    }
+
     return true;
 }
 
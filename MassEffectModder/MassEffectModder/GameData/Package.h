@@ -433,6 +433,7 @@ public:
     void loadGuids(Stream &input);
     void saveGuids(Stream &output);
     bool SaveToFile(bool forceCompressed = false, bool forceDecompressed = false, bool appendMarker = true);
+    static QString SaveTempPath(const QString &filePath) { return filePath + ".memsave"; }
     static const ByteBuffer compressData(const ByteBuffer &inputData, StorageTypes type,
                                          bool maxCompress = true);
     static const ByteBuffer decompressData(Stream &stream, StorageTypes type,
@@ -26,6 +26,7 @@
 
 #include <Helpers/FileStream.h>
 #include <Helpers/MiscHelpers.h>
+#include <Helpers/Logs.h>
 #include <GameData/TOCFile.h>
 #include <GameData/GameData.h>
 
@@ -81,167 +82,339 @@ quint32 hashFilename(const void *data, quint32 length)
     return hash;
 }
 
+const char *const mainExtensions[] =
+{
+    ".pcc", ".upk", ".tfc", ".tlk", ".afc", ".cnd", ".ini", ".txt", ".bin", nullptr
+};
+
+const char *const ME1DLCExtensions[] =
+{
+    ".pcc", ".upk", ".tfc", ".tlk", ".afc", ".cnd", ".bik", ".ini", ".dlc", ".bin", nullptr
+};
+
+const char *const DLCExtensions[] =
+{
+    ".pcc", ".upk", ".tfc", ".tlk", ".afc", ".cnd", ".bik", ".ini", ".txt", ".dlc", ".bin", nullptr
+};
+
+bool HasExtension(const QString &path, const char *const extensions[])
+{
+    for (int i = 0; extensions[i] != nullptr; i++)
+    {
+        if (path.endsWith(extensions[i], Qt::CaseInsensitive))
+            return true;
+    }
+    return false;
+}
+
 } // namespace
 
 void TOCBinFile::UpdateAllTOCBinFiles(MeType gameType)
 {
-    GenerateMainTocBinFile(gameType);
+    QList<TocFile> tocFiles;
+    CollectMainTocBinFile(gameType, tocFiles);
     if (gameType != MeType::ME1_TYPE)
-        GenerateDLCsTocBinFiles();
+        CollectDLCsTocBinFiles(tocFiles);
+
+    int patched = 0, rebuilt = 0;
+    for (auto &tocFile : tocFiles)
+    {
+        if (PatchTocBinFile(tocFile.path, tocFile.files))
+        {
+            patched++;
+        }
+        else
+        {
+            CreateTocBinFile(tocFile.path, tocFile.files);
+            rebuilt++;
+        }
+    }
+    PDEBUG(QString("TOC files patched: %1, rebuilt: %2\n").arg(patched).arg(rebuilt));
+}
+
+bool TOCBinFile::VerifyAllTOCBinFiles(MeType gameType)
+{
+    QList<TocFile> tocFiles;
+    CollectMainTocBinFile(gameType, tocFiles);
+    if (gameType != MeType::ME1_TYPE)
+        CollectDLCsTocBinFiles(tocFiles);
+
+    bool status = true;
+    for (const auto &tocFile : tocFiles)
+    {
+        QVector<TocEntry> entries;
+        if (!ReadTocBinFile(tocFile.path, entries))
+        {
+            if (g_ipc)
+            {
+                ConsoleWrite(QString("[IPC]ERROR_TOC_FILE ") + tocFile.path);
+                ConsoleSync();
+            }
+            else
+            {
+                PERROR(QString("Missing or broken TOC file: ") + tocFile.path + "\n");
+            }
+            status = false;
+            continue;
+        }
+
+        QSet<QString> listed;
+        for (const auto &entry : entries)
+            listed.insert(entry.path);
+        for (const auto &file : tocFile.files)
+        {
+            if (listed.contains(file.path))
+                continue;
+            QString path = tocFile.basePath + "/" + QString(file.path).replace(QChar('\\'), QChar('/'));
+            if (g_ipc)
+            {
+                ConsoleWrite(QString("[IPC]ERROR_TOC_NOT_LISTED ") + path);
+                ConsoleSync();
+            }
+            else
+            {
+                PERROR(QString("File not listed in TOC: ") + path + "\n");
+            }
+            status = false;
+        }
+
+        QVector<qint64> diskSizes(entries.count());
+        qint64 *diskSizesPtr = diskSizes.data();
+        const TocEntry *entriesPtr = entries.constData();
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (int i = 0; i < entries.count(); i++)
+        {
+            QString path = tocFile.basePath + "/" + QString(entriesPtr[i].path).replace(QChar('\\'), QChar('/'));
+            QFileInfo info(path);
+            diskSizesPtr[i] = info.exists() ? info.size() : -1;
+        }
+
+        for (int i = 0; i < entries.count(); i++)
+        {
+            // TOC lists itself with the size it had before being regenerated
+            if (entries[i].path.compare("PCConsoleTOC.bin", Qt::CaseInsensitive) == 0)
+                continue;
+            if (diskSizes[i] == entries[i].size)
+                continue;
+            QString path = tocFile.basePath + "/" + QString(entries[i].path).replace(QChar('\\'), QChar('/'));
+            if (g_ipc)
+            {
+                ConsoleWrite(QString("[IPC]ERROR_TOC_MISMATCH ") + path);
+                ConsoleSync();
+            }
+            else if (diskSizes[i] == -1)
+            {
+                PERROR(QString("File listed in TOC is missing: ") + path + "\n");
+            }
+            else
+            {
+                PERROR(QString("File size mismatch in TOC: ") + path + ", TOC: " +
+                       QString::number(entries[i].size) + ", disk: " + QString::number(diskSizes[i]) + "\n");
+            }
+            status = false;
+        }
+    }
+
+    return status;
+}
+
+TOCBinFile::FileEntry TOCBinFile::MakeFileEntry(const QString &path, qint64 size)
+{
+    FileEntry file{};
+    file.size = size;
+    file.path = QString(path).replace(QChar('/'), QChar('\\'), Qt::CaseInsensitive);
+    return file;
 }
 
-void TOCBinFile::GenerateMainTocBinFile(MeType gameType)
+void TOCBinFile::CollectMainTocBinFile(MeType gameType, QList<TocFile> &tocFiles)
 {
-    QStringList files;
-    QString gamePath = g_GameData->GamePath() + "/Game/ME" + QString::number((int)gameType);
-    int pathLen = gamePath.length();
-    QDirIterator MainIterator(g_GameData->MainData(), QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-    while (MainIterator.hasNext())
+    QString gameDir = "/Game/ME" + QString::number((int)gameType);
+    int pathLen = g_GameData->GamePath().length();
+    QString mainPrefix = g_GameData->MainData().mid(pathLen) + "/";
+    QString moviesPrefix = g_GameData->bioGamePath().mid(pathLen) + "/Movies/";
+    QString contentPrefix = g_GameData->bioGamePath().mid(pathLen) + "/Content/";
+    QString enginePrefix = gameDir + "/Engine/";
+
+    QVector<FileEntry> mainList, moviesList, isbList, usfList;
+    QStringList DLCs;
+    QHash<QString, QVector<FileEntry>> DLCsList;
+    QSet<QString> validDLCs;
+    const QVector<GameFileInfo> inventory = g_GameData->Inventory();
+    for (const auto &file : inventory)
     {
 #ifdef GUI
         QApplication::processEvents();
 #endif
-        MainIterator.next();
-        if (MainIterator.filePath().endsWith(".pcc", Qt::CaseInsensitive) ||
-            MainIterator.filePath().endsWith(".upk", Qt::CaseInsensitive) ||
-            MainIterator.filePath().endsWith(".tfc", Qt::CaseInsensitive) ||
-            MainIterator.filePath().endsWith(".tlk", Qt::CaseInsensitive) ||
-            MainIterator.filePath().endsWith(".afc", Qt::CaseInsensitive) ||
-            MainIterator.filePath().endsWith(".cnd", Qt::CaseInsensitive) ||
-            MainIterator.filePath().endsWith(".ini", Qt::CaseInsensitive) ||
-            MainIterator.filePath().endsWith(".txt", Qt::CaseInsensitive) ||
-            MainIterator.filePath().endsWith(".bin", Qt::CaseInsensitive))
+        QString DLCDir, subPath;
+        if (file.path.startsWith(mainPrefix, Qt::CaseInsensitive))
         {
-            files.push_back(MainIterator.filePath().mid(pathLen + 1));
+            if (HasExtension(file.path, mainExtensions))
+                mainList.push_back(MakeFileEntry(file.path.mid(gameDir.length() + 1), file.size));
+        }
+        else if (file.path.startsWith(moviesPrefix, Qt::CaseInsensitive))
+        {
+            if (file.path.endsWith(".bik", Qt::CaseInsensitive))
+                moviesList.push_back(MakeFileEntry(file.path.mid(gameDir.length() + 1), file.size));
+        }
+        else if (file.path.startsWith(contentPrefix, Qt::CaseInsensitive))
+        {
+            if (file.path.endsWith(".isb", Qt::CaseInsensitive))
+                isbList.push_back(MakeFileEntry(file.path.mid(gameDir.length() + 1), file.size));
+        }
+        else if (file.path.startsWith(enginePrefix, Qt::CaseInsensitive))
+        {
+            if (file.path.endsWith(".usf", Qt::CaseInsensitive))
+                usfList.push_back(MakeFileEntry(file.path.mid(gameDir.length() + 1), file.size));
+        }
+        else if (gameType == MeType::ME1_TYPE && g_GameData->SplitDLCPath(file.path, DLCDir, subPath))
+        {
+            if (!DLCsList.contains(DLCDir))
+            {
+                DLCs.push_back(DLCDir);
+                DLCsList.insert(DLCDir, QVector<FileEntry>());
+            }
+            if (subPath.compare("/AutoLoad.ini", Qt::CaseInsensitive) == 0)
+                validDLCs.insert(DLCDir);
+            if (HasExtension(subPath, ME1DLCExtensions))
+                DLCsList[DLCDir].push_back(MakeFileEntry(subPath.mid(1), file.size));
         }
     }
 
-    QDirIterator MoviesIterator(g_GameData->bioGamePath() + "/Movies", QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-    while (MoviesIterator.hasNext())
+    QVector<FileEntry> filesList = mainList + moviesList + isbList + usfList;
+    foreach (QString DLCDir, DLCs)
     {
-        MoviesIterator.next();
-        if (MoviesIterator.filePath().endsWith(".bik", Qt::CaseInsensitive))
-            files.push_back(MoviesIterator.filePath().mid(pathLen + 1));
+        if (validDLCs.contains(DLCDir))
+            filesList += DLCsList.value(DLCDir);
     }
+    tocFiles.push_back({ g_GameData->bioGamePath() + "/PCConsoleTOC.bin",
+                         g_GameData->GamePath() + gameDir, filesList });
+}
 
-    if (QDir(g_GameData->bioGamePath() + "/Content").exists())
+void TOCBinFile::CollectDLCsTocBinFiles(QList<TocFile> &tocFiles)
+{
+    QString mountPath = g_GameData->DLCDataSuffix() + "/Mount.dlc";
+    QStringList DLCs;
+    QHash<QString, QVector<FileEntry>> DLCsList;
+    QSet<QString> validDLCs;
+    const QVector<GameFileInfo> inventory = g_GameData->Inventory();
+    for (const auto &file : inventory)
     {
-        QDirIterator IsbIterator(g_GameData->bioGamePath() + "/Content", QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-        while (IsbIterator.hasNext())
+        QString DLCDir, subPath;
+        if (!g_GameData->SplitDLCPath(file.path, DLCDir, subPath))
+            continue;
+        if (!DLCsList.contains(DLCDir))
         {
-            IsbIterator.next();
-            if (IsbIterator.filePath().endsWith(".isb", Qt::CaseInsensitive))
-                files.push_back(IsbIterator.filePath().mid(pathLen + 1));
+            DLCs.push_back(DLCDir);
+            DLCsList.insert(DLCDir, QVector<FileEntry>());
         }
+        if (subPath.compare(mountPath, Qt::CaseInsensitive) == 0)
+            validDLCs.insert(DLCDir);
+        if (HasExtension(subPath, DLCExtensions))
+            DLCsList[DLCDir].push_back(MakeFileEntry(subPath.mid(1), file.size));
     }
 
-    QDirIterator UsfIterator(gamePath + "/Engine", QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-    while (UsfIterator.hasNext())
+    foreach (QString DLCDir, DLCs)
     {
-        UsfIterator.next();
-        if (UsfIterator.filePath().endsWith(".usf", Qt::CaseInsensitive))
-            files.push_back(UsfIterator.filePath().mid(pathLen + 1));
+        if (!validDLCs.contains(DLCDir))
+            continue;
+        QString DLCPath = g_GameData->DLCData() + "/" + DLCDir;
+        tocFiles.push_back({ DLCPath + "/PCConsoleTOC.bin", DLCPath, DLCsList.value(DLCDir) });
     }
+}
+
+bool TOCBinFile::ReadTocBinFile(const QString &path, QVector<TocEntry> &entries)
+{
+    if (!QFile(path).exists())
+        return false;
 
-    if (gameType == MeType::ME1_TYPE && QDir(g_GameData->DLCData()).exists())
+    FileStream tocFile = FileStream(path, FileMode::Open, FileAccess::ReadOnly);
+    qint64 length = tocFile.Length();
+    if (length < 12 || tocFile.ReadUInt32() != TOCTag)
+        return false;
+    tocFile.Skip(4);
+    quint32 tableSize = tocFile.ReadUInt32();
+    if (12 + (qint64)tableSize * 8 > length)
+        return false;
+
+    for (quint32 b = 0; b < tableSize; b++)
     {
-        int pathLen = g_GameData->DLCData().length();
-        QStringList DLCs = QDir(g_GameData->DLCData(), "DLC_*", QDir::NoSort, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks).entryList();
-        foreach (QString DLCDir, DLCs)
+        qint64 bucketPos = 12 + (qint64)b * 8;
+        tocFile.JumpTo(bucketPos);
+        quint32 entriesOffset = tocFile.ReadUInt32();
+        quint32 entriesCount = tocFile.ReadUInt32();
+        qint64 entryPos = bucketPos + entriesOffset;
+        for (quint32 e = 0; e < entriesCount; e++)
         {
-            QString validDlcPath = g_GameData->DLCData() + "/" + DLCDir + "/AutoLoad.ini";
-            if (!QFile::exists(validDlcPath))
-                continue;
-            QDirIterator iterator(g_GameData->DLCData() + "/" + DLCDir, QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-            while (iterator.hasNext())
-            {
-                iterator.next();
-                if (iterator.filePath().endsWith(".pcc", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".upk", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".tfc", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".tlk", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".afc", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".cnd", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".bik", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".ini", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".dlc", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".bin", Qt::CaseInsensitive))
-                {
-                    files.push_back(iterator.filePath().mid(pathLen + DLCDir.length() + 2));
-                }
-            }
+            if (entryPos + 28 >= length)
+                return false;
+            tocFile.JumpTo(entryPos);
+            quint16 blockSize = tocFile.ReadUInt16();
+            tocFile.Skip(2);
+            TocEntry entry;
+            entry.sizeOffset = entryPos + 4;
+            entry.size = tocFile.ReadUInt32();
+            tocFile.Skip(20);
+            tocFile.ReadStringASCIINull(entry.path);
+            entries.push_back(entry);
+            // block size of the very last entry is zeroed
+            if (blockSize == 0 && e + 1 != entriesCount)
+                return false;
+            entryPos += blockSize;
         }
     }
 
-    QVector<FileEntry> filesList;
-    for (int f = 0; f < files.count(); f++)
-    {
-        FileEntry file{};
-        QString path = gamePath + "/" + files[f];
-        file.size = QFileInfo(path).size();
-        QString filenameToHash = BaseName(files[f]).toUpper();
-        file.hashFilename = hashFilename(filenameToHash.toStdString().c_str(), filenameToHash.length());
-        file.path = files[f].replace(QChar('/'), QChar('\\'), Qt::CaseInsensitive);
-        filesList.push_back(file);
-    }
-    QString tocFile = g_GameData->bioGamePath() + "/PCConsoleTOC.bin";
-    CreateTocBinFile(tocFile, filesList);
+    return true;
 }
 
-void TOCBinFile::GenerateDLCsTocBinFiles()
+bool TOCBinFile::PatchTocBinFile(const QString &path, const QVector<FileEntry> &filesList)
 {
-    if (QDir(g_GameData->DLCData()).exists())
+    QVector<TocEntry> entries;
+    if (!ReadTocBinFile(path, entries) || entries.count() != filesList.count())
+        return false;
+
+    QHash<QString, int> entriesIndex;
+    for (int i = 0; i < entries.count(); i++)
+        entriesIndex.insert(entries[i].path, i);
+
+    QVector<int> changed;
+    for (const auto &file : filesList)
     {
-        int pathLen = g_GameData->DLCData().length();
-        QStringList DLCs = QDir(g_GameData->DLCData(), "DLC_*", QDir::NoSort, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks).entryList();
-        foreach (QString DLCDir, DLCs)
+        int index = entriesIndex.value(file.path, -1);
+        if (index == -1)
+            return false;
+        if (entries[index].size != file.size)
         {
-            QStringList files;
-            QString validDlcPath = g_GameData->DLCData() + "/" + DLCDir + g_GameData->DLCDataSuffix() + "/Mount.dlc";
-            if (!QFile::exists(validDlcPath))
-                continue;
-            QDirIterator iterator(g_GameData->DLCData() + "/" + DLCDir, QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-            while (iterator.hasNext())
-            {
-                iterator.next();
-                if (iterator.filePath().endsWith(".pcc", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".upk", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".tfc", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".tlk", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".afc", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".cnd", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".bik", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".ini", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".txt", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".dlc", Qt::CaseInsensitive) ||
-                    iterator.filePath().endsWith(".bin", Qt::CaseInsensitive))
-                {
-                    files.push_back(iterator.filePath().mid(pathLen + DLCDir.length() + 2));
-                }
-            }
+            entries[index].size = file.size;
+            changed.push_back(index);
+        }
+    }
 
-            QVector<FileEntry> filesList;
-            for (int f = 0; f < files.count(); f++)
-            {
-                FileEntry file{};
-                QString path = g_GameData->DLCData() + "/" + DLCDir + "/" + files[f];
-                file.size = QFileInfo(path).size();
-                QString filenameToHash = BaseName(files[f]).toUpper();
-                file.hashFilename = hashFilename(filenameToHash.toStdString().c_str(), filenameToHash.length());
-                file.path = files[f].replace(QChar('/'), QChar('\\'), Qt::CaseInsensitive);
-                filesList.push_back(file);
-            }
-            QString tocFile = g_GameData->DLCData() + "/" + DLCDir + "/PCConsoleTOC.bin";
-            CreateTocBinFile(tocFile, filesList);
+    if (changed.count() != 0)
+    {
+        FileStream tocFile = FileStream(path, FileMode::Open, FileAccess::ReadWrite);
+        for (int index : changed)
+        {
+            tocFile.JumpTo(entries[index].sizeOffset);
+            tocFile.WriteUInt32(entries[index].size);
         }
+        g_GameData->InvalidateInventoryFile(path);
     }
+    PDEBUG(QString("TOC file: ") + path + ", patched entries: " + QString::number(changed.count()) + "\n");
+
+    return true;
 }
 
-void TOCBinFile::CreateTocBinFile(QString &path, const QVector<FileEntry>& filesList)
+void TOCBinFile::CreateTocBinFile(const QString &path, QVector<FileEntry> filesList)
 {
     if (QFile(path).exists())
         QFile::remove(path);
 
+    for (auto &fileEntry : filesList)
+    {
+        QString filenameToHash = BaseName(fileEntry.path).toUpper();
+        fileEntry.hashFilename = hashFilename(filenameToHash.toStdString().c_str(), filenameToHash.length());
+    }
+
     quint32 tableSize = filesList.size();
     quint32 minTableSize = tableSize / 2;
     QSet<quint32> uniques;
@@ -316,4 +489,5 @@ void TOCBinFile::CreateTocBinFile(QString &path, const QVector<FileEntry>& files
         tocFile.JumpTo(lastOffset);
         tocFile.WriteUInt16(0);
     }
+    g_GameData->InvalidateInventoryFile(path);
 }
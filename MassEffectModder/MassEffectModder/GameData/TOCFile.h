@@ -35,15 +35,33 @@ class TOCBinFile
         quint32 hashFilename;
     };
 
+    struct TocFile
+    {
+        QString path;
+        QString basePath;
+        QVector<FileEntry> files;
+    };
+
+    struct TocEntry
+    {
+        QString path;
+        quint32 size;
+        qint64  sizeOffset;
+    };
+
 private:
 
-    static void GenerateMainTocBinFile(MeType gameType);
-    static void GenerateDLCsTocBinFiles();
-    static void CreateTocBinFile(QString &path, const QVector<FileEntry>& filesList);
+    static FileEntry MakeFileEntry(const QString &path, qint64 size);
+    static void CollectMainTocBinFile(MeType gameType, QList<TocFile> &tocFiles);
+    static void CollectDLCsTocBinFiles(QList<TocFile> &tocFiles);
+    static bool ReadTocBinFile(const QString &path, QVector<TocEntry> &entries);
+    static bool PatchTocBinFile(const QString &path, const QVector<FileEntry> &filesList);
+    static void CreateTocBinFile(const QString &path, QVector<FileEntry> filesList);
 
 public:
 
     static void UpdateAllTOCBinFiles(MeType gameType);
+    static bool VerifyAllTOCBinFiles(MeType gameType);
 };
 
 #endif
@@ -192,6 +192,7 @@ void LayoutMain::UpdateTOCsSelected(MeType gameType)
         return;
     }
 
+    g_GameData->ResetInventory();
     TOCBinFile::UpdateAllTOCBinFiles(gameType);
     mainWindow->statusBar()->clearMessage();
     QMessageBox::information(this, "Updating TOC files", "All TOC files updated.");
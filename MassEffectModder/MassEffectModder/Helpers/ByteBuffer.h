@@ -30,6 +30,7 @@ private:
 
     quint8 *_ptr;
     qint64 _size;
+    bool _owned;
 
 public:
 
@@ -37,6 +38,7 @@ public:
     {
         _ptr = nullptr;
         _size = 0;
+        _owned = true;
     }
 
     ByteBuffer(quint64 size)
@@ -45,6 +47,7 @@ public:
         if (_ptr == nullptr)
             CRASH_MSG((QString("ByteBuffer: Out of memory! - amount: ") + QString::number(size)).toStdString().c_str());
         _size = size;
+        _owned = true;
     }
 
     ByteBuffer(const quint8 *ptr, quint64 size)
@@ -54,6 +57,7 @@ public:
             CRASH_MSG((QString("ByteBuffer: Out of memory! - amount: ") + QString::number(size)).toStdString().c_str());
         memcpy(_ptr, ptr, size);
         _size = size;
+        _owned = true;
     }
 
     ByteBuffer(const float *ptr, quint64 size)
@@ -63,14 +67,31 @@ public:
             CRASH_MSG((QString("ByteBuffer: Out of memory! - amount: ") + QString::number(size)).toStdString().c_str());
         memcpy(_ptr, ptr, size);
         _size = size;
+        _owned = true;
+    }
+
+    // Non-owning buffer over existing memory, Free() only detaches it
+    static ByteBuffer view(quint8 *ptr, qint64 size)
+    {
+        ByteBuffer buffer;
+        buffer._ptr = ptr;
+        buffer._size = size;
+        buffer._owned = false;
+        return buffer;
     }
 
     void Free()
     {
-        delete[] _ptr;
+        if (_owned)
+            delete[] _ptr;
         _ptr = nullptr;
     }
 
+    [[nodiscard]] bool isOwned() const
+    {
+        return _owned;
+    }
+
     [[nodiscard]] quint8 *ptr() const
     {
         return _ptr;
@@ -19,6 +19,15 @@
  *
  */
 
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <cerrno>
+#endif
+
 #include "FileStream.h"
 
 void FileStream::CheckFileIOErrorStatus()
@@ -83,6 +92,18 @@ void FileStream::Flush()
     file->flush();
 }
 
+// Flush and wait until data reach the disk
+void FileStream::Sync()
+{
+    file->flush();
+    CheckFileIOErrorStatus();
+#if defined(_WIN32)
+    _commit(file->handle());
+#else
+    fsync(file->handle());
+#endif
+}
+
 void FileStream::Close()
 {
     file->close();
@@ -117,6 +138,48 @@ void FileStream::CopyFrom(Stream &stream, qint64 count, qint64 bufferSize)
     } while (count != 0);
 }
 
+void FileStream::CopyFromFile(FileStream &stream, qint64 count)
+{
+    if (count == 0)
+        return;
+
+    if (count < 0)
+        CRASH();
+
+#if defined(__linux__)
+    // Let kernel copy data between files, fallback to buffered copy if not supported
+    file->flush();
+    CheckFileIOErrorStatus();
+    loff_t srcOffset = stream.Position();
+    loff_t dstOffset = Position();
+    qint64 remain = count;
+    while (remain != 0)
+    {
+        ssize_t copied = copy_file_range(stream.file->handle(), &srcOffset,
+                                         file->handle(), &dstOffset,
+                                         static_cast<size_t>(qMin(remain, (qint64)0x40000000)), 0);
+        if (copied <= 0)
+        {
+            if (copied == 0 || errno == EXDEV || errno == ENOSYS ||
+                errno == EINVAL || errno == EOPNOTSUPP)
+            {
+                break;
+            }
+            auto error = (QString("Error: copy_file_range failed, File: ") + file->fileName()).toStdString();
+            CRASH_MSG(error.c_str());
+        }
+        remain -= copied;
+    }
+    stream.JumpTo(srcOffset);
+    JumpTo(dstOffset);
+    count = remain;
+    if (count == 0)
+        return;
+#endif
+
+    CopyFrom(stream, count, copyBufferSize);
+}
+
 void FileStream::ReadToBuffer(quint8 *buffer, qint64 count)
 {
     file->read(reinterpret_cast<char *>(buffer), count);
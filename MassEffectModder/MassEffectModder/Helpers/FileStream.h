@@ -43,6 +43,11 @@ class FileStream : public Stream
 {
 private:
 
+    enum BufferSize
+    {
+        copyBufferSize = 0x400000, // 4MB
+    };
+
     QFile *file;
 
     void CheckFileIOErrorStatus();
@@ -59,9 +64,11 @@ public:
 
     bool isOpen() { return file->isOpen(); }
     void Flush() override;
+    void Sync();
     void Close() override;
 
     void CopyFrom(Stream &stream, qint64 count, qint64 bufferSize = 10000) override;
+    void CopyFromFile(FileStream &stream, qint64 count);
     void ReadToBuffer(quint8 *buffer, qint64 count) override;
     ByteBuffer ReadToBuffer(qint64 count) override;
     ByteBuffer ReadAllToBuffer();
@@ -122,6 +122,17 @@ QStringList FilterByFilename(const QStringList &list, const QString &filename)
     return filteredList;
 }
 
+// Atomically moves source over target, target is never seen partially written
+bool ReplaceFile(const QString &source, const QString &target)
+{
+#if defined(_WIN32)
+    return MoveFileExW(source.toStdWString().c_str(), target.toStdWString().c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(source.toUtf8().constData(), target.toUtf8().constData()) == 0;
+#endif
+}
+
 bool DetectAdminRights()
 {
     bool status;
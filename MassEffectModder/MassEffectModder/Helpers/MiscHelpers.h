@@ -32,6 +32,7 @@ QString DirName(const QString &path);
 QString BaseNameWithoutExt(const QString &path);
 QString GetFileExtension(const QString &path);
 QStringList FilterByFilename(const QStringList &list, const QString &filename);
+bool ReplaceFile(const QString &source, const QString &target);
 
 inline bool AsciiStringEndsWith(const QString &str, const char *endStr, int endStrLen)
 {
@@ -0,0 +1,162 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2017-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
+
+#include <Helpers/ByteBuffer.h>
+#include <Helpers/Logs.h>
+#include <Helpers/MiscHelpers.h>
+#include <Helpers/PackagePrefetcher.h>
+
+namespace {
+
+int prefetchDefaultDepth = 2;
+std::atomic<int> stagePackages(0);
+std::atomic<int> stageHits(0);
+std::atomic<qint64> stageOverlapTime(0);
+
+} // namespace
+
+PackagePrefetcher::PackagePrefetcher(const QStringList &filesList, int prefetchDepth)
+    : files(filesList), ready(filesList.count(), false),
+      readTime(filesList.count(), 0), depth(prefetchDepth)
+{
+    if (depth > 0 && files.count() > 1)
+        worker = std::thread(&PackagePrefetcher::Worker, this);
+}
+
+PackagePrefetcher::~PackagePrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+    }
+    wakeUp.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+void PackagePrefetcher::Advance(int index)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        current = index;
+        if (next <= index)
+            next = index + 1;
+        if (depth > 0 && index > 0 && index < files.count())
+        {
+            stagePackages++;
+            if (ready[index])
+            {
+                stageHits++;
+                stageOverlapTime += readTime[index];
+            }
+        }
+    }
+    wakeUp.notify_all();
+}
+
+void PackagePrefetcher::Worker()
+{
+    ByteBuffer buffer(readChunkSize);
+    std::unique_lock<std::mutex> guard(lock);
+    while (true)
+    {
+        wakeUp.wait(guard, [this] {
+            return quit || (next < files.count() && next <= current + depth);
+        });
+        if (quit)
+            break;
+
+        int index = next++;
+        guard.unlock();
+        qint64 time = 0;
+        bool warmed = WarmFile(index, buffer.ptr(), time);
+        guard.lock();
+        if (warmed)
+        {
+            ready[index] = true;
+            readTime[index] = time;
+        }
+    }
+    guard.unlock();
+    buffer.Free();
+}
+
+bool PackagePrefetcher::WarmFile(int index, quint8 *buffer, qint64 &time)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QFile file(files.at(index));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+#if defined(__linux__)
+    posix_fadvise(file.handle(), 0, 0, POSIX_FADV_WILLNEED);
+#endif
+    // Reading through whole file is what makes it resident on all systems,
+    // stop as soon as package is already opened by the worker
+    while (file.read(reinterpret_cast<char *>(buffer), readChunkSize) > 0)
+    {
+        if (quit || current >= index)
+            return false;
+    }
+    time = timer.elapsed();
+    return true;
+}
+
+int PackagePrefetcher::DefaultDepth()
+{
+    return prefetchDefaultDepth;
+}
+
+void PackagePrefetcher::SetDefaultDepth(int prefetchDepth)
+{
+    prefetchDefaultDepth = qMax(prefetchDepth, 0);
+}
+
+void PackagePrefetcher::ResetStageStats()
+{
+    stagePackages = 0;
+    stageHits = 0;
+    stageOverlapTime = 0;
+}
+
+void PackagePrefetcher::ReportStageStats()
+{
+    int packages = stagePackages;
+    if (packages == 0)
+        return;
+
+    if (g_ipc)
+    {
+        ConsoleWrite(QString("[IPC]STAGE_PREFETCH %1 %2 %3").arg(stageHits.load())
+                     .arg(packages).arg(stageOverlapTime.load()));
+        ConsoleSync();
+    }
+    else
+    {
+        PDEBUG(QString("Prefetch: ") + QString::number(stageHits.load()) + " of " +
+               QString::number(packages) + " packages ready ahead, " +
+               QString::number(stageOverlapTime.load()) + " ms of reading overlapped.\n");
+    }
+}
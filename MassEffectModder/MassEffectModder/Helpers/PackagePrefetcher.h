@@ -0,0 +1,62 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2017-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef PACKAGE_PREFETCHER_H
+#define PACKAGE_PREFETCHER_H
+
+#include <Types/MemTypes.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+// Warms OS cache for next packages of list while current one is processed
+class PackagePrefetcher
+{
+private:
+    enum { readChunkSize = 0x400000 };
+
+    QStringList files;
+    QVector<bool> ready;
+    QVector<qint64> readTime;
+    int depth;
+    std::atomic<int> current { -1 };
+    std::atomic<bool> quit { false };
+    int next = 1;
+    std::mutex lock;
+    std::condition_variable wakeUp;
+    std::thread worker;
+
+    void Worker();
+    bool WarmFile(int index, quint8 *buffer, qint64 &time);
+
+public:
+    PackagePrefetcher(const QStringList &filesList, int prefetchDepth = DefaultDepth());
+    ~PackagePrefetcher();
+    void Advance(int index);
+
+    static int DefaultDepth();
+    static void SetDefaultDepth(int prefetchDepth);
+    static void ResetStageStats();
+    static void ReportStageStats();
+};
+
+#endif
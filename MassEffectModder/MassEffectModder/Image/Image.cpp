@@ -26,6 +26,9 @@
 #include <Helpers/Logs.h>
 #include <Wrappers.h>
 
+int Image::pngCompressionLevel = -1;
+int Image::pngFilterMode = PngFilterAdaptive;
+
 Image::Image(int width, int height)
 {
     ByteBuffer pixels(width * height * 4 * sizeof(float));
@@ -166,6 +169,37 @@ Image::Image(const ByteBuffer &data, const QString &extension)
     CRASH();
 }
 
+// DDS mipmaps reference 'data' directly and keep 'dataOwner' alive instead of
+// copying, data is copied only when a mipmap gets modified.
+Image::Image(const ByteBuffer &data, const std::shared_ptr<const void> &dataOwner, ImageFormat format)
+{
+    switch (format)
+    {
+        case ImageFormat::DDS:
+        {
+            MemoryStream header(data, 0, qMin(data.size(), (qint64)DDS_MAX_HEADER_SIZE));
+            LoadImageDDS(header, sourceIs8Bits, dataOwner, &data);
+            return;
+        }
+        case ImageFormat::BMP:
+        case ImageFormat::TGA:
+        {
+            MemoryStream stream(data);
+            LoadImageFromStream(stream, format, sourceIs8Bits);
+            return;
+        }
+        case ImageFormat::PNG:
+        {
+            LoadImageFromBuffer(data, format, sourceIs8Bits);
+            return;
+        }
+        case ImageFormat::UnknownImageFormat:
+            return;
+    }
+
+    CRASH();
+}
+
 Image::Image(QList<MipMap *> &mipmaps, PixelFormat pixelFmt)
 {
     mipMaps = std::move(mipmaps);
@@ -187,7 +221,7 @@ void Image::generateGradient()
         CRASH();
 
     auto mipmap = mipMaps.first();
-    float *ptr = mipmap->getRefData().ptrAsFloat();
+    float *ptr = mipmap->getWritableData().ptrAsFloat();
     int offset = 0;
     for (int h = 0; h < mipmap->getHeight(); h++)
     {
@@ -278,16 +312,18 @@ void Image::LoadImageFromBuffer(ByteBuffer data, ImageFormat format, bool &sourc
     mipMaps.clear();
     source8Bits = true;
 
-    float *imageBuffer;
+    quint8 *imageBuffer;
     quint32 imageSize, imageWidth, imageHeight;
+    int bits, sourceBits;
     if (format == ImageFormat::PNG)
     {
-        if (PngRead(data.ptr(), data.size(), &imageBuffer,
-                    &imageSize, &imageWidth, &imageHeight, source8Bits) != 0)
+        if (PngReadBytes(data.ptr(), data.size(), &imageBuffer,
+                         &imageSize, &imageWidth, &imageHeight, &bits, &sourceBits) != 0)
         {
             PERROR("Failed load PNG.\n");
             return;
         }
+        source8Bits = sourceBits == 8;
     }
     else
         CRASH();
@@ -295,14 +331,28 @@ void Image::LoadImageFromBuffer(ByteBuffer data, ImageFormat format, bool &sourc
     if (!checkPowerOfTwo(imageWidth) ||
         !checkPowerOfTwo(imageHeight))
     {
+        delete[] imageBuffer;
         PERROR("PNG image dimensions are not power of two.\n");
         return;
     }
 
-    ByteBuffer pixels((quint8 *)imageBuffer, imageSize);
+    // Decode straight into the mipmap, no intermediate float image
+    auto mipmap = new MipMap(imageWidth, imageHeight, PixelFormat::Internal);
+    float *dst = mipmap->getWritableData().ptrAsFloat();
+    qint64 count = static_cast<qint64>(imageWidth) * imageHeight * 4;
+    if (bits == 16)
+    {
+        auto *src = reinterpret_cast<const quint16 *>(imageBuffer);
+        for (qint64 i = 0; i < count; i++)
+            dst[i] = src[i] / 65535.0f;
+    }
+    else
+    {
+        for (qint64 i = 0; i < count; i++)
+            dst[i] = imageBuffer[i] / 255.0f;
+    }
     delete[] imageBuffer;
-    mipMaps.push_back(new MipMap(pixels, imageWidth, imageHeight, PixelFormat::Internal));
-    pixels.Free();
+    mipMaps.push_back(mipmap);
     pixelFormat = PixelFormat::Internal;
 }
 
@@ -422,6 +472,9 @@ ByteBuffer Image::convertRawToInternal(const ByteBuffer src, int w, int h, Pixel
 
 ByteBuffer Image::convertRawToRGB(const ByteBuffer src, int w, int h, PixelFormat format)
 {
+    if (canDecompressMipmapToBytes(format, w, h))
+        return decompressMipmapToBytes(format, src, w, h, ByteLayout::RGB, false);
+
     auto dataRGBA = convertRawToInternal(src, w, h, format);
     auto dataRGB = InternalToRGB(dataRGBA, w, h);
     dataRGBA.Free();
@@ -430,6 +483,9 @@ ByteBuffer Image::convertRawToRGB(const ByteBuffer src, int w, int h, PixelForma
 
 ByteBuffer Image::convertRawToARGB(const ByteBuffer src, int w, int h, PixelFormat format)
 {
+    if (canDecompressMipmapToBytes(format, w, h))
+        return decompressMipmapToBytes(format, src, w, h, ByteLayout::ARGB, false);
+
     auto dataRGBA = convertRawToInternal(src, w, h, format);
     auto dataARGB = InternalToARGB(dataRGBA, w, h);
     dataRGBA.Free();
@@ -438,6 +494,9 @@ ByteBuffer Image::convertRawToARGB(const ByteBuffer src, int w, int h, PixelForm
 
 ByteBuffer Image::convertRawToRGBA(const ByteBuffer src, int w, int h, PixelFormat format)
 {
+    if (canDecompressMipmapToBytes(format, w, h))
+        return decompressMipmapToBytes(format, src, w, h, ByteLayout::RGBA, false);
+
     auto dataRGBA = convertRawToInternal(src, w, h, format);
     auto dataARGB = InternalToRGBA(dataRGBA, w, h);
     dataRGBA.Free();
@@ -462,6 +521,9 @@ ByteBuffer Image::convertRawToR16G16B16A16(const ByteBuffer src, int w, int h, P
 
 ByteBuffer Image::convertRawToBGR(const ByteBuffer src, int w, int h, PixelFormat format, bool clearAlpha)
 {
+    if (canDecompressMipmapToBytes(format, w, h))
+        return decompressMipmapToBytes(format, src, w, h, ByteLayout::BGR, clearAlpha);
+
     auto dataARGB = convertRawToInternal(src, w, h, format, clearAlpha);
     auto dataBGR = InternalToBGR(dataARGB, w, h);
     dataARGB.Free();
@@ -470,6 +532,9 @@ ByteBuffer Image::convertRawToBGR(const ByteBuffer src, int w, int h, PixelForma
 
 ByteBuffer Image::convertRawToAlphaGreyscale(const ByteBuffer src, int w, int h, PixelFormat format, bool clearAlpha)
 {
+    if (canDecompressMipmapToBytes(format, w, h))
+        return decompressMipmapToBytes(format, src, w, h, ByteLayout::AlphaGreyscale, clearAlpha);
+
     auto dataARGB = convertRawToInternal(src, w, h, format, clearAlpha);
     auto dataRGB = InternalToAlphaGreyscale(dataARGB, w, h);
     dataARGB.Free();
@@ -838,57 +903,94 @@ bool Image::InternalDetectAlphaData(const ByteBuffer src, int w, int h)
     return false;
 }
 
-ByteBuffer Image::downscaleInternal(const ByteBuffer src, int w, int h)
+bool Image::RawDetectAlphaData(const ByteBuffer src, int w, int h, PixelFormat format)
 {
-    if (w == 1 && h == 1)
-        CRASH_MSG("1x1 can not be downscaled");
-
-    float *srcPtr = src.ptrAsFloat();
-
-    if (w == 1 || h == 1)
+    switch (format)
     {
-        ByteBuffer tmpData(w * h * 2 * sizeof(float));
-        float *ptr = tmpData.ptrAsFloat();
-        for (int srcPos = 0, dstPos = 0; dstPos < w * h * 2; srcPos += 8)
+        case PixelFormat::DXT5:
+        case PixelFormat::BC7:
+            // Too small to decompress, converted to fully transparent image
+            if (w < 4 || h < 4)
+                return true;
+            if (format == PixelFormat::DXT5)
+                return detectAlphaDataDXT5(src, w, h);
+            return detectAlphaDataBC7(src, w, h);
+        case PixelFormat::ARGB:
+        case PixelFormat::RGBA:
         {
-            ptr[dstPos++] = (srcPtr[srcPos + 0] + srcPtr[srcPos + 4 + 0]) / 2.0f;
-            ptr[dstPos++] = (srcPtr[srcPos + 1] + srcPtr[srcPos + 4 + 1]) / 2.0f;
-            ptr[dstPos++] = (srcPtr[srcPos + 2] + srcPtr[srcPos + 4 + 2]) / 2.0f;
-            ptr[dstPos++] = (srcPtr[srcPos + 3] + srcPtr[srcPos + 4 + 3]) / 2.0f;
+            quint8 *srcPtr = src.ptr();
+            for (int i = 0; i < w * h; i++)
+            {
+                if (srcPtr[4 * i + 3] != 255)
+                    return true;
+            }
+            return false;
         }
-        return tmpData;
-    }
-
-    ByteBuffer tmpData(w * h * sizeof(float));
-    float *ptr = tmpData.ptrAsFloat();
-    int pitch = w * 4;
-    for (int srcPos = 0, dstPos = 0; dstPos < w * h; srcPos += pitch)
-    {
-        for (int x = 0; x < (w / 2); x++, srcPos += 8)
+        case PixelFormat::R10G10B10A2:
+        {
+            auto *srcPtr = (quint32 *)src.ptr();
+            for (int i = 0; i < w * h; i++)
+            {
+                if ((srcPtr[i] >> 30) != 3)
+                    return true;
+            }
+            return false;
+        }
+        case PixelFormat::R16G16B16A16:
+        {
+            auto *srcPtr = (quint64 *)src.ptr();
+            for (int i = 0; i < w * h; i++)
+            {
+                quint64 a = srcPtr[i] >> 48;
+                if (ROUND_FLOAT_TO_BYTE(CONVERT_UINT16_TO_FLOAT(a)) != 255)
+                    return true;
+            }
+            return false;
+        }
+        case PixelFormat::Internal:
+            return InternalDetectAlphaData(src, w, h);
+        default:
         {
-            ptr[dstPos++] = (srcPtr[srcPos + 0] + srcPtr[srcPos + 4 + 0] + srcPtr[srcPos + pitch + 0] + srcPtr[srcPos + pitch + 4 + 0]) / 4.0f;
-            ptr[dstPos++] = (srcPtr[srcPos + 1] + srcPtr[srcPos + 4 + 1] + srcPtr[srcPos + pitch + 1] + srcPtr[srcPos + pitch + 4 + 1]) / 4.0f;
-            ptr[dstPos++] = (srcPtr[srcPos + 2] + srcPtr[srcPos + 4 + 2] + srcPtr[srcPos + pitch + 2] + srcPtr[srcPos + pitch + 4 + 2]) / 4.0f;
-            ptr[dstPos++] = (srcPtr[srcPos + 3] + srcPtr[srcPos + 4 + 3] + srcPtr[srcPos + pitch + 3] + srcPtr[srcPos + pitch + 4 + 3]) / 4.0f;
+            auto pixels = convertRawToInternal(src, w, h, format);
+            bool hasAlpha = InternalDetectAlphaData(pixels, w, h);
+            pixels.Free();
+            return hasAlpha;
         }
     }
-    return tmpData;
 }
 
 void Image::saveToPng(const ByteBuffer src, int w, int h, PixelFormat format, const QString &filename, bool storeAs8bits, bool clearAlpha)
 {
-    auto dataARGB = convertRawToInternal(src, w, h, format, clearAlpha);
+    ByteBuffer pixels;
+    if (storeAs8bits && canDecompressMipmapToBytes(format, w, h))
+    {
+        pixels = decompressMipmapToBytes(format, src, w, h, ByteLayout::RGBA, clearAlpha);
+    }
+    else
+    {
+        auto dataRGBA = convertRawToInternal(src, w, h, format, clearAlpha);
+        if (storeAs8bits)
+            pixels = InternalToRGBA(dataRGBA, w, h);
+        else
+            pixels = InternalToR16G16B16A16(dataRGBA, w, h);
+        dataRGBA.Free();
+    }
+
+    // Texture exports already run in parallel, strips are compressed by threads only for single image
+    int numThreads = omp_in_parallel() ? 1 : omp_get_max_threads();
     quint8 *buffer;
     quint32 bufferSize;
-    if (PngWrite(dataARGB.ptrAsFloat(), &buffer, &bufferSize, w, h, storeAs8bits) != 0)
+    if (PngWriteBytes(pixels.ptr(), &buffer, &bufferSize, w, h, storeAs8bits ? 8 : 16,
+                      pngCompressionLevel, pngFilterMode, numThreads) != 0)
     {
         PERROR("Failed to save to PNG.\n");
+        pixels.Free();
         return;
     }
+    pixels.Free();
     FileStream fs = FileStream(filename, FileMode::Create, FileAccess::WriteOnly);
     fs.WriteFromBuffer(buffer, bufferSize);
     free(buffer);
-    dataARGB.Free();
 }
 
 ByteBuffer Image::convertToFormat(PixelFormat srcFormat, const ByteBuffer src, int w, int h, PixelFormat dstFormat,
@@ -1061,6 +1163,19 @@ void Image::correctMips(PixelFormat dstFormat, bool dxt1HasAlpha, float dxt1Thre
     tempData.Free();
 }
 
+// Maps the whole file read-only, the mapping lives as long as the returned owner
+std::shared_ptr<const void> Image::mapFile(const QString &fileName, ByteBuffer &view)
+{
+    auto file = std::make_shared<QFile>(fileName);
+    if (!file->open(QIODevice::ReadOnly) || file->size() == 0)
+        return nullptr;
+    uchar *ptr = file->map(0, file->size());
+    if (ptr == nullptr)
+        return nullptr;
+    view = ByteBuffer::view(ptr, file->size());
+    return file;
+}
+
 PixelFormat Image::getPixelFormatType(const QString &format)
 {
     if (format == "PF_DXT1")
@@ -27,9 +27,12 @@
 #include <Helpers/Stream.h>
 #include <Helpers/ByteBuffer.h>
 
+class BC7BlockDecoder;
+
 #define DDS_TAG                  0x20534444
 #define DDS_HEADER_dwSize        124
 #define DDS_PIXELFORMAT_dwSize   32
+#define DDS_MAX_HEADER_SIZE      (4 + DDS_HEADER_dwSize + 20) // tag, header, DX10 header
 
 #define DDPF_ALPHAPIXELS         0x1
 #define DDPF_FOURCC              0x4
@@ -217,8 +220,50 @@ class Image
         uint Amask;
     };
 
+    enum class ByteLayout
+    {
+        RGBA, ARGB, RGB, BGR, AlphaGreyscale
+    };
+
+public:
+
+    enum class DxtQuality
+    {
+        Normal, Fast
+    };
+
+    enum class Bc7Profile
+    {
+        VeryFast, Fast, Normal, Slow
+    };
+
+    enum class MipFilter
+    {
+        Box, Kaiser, Lanczos
+    };
+
+    struct DDSHeader
+    {
+        uint flags;
+        int width;
+        int height;
+        int mipsCount;
+        PixelFormat pixelFormat;
+        bool DX10Type;
+        bool source8Bits;
+        DDS_PF ddsPixelFormat;
+        qint64 dataOffset;
+        qint64 dataSize;
+    };
+
 private:
 
+    static DxtQuality dxtQuality;
+    static Bc7Profile bc7Profile;
+    static MipFilter mipFilter;
+    static bool blockMemo;
+    static int pngCompressionLevel;
+    static int pngFilterMode;
     QList<MipMap *> mipMaps;
     PixelFormat pixelFormat = PixelFormat::UnknownPixelFormat;
     DDS_PF ddsPixelFormat{};
@@ -230,7 +275,8 @@ private:
     ImageFormat DetectImageByExtension(const QString &extension);
     void LoadImageFromStream(Stream &stream, ImageFormat format, bool &source8Bits);
     void LoadImageFromBuffer(ByteBuffer data, ImageFormat format, bool &source8Bits);
-    void LoadImageDDS(Stream &stream, bool &source8Bits);
+    void LoadImageDDS(Stream &stream, bool &source8Bits,
+                      const std::shared_ptr<const void> &viewOwner = nullptr, const ByteBuffer *viewData = nullptr);
     void LoadImageTGA(Stream &stream);
     void LoadImageBMP(Stream &stream);
     static void clearAlphaFromInternal(ByteBuffer data, int w, int h);
@@ -239,21 +285,15 @@ private:
     static ByteBuffer RGBAtoInternal(const ByteBuffer src, int w, int h);
     static ByteBuffer R10G10B10A2toInternal(const ByteBuffer src, int w, int h);
     static ByteBuffer R16G16B16A16toInternal(const ByteBuffer src, int w, int h);
-    static ByteBuffer InternalToARGB(const ByteBuffer src, int w, int h);
-    static ByteBuffer InternalToRGB(const ByteBuffer src, int w, int h);
-    static ByteBuffer InternalToRGBA(const ByteBuffer src, int w, int h);
     static ByteBuffer InternalToR10G10B10A2(const ByteBuffer src, int w, int h);
     static ByteBuffer InternalToR10G10B10A2ClearAlpha(const ByteBuffer src, int w, int h);
     static ByteBuffer InternalToR16G16B16A16(const ByteBuffer src, int w, int h);
-    static ByteBuffer InternalToBGR(const ByteBuffer src, int w, int h);
     static ByteBuffer V8U8ToInternal(const ByteBuffer src, int w, int h);
     static ByteBuffer InternalToV8U8(const ByteBuffer src, int w, int h);
     static ByteBuffer G8ToInternal(const ByteBuffer src, int w, int h);
     static ByteBuffer InternalToG8(const ByteBuffer src, int w, int h);
     static ByteBuffer InternalToRGBE(const ByteBuffer src, int w, int h);
     static ByteBuffer RGBEToInternal(const ByteBuffer src, int w, int h);
-    static ByteBuffer InternalToAlphaGreyscale(const ByteBuffer src, int w, int h);
-    static ByteBuffer downscaleInternal(const ByteBuffer src, int w, int h);
     static ByteBuffer convertToFormat(PixelFormat srcFormat, const ByteBuffer src, int w, int h,
                                       PixelFormat dstFormat, bool dxt1HasAlpha, float dxt1Threshold, float bc7quality);
 
@@ -262,6 +302,7 @@ public:
     QList<MipMap *> &getMipMaps() { return mipMaps; }
     PixelFormat getPixelFormat() { return pixelFormat; }
     bool isSource8Bits() { return sourceIs8Bits; }
+    static bool ReadDDSHeader(Stream &stream, DDSHeader &header);
 
     Image(int width, int height);
     Image(const QString &fileName, ImageFormat format = ImageFormat::UnknownImageFormat);
@@ -269,6 +310,7 @@ public:
     Image(Stream &stream, const QString &extension);
     Image(const ByteBuffer &data, ImageFormat format);
     Image(const ByteBuffer &data, const QString &extension);
+    Image(const ByteBuffer &data, const std::shared_ptr<const void> &dataOwner, ImageFormat format);
     Image(QList<MipMap *> &mipmaps, PixelFormat pixelFmt);
     ~Image();
     void generateGradient();
@@ -283,12 +325,35 @@ public:
     static ByteBuffer convertRawToR16G16B16A16(const ByteBuffer src, int w, int h, PixelFormat format);
     static ByteBuffer convertRawToBGR(const ByteBuffer src, int w, int h, PixelFormat format, bool clearAlpha = false);
     static ByteBuffer convertRawToAlphaGreyscale(const ByteBuffer src, int w, int h, PixelFormat format, bool clearAlpha = false);
+    static ByteBuffer InternalToARGB(const ByteBuffer src, int w, int h);
+    static ByteBuffer InternalToRGB(const ByteBuffer src, int w, int h);
+    static ByteBuffer InternalToRGBA(const ByteBuffer src, int w, int h);
+    static ByteBuffer InternalToBGR(const ByteBuffer src, int w, int h);
+    static ByteBuffer InternalToAlphaGreyscale(const ByteBuffer src, int w, int h);
+    static ByteBuffer downscaleInternal(const ByteBuffer src, int w, int h);
+    static ByteBuffer compressMipmap(PixelFormat dstFormat, const ByteBuffer src, int w, int h,
+                                     bool useDXT1Alpha, quint8 DXT1Threshold, float bc7quality);
     static bool InternalDetectAlphaData(const ByteBuffer src, int w, int h);
+    static bool RawDetectAlphaData(const ByteBuffer src, int w, int h, PixelFormat format);
     static void saveToPng(const ByteBuffer src, int w, int h, PixelFormat format, const QString &filename, bool storeAs8bits, bool clearAlpha = false);
     void correctMips(PixelFormat dstFormat, bool dxt1HasAlpha, float dxt1Threshold, float bc7quality);
+    static std::shared_ptr<const void> mapFile(const QString &fileName, ByteBuffer &view);
     static PixelFormat getPixelFormatType(const QString &format);
     static QString getEngineFormatType(PixelFormat format);
     void removeMipByIndex(int n);
+    static void SetDxtQuality(DxtQuality quality) { dxtQuality = quality; }
+    static DxtQuality GetDxtQuality() { return dxtQuality; }
+    static void SetBc7Profile(Bc7Profile profile) { bc7Profile = profile; }
+    static Bc7Profile GetBc7Profile() { return bc7Profile; }
+    static void SetMipFilter(MipFilter filter) { mipFilter = filter; }
+    static MipFilter GetMipFilter() { return mipFilter; }
+    static void SetBlockMemo(bool enable) { blockMemo = enable; }
+    static bool GetBlockMemo() { return blockMemo; }
+    static void SetPngOptions(int compressionLevel, int filterMode)
+    {
+        pngCompressionLevel = compressionLevel;
+        pngFilterMode = filterMode;
+    }
     static bool checkPowerOfTwo(int n);
     static int returnPowerOfTwo(int n);
 
@@ -298,8 +363,14 @@ private:
     static DDS_PF getDDSPixelFormat(PixelFormat format);
     static void readBlockInternalToDxt(float blockARGB[BLOCK_SIZE_4X4X4], const float *srcARGB,
                                  int srcW, int blockX, int blockY);
-    static void writeBlockDxtToInternal(const float blockARGB[BLOCK_SIZE_4X4X4], float *dstARGB,
-                                  int dstW, int blockX, int blockY);
+    static void readBlockInternalToBytes(quint8 block[BLOCK_SIZE_4X4X4], const float *src,
+                                         int srcW, int blockX, int blockY);
+    static void convertBlockDxtToInternal(float dst[BLOCK_SIZE_4X4X4], const float blockARGB[BLOCK_SIZE_4X4X4]);
+    static void writeBlockToInternal(const float block[BLOCK_SIZE_4X4X4], float *dst,
+                                     int dstW, int blockX, int blockY);
+    static void decompressBlockToInternal(PixelFormat srcFormat, const quint8 *src, int srcW,
+                                          int blockX, int blockY, BC7BlockDecoder *bc7Decoder,
+                                          float block[BLOCK_SIZE_4X4X4]);
 
     static void readBlockDxtBpp4(quint8 *dst, const quint8 *src, int srcW, int blockX, int blockY);
     static void writeBlockDxtBpp4(quint8 *src, quint8 *dst, int dstW, int blockX, int blockY);
@@ -307,8 +378,8 @@ private:
     static void readBlockDxtBpp8(quint8 *dst, const quint8 *src, int srcW, int blockX, int blockY);
     static void writeBlockDxtBpp8(quint8 *src, quint8 *dst, int dstW, int blockX, int blockY);
 
-    static void convertBlock4X4X4DoubleToFloat(float dst[BLOCK_SIZE_4X4X4], double src[16][4]);
-    static void convertBlock4X4X4FloatToDouble(double dst[BLOCK_SIZE_4X4][4], const float src[BLOCK_SIZE_4X4X4]);
+    static void convertBlock4X4X4FromBc7(float dst[BLOCK_SIZE_4X4X4], const float src[BLOCK_SIZE_4X4][4]);
+    static void convertBlock4X4X4ToBc7(float dst[BLOCK_SIZE_4X4][4], const float src[BLOCK_SIZE_4X4X4]);
 
 
     static void readBlockInternalToAti2(float blockDstX[BLOCK_SIZE_4X4BPP8],
@@ -317,19 +388,42 @@ private:
     static void writeBlock4X4ATI2(quint8 *blockSrcX, quint8 *blockSrcY,
                                   quint8 *dst, int dstW, int blockX, int blockY);
 
-    static void writeBlockAti2ToInternal(const float blockR[BLOCK_SIZE_4X4BPP8],
-                                         const float blockG[BLOCK_SIZE_4X4BPP8],
-                                         float *dstARGB, int srcW, int blockX, int blockY);
-
-    static ByteBuffer compressMipmap(PixelFormat dstFormat, const ByteBuffer src, int w, int h,
-                                     bool useDXT1Alpha, quint8 DXT1Threshold, float bc7quality);
     static ByteBuffer decompressMipmap(PixelFormat srcFormat, const ByteBuffer src, int w, int h);
+    static bool canDecompressMipmapToBytes(PixelFormat srcFormat, int w, int h);
+    static void writeBlockInternalToBytes(const float blockARGB[BLOCK_SIZE_4X4X4], quint8 *dst, int dstW,
+                                          int blockX, int blockY, ByteLayout layout, bool clearAlpha);
+    static ByteBuffer decompressMipmapToBytes(PixelFormat srcFormat, const ByteBuffer src, int w, int h,
+                                              ByteLayout layout, bool clearAlpha);
+    static bool detectAlphaDataDXT5(const ByteBuffer src, int w, int h);
+    static bool detectAlphaDataBC7(const ByteBuffer src, int w, int h);
 
 public:
 
     bool checkDDSHaveAllMipmaps();
     void StoreImageToDDS(Stream &stream, PixelFormat format = PixelFormat::UnknownPixelFormat);
     ByteBuffer StoreImageToDDS();
+    static bool StoreDDSHeader(Stream &stream, int width, int height, int mipsCount, int dataSize, PixelFormat format);
+};
+
+// Writes DDS mips one by one without keeping them in memory,
+// header is written as placeholder first and completed by Finish()
+class DDSStreamWriter
+{
+private:
+
+    Stream &stream;
+    PixelFormat pixelFormat;
+    int width = 0;
+    int height = 0;
+    int mipsCount = 0;
+    int dataSize = 0;
+
+public:
+
+    DDSStreamWriter(Stream &output, PixelFormat format);
+    void WriteMipMap(const ByteBuffer &data, int w, int h);
+    void Finish();
+    int getMipsCount() { return mipsCount; }
 };
 
 #endif
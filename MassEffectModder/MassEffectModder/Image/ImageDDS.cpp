@@ -19,216 +19,741 @@
  *
  */
 
+#include <array>
+
+#if defined(__aarch64__)
+#include "../sse2neon/sse2neon.h"
+#else
+#include <emmintrin.h>
+#endif
+
 #include <Image/Image.h>
 #include <Helpers/MemoryStream.h>
 #include <Helpers/MiscHelpers.h>
 #include <Helpers/Logs.h>
 #include <Wrappers.h>
 
-void Image::LoadImageDDS(Stream &stream, bool &source8Bits)
+Image::DxtQuality Image::dxtQuality = Image::DxtQuality::Normal;
+Image::Bc7Profile Image::bc7Profile = Image::Bc7Profile::Normal;
+bool Image::blockMemo = true;
+
+namespace {
+
+// Fast DXT encoders: colour endpoints from the inset bounding box of the block
+// oriented along the dominant diagonal, alpha endpoints from the value range.
+// Quality is lower than the cluster fit in Libs/dxtc, but no search is done.
+// The group encoders run FastBlockGroup blocks at once, one block per 16-bit
+// SSE2 lane, and give the same output as the single block encoder.
+
+const int FastBlockGroup = 8;
+
+inline quint32 packColor565(int r, int g, int b)
+{
+    return ((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255);
+}
+
+inline void unpackColor565(quint32 c, int rgb[3])
+{
+    int r = (c >> 11) & 0x1f;
+    int g = (c >> 5) & 0x3f;
+    int b = c & 0x1f;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+void compressColorBlockFast(const quint8 block[BLOCK_SIZE_4X4X4], quint32 compressedBlock[2],
+                            bool useDXT1Alpha, quint8 DXT1Threshold)
+{
+    bool transparent[BLOCK_SIZE_4X4];
+    bool threeColors = false;
+    int minColor[3] = { 255, 255, 255 };
+    int maxColor[3] = { 0, 0, 0 };
+    int sum[3] = { 0, 0, 0 };
+    int count = 0;
+    for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+    {
+        transparent[i] = useDXT1Alpha && block[i * 4 + 3] < DXT1Threshold;
+        if (transparent[i])
+        {
+            threeColors = true;
+            continue;
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            int v = block[i * 4 + c];
+            minColor[c] = MIN(minColor[c], v);
+            maxColor[c] = MAX(maxColor[c], v);
+            sum[c] += v;
+        }
+        count++;
+    }
+
+    if (count == 0)
+    {
+        compressedBlock[0] = 0;
+        compressedBlock[1] = 0xffffffff;
+        return;
+    }
+
+    // Pick the box diagonal matching the red/blue correlation with green
+    int covRG = 0, covBG = 0;
+    for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+    {
+        if (transparent[i])
+            continue;
+        int g = block[i * 4 + 1] * count - sum[1];
+        covRG += (block[i * 4 + 0] * count - sum[0]) * g;
+        covBG += (block[i * 4 + 2] * count - sum[2]) * g;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        int inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] += inset;
+        maxColor[c] -= inset;
+    }
+    if (covRG < 0)
+        std::swap(minColor[0], maxColor[0]);
+    if (covBG < 0)
+        std::swap(minColor[2], maxColor[2]);
+
+    quint32 c0 = packColor565(maxColor[0], maxColor[1], maxColor[2]);
+    quint32 c1 = packColor565(minColor[0], minColor[1], minColor[2]);
+    if ((threeColors && c0 > c1) || (!threeColors && c0 < c1))
+        std::swap(c0, c1);
+
+    int palette[4][3];
+    unpackColor565(c0, palette[0]);
+    unpackColor565(c1, palette[1]);
+    int numColors;
+    if (threeColors)
+    {
+        for (int c = 0; c < 3; c++)
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+        numColors = 3;
+    }
+    else
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        numColors = c0 == c1 ? 1 : 4;
+    }
+
+    quint32 indices = 0;
+    for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+    {
+        quint32 index = 3;
+        if (!transparent[i])
+        {
+            int bestError = INT_MAX;
+            for (int n = 0; n < numColors; n++)
+            {
+                int dr = block[i * 4 + 0] - palette[n][0];
+                int dg = block[i * 4 + 1] - palette[n][1];
+                int db = block[i * 4 + 2] - palette[n][2];
+                int error = dr * dr + dg * dg + db * db;
+                if (error < bestError)
+                {
+                    bestError = error;
+                    index = n;
+                }
+            }
+        }
+        indices |= index << (2 * i);
+    }
+
+    compressedBlock[0] = c0 | (c1 << 16);
+    compressedBlock[1] = indices;
+}
+
+inline __m128i selectSi128(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Exact x / 255 for 0 <= x < 16384 and x / 3 for 0 <= x < 766
+inline __m128i divideBy255Epi16(__m128i x)
+{
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+inline __m128i divideBy3Epi16(__m128i x)
+{
+    return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(static_cast<short>(0xAAAB))), 1);
+}
+
+inline __m128i packColor565Epi16(const __m128i color[3])
+{
+    __m128i r = divideBy255Epi16(_mm_add_epi16(_mm_mullo_epi16(color[0], _mm_set1_epi16(31)), _mm_set1_epi16(127)));
+    __m128i g = divideBy255Epi16(_mm_add_epi16(_mm_mullo_epi16(color[1], _mm_set1_epi16(63)), _mm_set1_epi16(127)));
+    __m128i b = divideBy255Epi16(_mm_add_epi16(_mm_mullo_epi16(color[2], _mm_set1_epi16(31)), _mm_set1_epi16(127)));
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+}
+
+inline void unpackColor565Epi16(__m128i c, __m128i rgb[3])
+{
+    __m128i r = _mm_srli_epi16(c, 11);
+    __m128i g = _mm_and_si128(_mm_srli_epi16(c, 5), _mm_set1_epi16(0x3f));
+    __m128i b = _mm_and_si128(c, _mm_set1_epi16(0x1f));
+    rgb[0] = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+    rgb[1] = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+    rgb[2] = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+}
+
+// Opaque blocks only, DXT1 punch-through alpha uses compressColorBlockFast()
+void compressColorBlocksFast(const quint8 blocks[FastBlockGroup][BLOCK_SIZE_4X4X4],
+                             quint32 compressedBlocks[FastBlockGroup][2])
+{
+    alignas(16) qint16 texels[BLOCK_SIZE_4X4][3][FastBlockGroup];
+    for (int b = 0; b < FastBlockGroup; b++)
+    {
+        for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+        {
+            for (int c = 0; c < 3; c++)
+                texels[i][c][b] = blocks[b][i * 4 + c];
+        }
+    }
+
+    __m128i minColor[3], maxColor[3], sum[3];
+    for (int c = 0; c < 3; c++)
+    {
+        minColor[c] = maxColor[c] = sum[c] = _mm_load_si128(reinterpret_cast<const __m128i *>(texels[0][c]));
+        for (int i = 1; i < BLOCK_SIZE_4X4; i++)
+        {
+            __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(texels[i][c]));
+            minColor[c] = _mm_min_epi16(minColor[c], v);
+            maxColor[c] = _mm_max_epi16(maxColor[c], v);
+            sum[c] = _mm_add_epi16(sum[c], v);
+        }
+    }
+
+    // Products of the centred values need 32 bits, lanes 0-3 and 4-7 are kept apart
+    __m128i covRG[2] = { _mm_setzero_si128(), _mm_setzero_si128() };
+    __m128i covBG[2] = { _mm_setzero_si128(), _mm_setzero_si128() };
+    for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+    {
+        __m128i d[3];
+        for (int c = 0; c < 3; c++)
+        {
+            __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(texels[i][c]));
+            d[c] = _mm_sub_epi16(_mm_slli_epi16(v, 4), sum[c]);
+        }
+        __m128i lo = _mm_mullo_epi16(d[0], d[1]);
+        __m128i hi = _mm_mulhi_epi16(d[0], d[1]);
+        covRG[0] = _mm_add_epi32(covRG[0], _mm_unpacklo_epi16(lo, hi));
+        covRG[1] = _mm_add_epi32(covRG[1], _mm_unpackhi_epi16(lo, hi));
+        lo = _mm_mullo_epi16(d[2], d[1]);
+        hi = _mm_mulhi_epi16(d[2], d[1]);
+        covBG[0] = _mm_add_epi32(covBG[0], _mm_unpacklo_epi16(lo, hi));
+        covBG[1] = _mm_add_epi32(covBG[1], _mm_unpackhi_epi16(lo, hi));
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        __m128i inset = _mm_srli_epi16(_mm_sub_epi16(maxColor[c], minColor[c]), 4);
+        minColor[c] = _mm_add_epi16(minColor[c], inset);
+        maxColor[c] = _mm_sub_epi16(maxColor[c], inset);
+    }
+    __m128i swapMask[2] =
+    {
+        _mm_cmplt_epi16(_mm_packs_epi32(covRG[0], covRG[1]), _mm_setzero_si128()),
+        _mm_cmplt_epi16(_mm_packs_epi32(covBG[0], covBG[1]), _mm_setzero_si128()),
+    };
+    for (int n = 0; n < 2; n++)
+    {
+        int c = n == 0 ? 0 : 2;
+        __m128i newMin = selectSi128(swapMask[n], maxColor[c], minColor[c]);
+        maxColor[c] = selectSi128(swapMask[n], minColor[c], maxColor[c]);
+        minColor[c] = newMin;
+    }
+
+    __m128i c0 = packColor565Epi16(maxColor);
+    __m128i c1 = packColor565Epi16(minColor);
+    const __m128i signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+    __m128i lessMask = _mm_cmplt_epi16(_mm_xor_si128(c0, signBit), _mm_xor_si128(c1, signBit));
+    __m128i newC0 = selectSi128(lessMask, c1, c0);
+    c1 = selectSi128(lessMask, c0, c1);
+    c0 = newC0;
+
+    // Equal endpoints give four equal entries, so index 0 wins like in the single block encoder
+    __m128i palette[4][3];
+    unpackColor565Epi16(c0, palette[0]);
+    unpackColor565Epi16(c1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+        __m128i p0 = palette[0][c], p1 = palette[1][c];
+        palette[2][c] = divideBy3Epi16(_mm_add_epi16(_mm_add_epi16(p0, p0), p1));
+        palette[3][c] = divideBy3Epi16(_mm_add_epi16(_mm_add_epi16(p1, p1), p0));
+    }
+
+    __m128i indices[2] = { _mm_setzero_si128(), _mm_setzero_si128() };
+    for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+    {
+        __m128i bestError[2], bestIndex[2];
+        for (int n = 0; n < 4; n++)
+        {
+            __m128i d[3];
+            for (int c = 0; c < 3; c++)
+            {
+                __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(texels[i][c]));
+                d[c] = _mm_sub_epi16(v, palette[n][c]);
+            }
+            for (int half = 0; half < 2; half++)
+            {
+                __m128i rg = half == 0 ? _mm_unpacklo_epi16(d[0], d[1]) : _mm_unpackhi_epi16(d[0], d[1]);
+                __m128i b0 = half == 0 ? _mm_unpacklo_epi16(d[2], _mm_setzero_si128()) :
+                                         _mm_unpackhi_epi16(d[2], _mm_setzero_si128());
+                __m128i error = _mm_add_epi32(_mm_madd_epi16(rg, rg), _mm_madd_epi16(b0, b0));
+                if (n == 0)
+                {
+                    bestError[half] = error;
+                    bestIndex[half] = _mm_setzero_si128();
+                    continue;
+                }
+                __m128i better = _mm_cmplt_epi32(error, bestError[half]);
+                bestError[half] = selectSi128(better, error, bestError[half]);
+                bestIndex[half] = selectSi128(better, _mm_set1_epi32(n), bestIndex[half]);
+            }
+        }
+        __m128i shift = _mm_cvtsi32_si128(2 * i);
+        indices[0] = _mm_or_si128(indices[0], _mm_sll_epi32(bestIndex[0], shift));
+        indices[1] = _mm_or_si128(indices[1], _mm_sll_epi32(bestIndex[1], shift));
+    }
+
+    alignas(16) quint16 endpoints[2][FastBlockGroup];
+    alignas(16) quint32 packedIndices[FastBlockGroup];
+    _mm_store_si128(reinterpret_cast<__m128i *>(endpoints[0]), c0);
+    _mm_store_si128(reinterpret_cast<__m128i *>(endpoints[1]), c1);
+    _mm_store_si128(reinterpret_cast<__m128i *>(packedIndices), indices[0]);
+    _mm_store_si128(reinterpret_cast<__m128i *>(packedIndices + 4), indices[1]);
+    for (int b = 0; b < FastBlockGroup; b++)
+    {
+        compressedBlocks[b][0] = endpoints[0][b] | (static_cast<quint32>(endpoints[1][b]) << 16);
+        compressedBlocks[b][1] = packedIndices[b];
+    }
+}
+
+void compressAlphaBlocksFast(const quint8 blocks[FastBlockGroup][BLOCK_SIZE_4X4X4], int channel,
+                             quint32 compressedBlocks[FastBlockGroup][2])
+{
+    alignas(16) qint16 texels[BLOCK_SIZE_4X4][FastBlockGroup];
+    for (int b = 0; b < FastBlockGroup; b++)
+    {
+        for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+            texels[i][b] = blocks[b][i * 4 + channel];
+    }
+
+    __m128i minAlpha = _mm_load_si128(reinterpret_cast<const __m128i *>(texels[0]));
+    __m128i maxAlpha = minAlpha;
+    for (int i = 1; i < BLOCK_SIZE_4X4; i++)
+    {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(texels[i]));
+        minAlpha = _mm_min_epi16(minAlpha, v);
+        maxAlpha = _mm_max_epi16(maxAlpha, v);
+    }
+
+    // step = ((v - min) * 14 + range) / (2 * range) counted as the thresholds
+    // (v - min) * 14 >= (2k - 1) * range passed for k = 1..7, a flat block gives 7
+    __m128i range = _mm_sub_epi16(maxAlpha, minAlpha);
+    __m128i thresholds[7];
+    for (int k = 1; k <= 7; k++)
+        thresholds[k - 1] = _mm_mullo_epi16(range, _mm_set1_epi16(2 * k - 1));
+
+    // 8 values mode: index 0 is maximum, 1 is minimum, 2-7 are interpolated towards minimum
+    alignas(16) quint16 indices[BLOCK_SIZE_4X4][FastBlockGroup];
+    for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+    {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(texels[i]));
+        __m128i scaled = _mm_mullo_epi16(_mm_sub_epi16(v, minAlpha), _mm_set1_epi16(14));
+        __m128i step = _mm_set1_epi16(7);
+        for (int k = 0; k < 7; k++)
+            step = _mm_add_epi16(step, _mm_cmplt_epi16(scaled, thresholds[k]));
+        __m128i index = _mm_and_si128(_mm_sub_epi16(_mm_set1_epi16(8), step), _mm_set1_epi16(7));
+        index = _mm_xor_si128(index, _mm_and_si128(_mm_cmplt_epi16(index, _mm_set1_epi16(2)), _mm_set1_epi16(1)));
+        _mm_store_si128(reinterpret_cast<__m128i *>(indices[i]), index);
+    }
+
+    alignas(16) quint16 endpoints[2][FastBlockGroup];
+    _mm_store_si128(reinterpret_cast<__m128i *>(endpoints[0]), maxAlpha);
+    _mm_store_si128(reinterpret_cast<__m128i *>(endpoints[1]), minAlpha);
+    for (int b = 0; b < FastBlockGroup; b++)
+    {
+        quint64 bits = endpoints[0][b] | (endpoints[1][b] << 8);
+        for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+            bits |= static_cast<quint64>(indices[i][b]) << (16 + 3 * i);
+        compressedBlocks[b][0] = static_cast<quint32>(bits);
+        compressedBlocks[b][1] = static_cast<quint32>(bits >> 32);
+    }
+}
+
+// Encoded blocks of one mip keyed by their exact source texels
+struct EncodedBlock
+{
+    quint8 data[BLOCK_SIZE_4X4BPP8];
+};
+
+const int BlockMemoMaxEntries = 16384;
+
+void readBlockMemoKey(float key[BLOCK_SIZE_4X4X4], const float *src, int srcW, int blockX, int blockY)
+{
+    int srcPitch = srcW * 4;
+    const float *srcBlock = src + (blockY * 4) * srcPitch + blockX * 4 * 4;
+    for (int y = 0; y < 4; y++)
+        memcpy(key + y * 4 * 4, srcBlock + y * srcPitch, 4 * 4 * sizeof(float));
+}
+
+// BC7 mode masks used for blocks without and with alpha for each profile
+struct Bc7ProfileModes
+{
+    quint32 opaqueModes;
+    quint32 alphaModes;
+};
+
+Bc7ProfileModes getBc7ProfileModes(Image::Bc7Profile profile)
+{
+    switch (profile)
+    {
+        case Image::Bc7Profile::VeryFast:
+            return { 1 << 6, 1 << 6 };
+        case Image::Bc7Profile::Fast:
+            return { (1 << 1) | (1 << 6), (1 << 6) | (1 << 7) };
+        case Image::Bc7Profile::Slow:
+            return { 0xFF, 0xFF };
+        case Image::Bc7Profile::Normal:
+        default:
+            return { 0xCF, 0xCF };
+    }
+}
+
+struct Bc7SolidEndpoints
+{
+    quint8 e0, e1;
+};
+
+// 7 bit endpoint pairs which interpolated at 2 bit index 1 give the closest
+// value to each 8 bit colour component, used for mode 5 solid blocks
+const Bc7SolidEndpoints *getBc7SolidTable()
+{
+    static const auto table = []
+    {
+        std::array<Bc7SolidEndpoints, 256> entries{};
+        std::array<int, 256> errors;
+        errors.fill(INT_MAX);
+        for (int e0 = 0; e0 < 128; e0++)
+        {
+            for (int e1 = 0; e1 < 128; e1++)
+            {
+                int v0 = (e0 << 1) | (e0 >> 6);
+                int v1 = (e1 << 1) | (e1 >> 6);
+                int value = ((64 - 21) * v0 + 21 * v1 + 32) >> 6;
+                for (int target = 0; target < 256; target++)
+                {
+                    int error = abs(value - target);
+                    if (error < errors[target])
+                    {
+                        errors[target] = error;
+                        entries[target] = { static_cast<quint8>(e0), static_cast<quint8>(e1) };
+                    }
+                }
+            }
+        }
+        return entries;
+    }();
+    return table.data();
+}
+
+class Bc7BitWriter
+{
+    quint8 *out;
+    int position = 0;
+
+public:
+    explicit Bc7BitWriter(quint8 *block) : out(block) { memset(out, 0, BLOCK_SIZE_4X4); }
+    void Write(quint32 value, int bits)
+    {
+        for (int i = 0; i < bits; i++, position++)
+        {
+            if (value & (1 << i))
+                out[position / 8] |= 1 << (position % 8);
+        }
+    }
+};
+
+// Encode a block of a single colour as BC7 mode 5 without running the search
+bool compressBC7BlockSolid(const float in[BLOCK_SIZE_4X4][4], quint8 out[BLOCK_SIZE_4X4])
+{
+    for (int i = 1; i < BLOCK_SIZE_4X4; i++)
+    {
+        if (in[i][0] != in[0][0] || in[i][1] != in[0][1] ||
+            in[i][2] != in[0][2] || in[i][3] != in[0][3])
+        {
+            return false;
+        }
+    }
+
+    const Bc7SolidEndpoints *table = getBc7SolidTable();
+    int color[4];
+    for (int c = 0; c < 4; c++)
+        color[c] = static_cast<int>(lroundf(MIN(255.0f, MAX(0.0f, in[0][c]))));
+
+    Bc7BitWriter writer(out);
+    writer.Write(1 << 5, 6); // mode 5
+    writer.Write(0, 2); // no rotation
+    for (int c = 0; c < 3; c++)
+    {
+        writer.Write(table[color[c]].e0, 7);
+        writer.Write(table[color[c]].e1, 7);
+    }
+    writer.Write(color[3], 8);
+    writer.Write(color[3], 8);
+    writer.Write(1, 1); // anchor colour index
+    for (int i = 1; i < BLOCK_SIZE_4X4; i++)
+        writer.Write(1, 2);
+    // alpha indices stay zero
+
+    return true;
+}
+
+} // namespace
+
+// Parses DDS header up to mips data, data size is what the mips need
+bool Image::ReadDDSHeader(Stream &stream, DDSHeader &header)
 {
     if (stream.ReadUInt32() != DDS_TAG)
     {
         PERROR("The data has not DDS header!\n");
-        return;
+        return false;
     }
 
     if (stream.ReadInt32() != DDS_HEADER_dwSize)
     {
         PERROR("The data has wrong DDS header dwSize.\n");
-        return;
+        return false;
     }
-    source8Bits = true;
+    header.source8Bits = true;
+    header.DX10Type = false;
 
-    DDSflags = stream.ReadUInt32();
+    header.flags = stream.ReadUInt32();
 
-    int dwHeight = stream.ReadInt32();
-    int dwWidth = stream.ReadInt32();
-    if (!checkPowerOfTwo(dwWidth) ||
-        !checkPowerOfTwo(dwHeight))
+    header.height = stream.ReadInt32();
+    header.width = stream.ReadInt32();
+    if (!checkPowerOfTwo(header.width) ||
+        !checkPowerOfTwo(header.height))
     {
         PERROR("DDS image has dimensions not power of two.\n");
-        return;
+        return false;
     }
 
     stream.Skip(8); // dwPitchOrLinearSize, dwDepth
 
-    int dwMipMapCount = stream.ReadInt32();
-    if (dwMipMapCount == 0)
-        dwMipMapCount = 1;
+    header.mipsCount = stream.ReadInt32();
+    if (header.mipsCount == 0)
+        header.mipsCount = 1;
 
     stream.Skip(11 * 4); // dwReserved1
     stream.SkipInt32(); // ppf.dwSize
 
-    ddsPixelFormat.flags = stream.ReadUInt32();
-    ddsPixelFormat.fourCC = stream.ReadUInt32();
-    ddsPixelFormat.bits = stream.ReadUInt32();
-    ddsPixelFormat.Rmask = stream.ReadUInt32();
-    ddsPixelFormat.Gmask = stream.ReadUInt32();
-    ddsPixelFormat.Bmask = stream.ReadUInt32();
-    ddsPixelFormat.Amask = stream.ReadUInt32();
+    header.ddsPixelFormat.flags = stream.ReadUInt32();
+    header.ddsPixelFormat.fourCC = stream.ReadUInt32();
+    header.ddsPixelFormat.bits = stream.ReadUInt32();
+    header.ddsPixelFormat.Rmask = stream.ReadUInt32();
+    header.ddsPixelFormat.Gmask = stream.ReadUInt32();
+    header.ddsPixelFormat.Bmask = stream.ReadUInt32();
+    header.ddsPixelFormat.Amask = stream.ReadUInt32();
 
-    switch (ddsPixelFormat.fourCC)
+    switch (header.ddsPixelFormat.fourCC)
     {
         case 0:
-            if (ddsPixelFormat.bits == 32 &&
-                (ddsPixelFormat.flags & DDPF_ALPHAPIXELS) != 0 &&
-                   ddsPixelFormat.Rmask == 0xFF0000 &&
-                   ddsPixelFormat.Gmask == 0xFF00 &&
-                   ddsPixelFormat.Bmask == 0xFF &&
-                   ddsPixelFormat.Amask == 0xFF000000)
+            if (header.ddsPixelFormat.bits == 32 &&
+                (header.ddsPixelFormat.flags & DDPF_ALPHAPIXELS) != 0 &&
+                   header.ddsPixelFormat.Rmask == 0xFF0000 &&
+                   header.ddsPixelFormat.Gmask == 0xFF00 &&
+                   header.ddsPixelFormat.Bmask == 0xFF &&
+                   header.ddsPixelFormat.Amask == 0xFF000000)
             {
-                pixelFormat = PixelFormat::ARGB;
+                header.pixelFormat = PixelFormat::ARGB;
                 break;
             }
-            if (ddsPixelFormat.bits == 24 &&
-                   ddsPixelFormat.Rmask == 0xFF0000 &&
-                   ddsPixelFormat.Gmask == 0xFF00 &&
-                   ddsPixelFormat.Bmask == 0xFF)
+            if (header.ddsPixelFormat.bits == 24 &&
+                   header.ddsPixelFormat.Rmask == 0xFF0000 &&
+                   header.ddsPixelFormat.Gmask == 0xFF00 &&
+                   header.ddsPixelFormat.Bmask == 0xFF)
             {
-                pixelFormat = PixelFormat::RGB;
+                header.pixelFormat = PixelFormat::RGB;
                 break;
             }
-            if (ddsPixelFormat.bits == 16 &&
-                   ddsPixelFormat.Rmask == 0xFF &&
-                   ddsPixelFormat.Gmask == 0xFF00 &&
-                   ddsPixelFormat.Bmask == 0x00)
+            if (header.ddsPixelFormat.bits == 16 &&
+                   header.ddsPixelFormat.Rmask == 0xFF &&
+                   header.ddsPixelFormat.Gmask == 0xFF00 &&
+                   header.ddsPixelFormat.Bmask == 0x00)
             {
-                pixelFormat = PixelFormat::V8U8;
+                header.pixelFormat = PixelFormat::V8U8;
                 break;
             }
-            if (ddsPixelFormat.bits == 8 &&
-                ddsPixelFormat.Rmask == 0xFF &&
-                ddsPixelFormat.Gmask == 0x00 &&
-                ddsPixelFormat.Bmask == 0x00)
+            if (header.ddsPixelFormat.bits == 8 &&
+                header.ddsPixelFormat.Rmask == 0xFF &&
+                header.ddsPixelFormat.Gmask == 0x00 &&
+                header.ddsPixelFormat.Bmask == 0x00)
             {
-                pixelFormat = PixelFormat::G8;
+                header.pixelFormat = PixelFormat::G8;
                 break;
             }
 
             PERROR("Not supported DDS format.\n");
-            return;
+            return false;
 
         case 21:
-            pixelFormat = PixelFormat::ARGB;
+            header.pixelFormat = PixelFormat::ARGB;
             break;
 
         case 20:
-            pixelFormat = PixelFormat::RGB;
+            header.pixelFormat = PixelFormat::RGB;
             break;
 
         case 60:
-            pixelFormat = PixelFormat::V8U8;
+            header.pixelFormat = PixelFormat::V8U8;
             break;
 
         case 50:
-            pixelFormat = PixelFormat::G8;
+            header.pixelFormat = PixelFormat::G8;
             break;
 
         case FOURCC_DXT1_TAG:
-            pixelFormat = PixelFormat::DXT1;
+            header.pixelFormat = PixelFormat::DXT1;
             break;
 
         case FOURCC_DXT3_TAG:
-            pixelFormat = PixelFormat::DXT3;
+            header.pixelFormat = PixelFormat::DXT3;
             break;
 
         case FOURCC_DXT5_TAG:
-            pixelFormat = PixelFormat::DXT5;
+            header.pixelFormat = PixelFormat::DXT5;
             break;
 
         case FOURCC_ATI2_TAG:
-            pixelFormat = PixelFormat::ATI2;
+            header.pixelFormat = PixelFormat::ATI2;
             break;
 
         case FOURCC_DX10_TAG:
-            DX10Type = true;
+            header.DX10Type = true;
             break;
 
         default:
             PERROR("Not supported DDS format.\n");
-            return;
+            return false;
     }
     stream.Skip(20); // dwCaps, dwCaps2, dwCaps3, dwCaps4, dwReserved2
 
     DDS_FORMAT dds10Format = DDS_FORMAT_UNKNOWN;
     DDS_RESOURCE_DIMENSION dds10ResDim = DDS_RESOURCE_DIMENSION_UNKNOWN;
     quint32 dds10NumElements = 0;
-    if (DX10Type)
+    if (header.DX10Type)
     {
         dds10Format = (DDS_FORMAT)stream.ReadUInt32();
         dds10ResDim = (DDS_RESOURCE_DIMENSION)stream.ReadUInt32();
         if (dds10ResDim != DDS_RESOURCE_DIMENSION_TEXTURE2D)
         {
             PERROR("DDS DX10 dimension resource different than Texture2D is not supported.\n");
-            return;
+            return false;
         }
         auto miscFlags = (DDS_RESOURCE_MISC_FLAG)stream.ReadUInt32();
         if (miscFlags & DDS_RESOURCE_MISC_TEXTURECUBE)
         {
             PERROR("DDS DX10 dimension resource flag cube is not supported.\n");
-            return;
+            return false;
         }
         dds10NumElements = stream.ReadUInt32();
         if (dds10NumElements != 1)
         {
             PERROR("DDS DX10 number of elements must be 1.\n");
-            return;
+            return false;
         }
         auto miscFlags2 = (DDS_ALPHA_MODE)stream.ReadUInt32();
         if (miscFlags2 != DDS_ALPHA_MODE_UNKNOWN &&
             miscFlags2 != DDS_ALPHA_MODE_OPAQUE)
         {
             PERROR("DDS DX10 alpha mode different than opaque is not supported.\n");
-            return;
+            return false;
         }
 
         switch (dds10Format)
         {
             case DDS_FORMAT_R8G8B8A8_UNORM:
-                DX10Type = true;
-                pixelFormat = PixelFormat::RGBA;
+                header.DX10Type = true;
+                header.pixelFormat = PixelFormat::RGBA;
                 break;
             case DDS_FORMAT_R10G10B10A2_UNORM:
-                DX10Type = true;
-                pixelFormat = PixelFormat::R10G10B10A2;
-                source8Bits = false;
+                header.DX10Type = true;
+                header.pixelFormat = PixelFormat::R10G10B10A2;
+                header.source8Bits = false;
                 break;
             case DDS_FORMAT_R16G16B16A16_UNORM:
-                DX10Type = true;
-                pixelFormat = PixelFormat::R16G16B16A16;
-                source8Bits = false;
+                header.DX10Type = true;
+                header.pixelFormat = PixelFormat::R16G16B16A16;
+                header.source8Bits = false;
                 break;
             case DDS_FORMAT_R8_UNORM:
-                pixelFormat = PixelFormat::G8;
-                DX10Type = false;
+                header.pixelFormat = PixelFormat::G8;
+                header.DX10Type = false;
                 break;
             case DDS_FORMAT_BC1_UNORM:
-                pixelFormat = PixelFormat::DXT1;
-                DX10Type = false;
+                header.pixelFormat = PixelFormat::DXT1;
+                header.DX10Type = false;
                 break;
             case DDS_FORMAT_BC2_UNORM:
-                pixelFormat = PixelFormat::DXT3;
-                DX10Type = false;
+                header.pixelFormat = PixelFormat::DXT3;
+                header.DX10Type = false;
                 break;
             case DDS_FORMAT_BC3_UNORM:
-                pixelFormat = PixelFormat::DXT5;
-                DX10Type = false;
+                header.pixelFormat = PixelFormat::DXT5;
+                header.DX10Type = false;
                 break;
             case DDS_FORMAT_BC5_UNORM:
-                pixelFormat = PixelFormat::BC5;
-                DX10Type = true;
+                header.pixelFormat = PixelFormat::BC5;
+                header.DX10Type = true;
                 break;
             case DDS_FORMAT_BC7_UNORM:
-                pixelFormat = PixelFormat::BC7;
-                DX10Type = true;
+                header.pixelFormat = PixelFormat::BC7;
+                header.DX10Type = true;
                 break;
             default:
                 PERROR("Not supported DDS DX10 format.\n");
-                return;
+                return false;
         }
     }
 
+    header.dataOffset = stream.Position();
+    header.dataSize = 0;
+    for (int i = 0; i < header.mipsCount; i++)
+    {
+        int w = qMax(header.width >> i, 1);
+        int h = qMax(header.height >> i, 1);
+        MipMap::alignToBlockSize(w, h, header.pixelFormat);
+        header.dataSize += MipMap::getBufferSize(w, h, header.pixelFormat);
+    }
+
+    return true;
+}
+
+void Image::LoadImageDDS(Stream &stream, bool &source8Bits,
+                         const std::shared_ptr<const void> &viewOwner, const ByteBuffer *viewData)
+{
+    DDSHeader header{};
+    if (!ReadDDSHeader(stream, header))
+        return;
+    source8Bits = header.source8Bits;
+    DDSflags = header.flags;
+    ddsPixelFormat = header.ddsPixelFormat;
+    pixelFormat = header.pixelFormat;
+    DX10Type = header.DX10Type;
+    int dwWidth = header.width;
+    int dwHeight = header.height;
+    int dwMipMapCount = header.mipsCount;
+
+    // in view mode the header was parsed from a copy, mips are referenced in place
+    qint64 viewOffset = stream.Position();
     for (int i = 0; i < dwMipMapCount; i++)
     {
         int w = dwWidth >> i;
@@ -255,9 +780,31 @@ void Image::LoadImageDDS(Stream &stream, bool &source8Bits)
         }
 
         int size = MipMap::getBufferSize(w, h, pixelFormat);
-        ByteBuffer tempData = stream.ReadToBuffer(size);
-        mipMaps.push_back(new MipMap(tempData, origW, origH, pixelFormat));
-        tempData.Free();
+        if (viewData != nullptr)
+        {
+            if (viewOffset + size > viewData->size())
+                CRASH_MSG("DDS data is truncated.");
+            auto view = ByteBuffer::view(viewData->ptr() + viewOffset, size);
+            mipMaps.push_back(new MipMap(viewOwner, view, origW, origH, pixelFormat));
+            viewOffset += size;
+        }
+        else
+        {
+            if (stream.Position() + size > stream.Length())
+            {
+                PERROR("DDS data is truncated.\n");
+                foreach(MipMap *mipmap, mipMaps)
+                {
+                    mipmap->Free();
+                    delete mipmap;
+                }
+                mipMaps.clear();
+                return;
+            }
+            ByteBuffer tempData = stream.ReadToBuffer(size);
+            mipMaps.push_back(new MipMap(tempData, origW, origH, pixelFormat));
+            tempData.Free();
+        }
     }
 }
 
@@ -369,27 +916,21 @@ Image::DDS_PF Image::getDDSPixelFormat(PixelFormat format)
     return pixelFormat;
 }
 
-void Image::StoreImageToDDS(Stream &stream, PixelFormat format)
+bool Image::StoreDDSHeader(Stream &stream, int width, int height, int mipsCount, int dataSize, PixelFormat format)
 {
     stream.WriteUInt32(DDS_TAG);
     stream.WriteInt32(DDS_HEADER_dwSize);
     stream.WriteUInt32(DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_MIPMAPCOUNT | DDSD_PIXELFORMAT | DDSD_LINEARSIZE);
-    stream.WriteInt32(mipMaps[0]->getHeight());
-    stream.WriteInt32(mipMaps[0]->getWidth());
-
-    int dataSize = 0;
-    for (int i = 0; i < mipMaps.count(); i++)
-        dataSize += MipMap::getBufferSize(mipMaps[i]->getWidth(),
-                                          mipMaps[i]->getHeight(),
-                                          format == PixelFormat::UnknownPixelFormat ? pixelFormat : format);
+    stream.WriteInt32(height);
+    stream.WriteInt32(width);
     stream.WriteInt32(dataSize);
 
     stream.WriteUInt32(0); // dwDepth
-    stream.WriteInt32(mipMaps.count());
+    stream.WriteInt32(mipsCount);
     stream.WriteZeros(44); // dwReserved1
 
     stream.WriteInt32(DDS_PIXELFORMAT_dwSize);
-    DDS_PF pixfmt = getDDSPixelFormat(format == PixelFormat::UnknownPixelFormat ? pixelFormat : format);
+    DDS_PF pixfmt = getDDSPixelFormat(format);
     stream.WriteUInt32(pixfmt.flags);
     stream.WriteUInt32(pixfmt.fourCC);
     stream.WriteUInt32(pixfmt.bits);
@@ -404,39 +945,40 @@ void Image::StoreImageToDDS(Stream &stream, PixelFormat format)
     stream.WriteUInt32(0); // dwCaps4
     stream.WriteUInt32(0); // dwReserved2
 
+    bool dx10Type;
     DDS_FORMAT dds10Format = DDS_FORMAT::DDS_FORMAT_UNKNOWN;
     UINT32 miscFlag2 = 0;
-    switch (format == PixelFormat::UnknownPixelFormat ? pixelFormat : format)
+    switch (format)
     {
         case PixelFormat::RGBA:
             dds10Format = DDS_FORMAT_R8G8B8A8_UNORM;
             miscFlag2 = DDS_ALPHA_MODE_OPAQUE;
-            DX10Type = true;
+            dx10Type = true;
             break;
         case PixelFormat::R10G10B10A2:
             dds10Format = DDS_FORMAT_R10G10B10A2_UNORM;
             miscFlag2 = DDS_ALPHA_MODE_OPAQUE;
-            DX10Type = true;
+            dx10Type = true;
             break;
         case PixelFormat::R16G16B16A16:
             dds10Format = DDS_FORMAT_R16G16B16A16_UNORM;
             miscFlag2 = DDS_ALPHA_MODE_OPAQUE;
-            DX10Type = true;
+            dx10Type = true;
             break;
         case PixelFormat::BC5:
             dds10Format = DDS_FORMAT_BC5_UNORM;
-            DX10Type = true;
+            dx10Type = true;
             break;
         case PixelFormat::BC7:
             dds10Format = DDS_FORMAT_BC7_UNORM;
-            DX10Type = true;
+            dx10Type = true;
             break;
         default:
-            DX10Type = false;
+            dx10Type = false;
             break;
     }
 
-    if (DX10Type)
+    if (dx10Type)
     {
         stream.WriteUInt32(dds10Format);
         stream.WriteUInt32(DDS_RESOURCE_DIMENSION_TEXTURE2D); // RESOURCE_DIMENSION
@@ -445,6 +987,20 @@ void Image::StoreImageToDDS(Stream &stream, PixelFormat format)
         stream.WriteUInt32(miscFlag2);
     }
 
+    return dx10Type;
+}
+
+void Image::StoreImageToDDS(Stream &stream, PixelFormat format)
+{
+    PixelFormat ddsFormat = format == PixelFormat::UnknownPixelFormat ? pixelFormat : format;
+    int dataSize = 0;
+    for (int i = 0; i < mipMaps.count(); i++)
+        dataSize += MipMap::getBufferSize(mipMaps[i]->getWidth(),
+                                          mipMaps[i]->getHeight(),
+                                          ddsFormat);
+    DX10Type = StoreDDSHeader(stream, mipMaps[0]->getWidth(), mipMaps[0]->getHeight(),
+                              mipMaps.count(), dataSize, ddsFormat);
+
     for (int i = 0; i < mipMaps.count(); i++)
     {
         stream.WriteFromBuffer(mipMaps[i]->getRefData().ptr(),
@@ -459,6 +1015,35 @@ ByteBuffer Image::StoreImageToDDS()
     return stream.ToArray();
 }
 
+DDSStreamWriter::DDSStreamWriter(Stream &output, PixelFormat format) :
+    stream(output), pixelFormat(format)
+{
+    Image::StoreDDSHeader(stream, 0, 0, 0, 0, pixelFormat);
+}
+
+void DDSStreamWriter::WriteMipMap(const ByteBuffer &data, int w, int h)
+{
+    MipMap::alignToBlockSize(w, h, pixelFormat);
+    if (data.size() != MipMap::getBufferSize(w, h, pixelFormat))
+        CRASH_MSG("Data size of texture is not valid.");
+    if (mipsCount == 0)
+    {
+        width = w;
+        height = h;
+    }
+    stream.WriteFromBuffer(data);
+    dataSize += data.size();
+    mipsCount++;
+}
+
+void DDSStreamWriter::Finish()
+{
+    qint64 endPosition = stream.Position();
+    stream.JumpTo(0);
+    Image::StoreDDSHeader(stream, width, height, mipsCount, dataSize, pixelFormat);
+    stream.JumpTo(endPosition);
+}
+
 void Image::readBlockInternalToDxt(float blockARGB[BLOCK_SIZE_4X4X4], const float *srcARGB,
                                    int srcW, int blockX, int blockY)
 {
@@ -483,29 +1068,48 @@ void Image::readBlockInternalToDxt(float blockARGB[BLOCK_SIZE_4X4X4], const floa
     }
 }
 
-void Image::writeBlockDxtToInternal(const float blockARGB[BLOCK_SIZE_4X4X4], float *dstARGB,
-                                    int dstW, int blockX, int blockY)
+void Image::readBlockInternalToBytes(quint8 block[BLOCK_SIZE_4X4X4], const float *src,
+                                     int srcW, int blockX, int blockY)
 {
-    int dstPitch = dstW * 4;
-    int blockPitch = 4 * 4;
-    int dstARGBPtr = (blockY * 4) * dstPitch + blockX * 4 * 4;
+    int srcPitch = srcW * 4;
+    int srcPtr = (blockY * 4) * srcPitch + blockX * 4 * 4;
 
+    // Same result as ROUND_FLOAT_TO_BYTE for values in [0, 1], the bias is the
+    // float below 0.5 so the add never rounds up to the next integer,
+    // values outside of the range saturate
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 bias = _mm_set1_ps(0.49999997f);
     for (int y = 0; y < 4; y++)
     {
-        int blockPtr = y * blockPitch;
-        int dstARGBPtrY = dstARGBPtr + (y * dstPitch);
-        for (int x = 0; x < 4 * 4; x += 4)
-        {
-            int dstPtr = dstARGBPtrY + x;
-            dstARGB[dstPtr + 0] = blockARGB[blockPtr + 2];
-            dstARGB[dstPtr + 1] = blockARGB[blockPtr + 1];
-            dstARGB[dstPtr + 2] = blockARGB[blockPtr + 0];
-            dstARGB[dstPtr + 3] = blockARGB[blockPtr + 3];
-            blockPtr += 4;
-        }
+        const float *srcRow = src + srcPtr + (y * srcPitch);
+        __m128i texel[4];
+        for (int x = 0; x < 4; x++)
+            texel[x] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(srcRow + x * 4), scale), bias));
+        __m128i row = _mm_packus_epi16(_mm_packs_epi32(texel[0], texel[1]), _mm_packs_epi32(texel[2], texel[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(block + y * 4 * 4), row);
+    }
+}
+
+void Image::convertBlockDxtToInternal(float dst[BLOCK_SIZE_4X4X4], const float blockARGB[BLOCK_SIZE_4X4X4])
+{
+    for (int i = 0; i < BLOCK_SIZE_4X4X4; i += 4)
+    {
+        dst[i + 0] = blockARGB[i + 2];
+        dst[i + 1] = blockARGB[i + 1];
+        dst[i + 2] = blockARGB[i + 0];
+        dst[i + 3] = blockARGB[i + 3];
     }
 }
 
+void Image::writeBlockToInternal(const float block[BLOCK_SIZE_4X4X4], float *dst,
+                                 int dstW, int blockX, int blockY)
+{
+    int dstPitch = dstW * 4;
+    float *dstBlock = dst + (blockY * 4) * dstPitch + blockX * 4 * 4;
+    for (int y = 0; y < 4; y++)
+        memcpy(dstBlock + y * dstPitch, block + y * 4 * 4, 4 * 4 * sizeof(float));
+}
+
 void Image::readBlockDxtBpp4(quint8 *dst, const quint8 *src, int srcW, int blockX, int blockY)
 {
     int offset = blockY * srcW * 2 + blockX * 2 * sizeof(uint);
@@ -518,7 +1122,7 @@ void Image::readBlockDxtBpp8(quint8 *dst, const quint8 *src, int srcW, int block
     memcpy(dst, src + offset, BLOCK_SIZE_4X4BPP8);
 }
 
-void Image::convertBlock4X4X4DoubleToFloat(float dst[BLOCK_SIZE_4X4X4], double src[BLOCK_SIZE_4X4][4])
+void Image::convertBlock4X4X4FromBc7(float dst[BLOCK_SIZE_4X4X4], const float src[BLOCK_SIZE_4X4][4])
 {
     int dstIndex = 0;
     for (int row = 0; row < 4; row++) {
@@ -532,7 +1136,7 @@ void Image::convertBlock4X4X4DoubleToFloat(float dst[BLOCK_SIZE_4X4X4], double s
     }
 }
 
-void Image::convertBlock4X4X4FloatToDouble(double dst[BLOCK_SIZE_4X4][4], const float src[BLOCK_SIZE_4X4X4])
+void Image::convertBlock4X4X4ToBc7(float dst[BLOCK_SIZE_4X4][4], const float src[BLOCK_SIZE_4X4X4])
 {
     int srcIndex = 0;
     for (int row = 0; row < 4; row++) {
@@ -583,29 +1187,6 @@ void Image::readBlockInternalToAti2(float blockDstX[BLOCK_SIZE_4X4BPP8], float b
     }
 }
 
-void Image::writeBlockAti2ToInternal(const float blockR[BLOCK_SIZE_4X4BPP8],
-                                     const float blockG[BLOCK_SIZE_4X4BPP8],
-                                     float *dstARGB, int srcW, int blockX, int blockY)
-{
-    int dstPitch = srcW * 4;
-    int blockPitch = 4;
-    int dstARGBPtr = (blockY * 4) * dstPitch + blockX * 4 * 4;
-
-    for (int y = 0; y < 4; y++)
-    {
-        int dstARGBPtrY = dstARGBPtr + (y * dstPitch);
-        for (int x = 0; x < 4 * 4; x += 4)
-        {
-            int blockPtr = y * blockPitch + (x / 4);
-            int dstPtr = dstARGBPtrY + x;
-            dstARGB[dstPtr + 0] = blockR[blockPtr];
-            dstARGB[dstPtr + 1] = blockG[blockPtr];
-            dstARGB[dstPtr + 2] = 1.0f;
-            dstARGB[dstPtr + 3] = 1.0f;
-        }
-    }
-}
-
 ByteBuffer Image::compressMipmap(PixelFormat dstFormat, const ByteBuffer src, int w, int h,
                                  bool useDXT1Alpha, quint8 DXT1Threshold, float bc7quality)
 {
@@ -628,13 +1209,28 @@ ByteBuffer Image::compressMipmap(PixelFormat dstFormat, const ByteBuffer src, in
     for (int p = 1; p <= cores; p++)
         range[p] = (partSize * p);
 
+    bool fast = dxtQuality == DxtQuality::Fast;
+
     BC7BlockEncoder **bc7Encoder = nullptr;
+    BC7BlockEncoder **bc7OpaqueEncoder = nullptr;
+    Bc7ProfileModes bc7Modes = getBc7ProfileModes(bc7Profile);
     if (dstFormat == PixelFormat::BC7)
     {
         bc7Encoder = new BC7BlockEncoder *[cores];
+        bc7OpaqueEncoder = new BC7BlockEncoder *[cores];
         for (int p = 0; p < cores; p++)
         {
-            int status = BC7CreateEncoder(bc7quality, false, false, 0xCF, 1.0, &bc7Encoder[p]);
+            int status = BC7CreateEncoder(bc7quality, false, false, bc7Modes.alphaModes, 1.0f, &bc7Encoder[p]);
+            if (status != 0)
+            {
+                CRASH();
+            }
+            if (bc7Modes.opaqueModes == bc7Modes.alphaModes)
+            {
+                bc7OpaqueEncoder[p] = bc7Encoder[p];
+                continue;
+            }
+            status = BC7CreateEncoder(bc7quality, false, false, bc7Modes.opaqueModes, 1.0f, &bc7OpaqueEncoder[p]);
             if (status != 0)
             {
                 CRASH();
@@ -642,14 +1238,93 @@ ByteBuffer Image::compressMipmap(PixelFormat dstFormat, const ByteBuffer src, in
         }
     }
 
+    // Identical source blocks encode to identical output, so slow encoders
+    // reuse the result of the first one, fast integer encoders do not need it
+    bool useMemo = blockMemo && (!fast || dstFormat == PixelFormat::DXT3 || dstFormat == PixelFormat::BC7);
+    int memoHits[cores];
+    int memoLookups[cores];
+
+    bool fastGroups = fast && ((dstFormat == PixelFormat::DXT1 && !useDXT1Alpha) ||
+                               dstFormat == PixelFormat::DXT5 ||
+                               dstFormat == PixelFormat::ATI2 || dstFormat == PixelFormat::BC5);
+
     #pragma omp parallel for num_threads(cores)
     for (int p = 0; p < cores; p++)
     {
+        QHash<QByteArray, EncodedBlock> memo;
+        memoHits[p] = memoLookups[p] = 0;
         for (int y = range[p]; y < range[p + 1]; y++)
         {
+            if (fastGroups)
+            {
+                for (int x = 0; x < w / 4; x += FastBlockGroup)
+                {
+                    // Short last group is padded with copies of its last block
+                    int count = MIN(FastBlockGroup, w / 4 - x);
+                    quint8 srcBlocks[FastBlockGroup][BLOCK_SIZE_4X4X4];
+                    for (int b = 0; b < count; b++)
+                        readBlockInternalToBytes(srcBlocks[b], src.ptrAsFloat(), w, x + b, y);
+                    for (int b = count; b < FastBlockGroup; b++)
+                        memcpy(srcBlocks[b], srcBlocks[count - 1], BLOCK_SIZE_4X4X4);
+
+                    quint32 blocks[2][FastBlockGroup][2];
+                    if (dstFormat == PixelFormat::DXT1 || dstFormat == PixelFormat::DXT5)
+                        compressColorBlocksFast(srcBlocks, blocks[0]);
+                    if (dstFormat == PixelFormat::DXT5)
+                        compressAlphaBlocksFast(srcBlocks, 3, blocks[1]);
+                    if (dstFormat == PixelFormat::ATI2 || dstFormat == PixelFormat::BC5)
+                    {
+                        compressAlphaBlocksFast(srcBlocks, 1, blocks[0]);
+                        compressAlphaBlocksFast(srcBlocks, 0, blocks[1]);
+                    }
+
+                    for (int b = 0; b < count; b++)
+                    {
+                        if (dstFormat == PixelFormat::DXT1)
+                            writeBlockDxtBpp4((quint8 *)blocks[0][b], dst.ptr(), w, x + b, y);
+                        else if (dstFormat == PixelFormat::DXT5)
+                        {
+                            quint32 block[4] = { blocks[1][b][0], blocks[1][b][1], blocks[0][b][0], blocks[0][b][1] };
+                            writeBlockDxtBpp8((quint8 *)block, dst.ptr(), w, x + b, y);
+                        }
+                        else
+                            writeBlock4X4ATI2((quint8 *)blocks[0][b], (quint8 *)blocks[1][b], dst.ptr(), w, x + b, y);
+                    }
+                }
+                continue;
+            }
+
             for (int x = 0; x < w / 4; x++)
             {
-                if (dstFormat == PixelFormat::DXT1)
+                float memoKey[BLOCK_SIZE_4X4X4];
+                if (useMemo)
+                {
+                    readBlockMemoKey(memoKey, src.ptrAsFloat(), w, x, y);
+                    auto key = QByteArray::fromRawData(reinterpret_cast<const char *>(memoKey), sizeof(memoKey));
+                    auto it = memo.constFind(key);
+                    memoLookups[p]++;
+                    if (it != memo.constEnd())
+                    {
+                        memoHits[p]++;
+                        EncodedBlock block = it.value();
+                        if (blockSize == BLOCK_SIZE_4X4BPP4)
+                            writeBlockDxtBpp4(block.data, dst.ptr(), w, x, y);
+                        else
+                            writeBlockDxtBpp8(block.data, dst.ptr(), w, x, y);
+                        continue;
+                    }
+                }
+
+                if (fast && dstFormat == PixelFormat::DXT1)
+                {
+                    // Punch-through alpha
+                    uint block[2];
+                    quint8 srcBlock[BLOCK_SIZE_4X4X4];
+                    readBlockInternalToBytes(srcBlock, src.ptrAsFloat(), w, x, y);
+                    compressColorBlockFast(srcBlock, block, useDXT1Alpha, DXT1Threshold);
+                    writeBlockDxtBpp4((quint8 *)block, dst.ptr(), w, x, y);
+                }
+                else if (dstFormat == PixelFormat::DXT1)
                 {
                     uint block[2];
                     float srcBlock[BLOCK_SIZE_4X4X4];
@@ -688,34 +1363,137 @@ ByteBuffer Image::compressMipmap(PixelFormat dstFormat, const ByteBuffer src, in
                 else if (dstFormat == PixelFormat::BC7)
                 {
                     quint8 block[BLOCK_SIZE_4X4];
-                    double blockToEncode[BLOCK_SIZE_4X4][4];
+                    float blockToEncode[BLOCK_SIZE_4X4][4];
                     float srcBlock[BLOCK_SIZE_4X4X4];
                     readBlockInternalToDxt(srcBlock, src.ptrAsFloat(), w, x, y);
-                    convertBlock4X4X4FloatToDouble(blockToEncode, srcBlock);
-                    BC7CompressBlock(bc7Encoder[omp_get_thread_num()], blockToEncode, block);
+                    convertBlock4X4X4ToBc7(blockToEncode, srcBlock);
+                    if (!compressBC7BlockSolid(blockToEncode, block))
+                    {
+                        bool opaque = true;
+                        for (int i = 0; i < BLOCK_SIZE_4X4 && opaque; i++)
+                            opaque = blockToEncode[i][3] == 255.0f;
+                        int thread = omp_get_thread_num();
+                        BC7CompressBlock(opaque ? bc7OpaqueEncoder[thread] : bc7Encoder[thread], blockToEncode, block);
+                    }
                     writeBlockDxtBpp8((quint8 *)block, dst.ptr(), w, x, y);
                 }
                 else
                     CRASH_MSG("Not supported codec.");
+
+                if (useMemo && memo.size() < BlockMemoMaxEntries)
+                {
+                    EncodedBlock block;
+                    if (blockSize == BLOCK_SIZE_4X4BPP4)
+                        readBlockDxtBpp4(block.data, dst.ptr(), w, x, y);
+                    else
+                        readBlockDxtBpp8(block.data, dst.ptr(), w, x, y);
+                    memo.insert(QByteArray(reinterpret_cast<const char *>(memoKey), sizeof(memoKey)), block);
+                }
             }
         }
     }
 
+    if (useMemo)
+    {
+        int hits = 0, lookups = 0;
+        for (int p = 0; p < cores; p++)
+        {
+            hits += memoHits[p];
+            lookups += memoLookups[p];
+        }
+        if (lookups != 0)
+        {
+            PDEBUG(QString("Block memo: %1 of %2 blocks reused (%3%)\n").arg(hits).arg(lookups)
+                   .arg(hits * 100LL / lookups));
+        }
+    }
+
     if (dstFormat == PixelFormat::BC7)
     {
         for (int p = 0; p < cores; p++)
         {
+            if (bc7OpaqueEncoder[p] != bc7Encoder[p] && BC7DestoyEncoder(bc7OpaqueEncoder[p]) != 0)
+            {
+                CRASH();
+            }
             if (BC7DestoyEncoder(bc7Encoder[p]) != 0)
             {
                 CRASH();
             }
         }
+        delete[] bc7OpaqueEncoder;
         delete[] bc7Encoder;
     }
 
     return dst;
 }
 
+// Decodes single block into internal RGBA layout, shared by all decompression paths
+void Image::decompressBlockToInternal(PixelFormat srcFormat, const quint8 *src, int srcW,
+                                      int blockX, int blockY, BC7BlockDecoder *bc7Decoder,
+                                      float block[BLOCK_SIZE_4X4X4])
+{
+    if (srcFormat == PixelFormat::DXT1)
+    {
+        uint blockSrc[2];
+        float dstBlock[BLOCK_SIZE_4X4X4];
+        readBlockDxtBpp4((quint8 *)blockSrc, src, srcW, blockX, blockY);
+        DxtcDecompressRGBBlock(dstBlock, blockSrc, true);
+        convertBlockDxtToInternal(block, dstBlock);
+    }
+    else if (srcFormat == PixelFormat::DXT3)
+    {
+        uint blockSrc[4];
+        float dstBlock[BLOCK_SIZE_4X4X4];
+        readBlockDxtBpp8((quint8 *)blockSrc, src, srcW, blockX, blockY);
+        DxtcDecompressRGBABlock_ExplicitAlpha(dstBlock, blockSrc);
+        convertBlockDxtToInternal(block, dstBlock);
+    }
+    else if (srcFormat == PixelFormat::DXT5)
+    {
+        uint blockSrc[4];
+        float dstBlock[BLOCK_SIZE_4X4X4];
+        readBlockDxtBpp8((quint8 *)blockSrc, src, srcW, blockX, blockY);
+        DxtcDecompressRGBABlock(dstBlock, blockSrc);
+        convertBlockDxtToInternal(block, dstBlock);
+    }
+    else if (srcFormat == PixelFormat::ATI2 ||
+             srcFormat == PixelFormat::BC5)
+    {
+        uint blockSrcR[2];
+        uint blockSrcG[2];
+        uint blockSrc[4];
+        float blockDstR[BLOCK_SIZE_4X4BPP8];
+        float blockDstG[BLOCK_SIZE_4X4BPP8];
+        readBlockDxtBpp8((quint8 *)blockSrc, src, srcW, blockX, blockY);
+        blockSrcG[0] = blockSrc[0];
+        blockSrcG[1] = blockSrc[1];
+        blockSrcR[0] = blockSrc[2];
+        blockSrcR[1] = blockSrc[3];
+        DxtcDecompressAlphaBlock(blockDstR, blockSrcR);
+        DxtcDecompressAlphaBlock(blockDstG, blockSrcG);
+        for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+        {
+            block[i * 4 + 0] = blockDstR[i];
+            block[i * 4 + 1] = blockDstG[i];
+            block[i * 4 + 2] = 1.0f;
+            block[i * 4 + 3] = 1.0f;
+        }
+    }
+    else if (srcFormat == PixelFormat::BC7)
+    {
+        quint8 blockSrc[BLOCK_SIZE_4X4X4];
+        float dstBlock[BLOCK_SIZE_4X4][4];
+        float destBlock[BLOCK_SIZE_4X4X4];
+        readBlockDxtBpp8(blockSrc, src, srcW, blockX, blockY);
+        BC7DecompressBlock(bc7Decoder, blockSrc, dstBlock);
+        convertBlock4X4X4FromBc7(destBlock, dstBlock);
+        convertBlockDxtToInternal(block, destBlock);
+    }
+    else
+        CRASH_MSG("Not supported codec.");
+}
+
 ByteBuffer Image::decompressMipmap(PixelFormat srcFormat, const ByteBuffer src, int w, int h)
 {
     auto dst = ByteBuffer(w * h * 4 * sizeof(float));
@@ -754,59 +1532,10 @@ ByteBuffer Image::decompressMipmap(PixelFormat srcFormat, const ByteBuffer src,
         {
             for (int x = 0; x < w / 4; x++)
             {
-                if (srcFormat == PixelFormat::DXT1)
-                {
-                    uint block[2];
-                    float dstBlock[BLOCK_SIZE_4X4X4];
-                    readBlockDxtBpp4((quint8 *)block, src.ptr(), w, x, y);
-                    DxtcDecompressRGBBlock(dstBlock, block, true);
-                    writeBlockDxtToInternal(dstBlock, dst.ptrAsFloat(), w, x, y);
-                }
-                else if (srcFormat == PixelFormat::DXT3)
-                {
-                    uint block[4];
-                    float dstBlock[BLOCK_SIZE_4X4X4];
-                    readBlockDxtBpp8((quint8 *)block, src.ptr(), w, x, y);
-                    DxtcDecompressRGBABlock_ExplicitAlpha(dstBlock, block);
-                    writeBlockDxtToInternal(dstBlock, dst.ptrAsFloat(), w, x, y);
-                }
-                else if (srcFormat == PixelFormat::DXT5)
-                {
-                    uint block[4];
-                    float dstBlock[BLOCK_SIZE_4X4X4];
-                    readBlockDxtBpp8((quint8 *)block, src.ptr(), w, x, y);
-                    DxtcDecompressRGBABlock(dstBlock, block);
-                    writeBlockDxtToInternal(dstBlock, dst.ptrAsFloat(), w, x, y);
-                }
-                else if (srcFormat == PixelFormat::ATI2 ||
-                         srcFormat == PixelFormat::BC5)
-                {
-                    uint blockX[2];
-                    uint blockY[2];
-                    uint block[4];
-                    float blockDstR[BLOCK_SIZE_4X4BPP8];
-                    float blockDstG[BLOCK_SIZE_4X4BPP8];
-                    readBlockDxtBpp8((quint8 *)block, src.ptr(), w, x, y);
-                    blockY[0] = block[0];
-                    blockY[1] = block[1];
-                    blockX[0] = block[2];
-                    blockX[1] = block[3];
-                    DxtcDecompressAlphaBlock(blockDstR, blockX);
-                    DxtcDecompressAlphaBlock(blockDstG, blockY);
-                    writeBlockAti2ToInternal(blockDstR, blockDstG, dst.ptrAsFloat(), w, x, y);
-                }
-                else if (srcFormat == PixelFormat::BC7)
-                {
-                    quint8 block[BLOCK_SIZE_4X4X4];
-                    double dstBlock[BLOCK_SIZE_4X4][4];
-                    float destBlock[BLOCK_SIZE_4X4X4];
-                    readBlockDxtBpp8(block, src.ptr(), w, x, y);
-                    BC7DecompressBlock(bc7Decoder[omp_get_thread_num()], block, dstBlock);
-                    convertBlock4X4X4DoubleToFloat(destBlock, dstBlock);
-                    writeBlockDxtToInternal(destBlock, dst.ptrAsFloat(), w, x, y);
-                }
-                else
-                    CRASH_MSG("Not supported codec.");
+                float block[BLOCK_SIZE_4X4X4];
+                decompressBlockToInternal(srcFormat, src.ptr(), w, x, y,
+                                          bc7Decoder ? bc7Decoder[omp_get_thread_num()] : nullptr, block);
+                writeBlockToInternal(block, dst.ptrAsFloat(), w, x, y);
             }
         }
     }
@@ -825,3 +1554,206 @@ ByteBuffer Image::decompressMipmap(PixelFormat srcFormat, const ByteBuffer src,
 
     return dst;
 }
+
+bool Image::canDecompressMipmapToBytes(PixelFormat srcFormat, int w, int h)
+{
+    switch (srcFormat)
+    {
+        case PixelFormat::DXT1:
+        case PixelFormat::DXT3:
+        case PixelFormat::DXT5:
+        case PixelFormat::ATI2:
+        case PixelFormat::BC5:
+        case PixelFormat::BC7:
+            return w >= 4 && h >= 4;
+        default:
+            return false;
+    }
+}
+
+void Image::writeBlockInternalToBytes(const float blockARGB[BLOCK_SIZE_4X4X4], quint8 *dst, int dstW,
+                                      int blockX, int blockY, ByteLayout layout, bool clearAlpha)
+{
+    // Source channel for each destination byte, same as InternalTo*() functions
+    static const int channels[][4] =
+    {
+        { 0, 1, 2, 3 }, // RGBA
+        { 2, 1, 0, 3 }, // ARGB
+        { 2, 1, 0, -1 }, // RGB
+        { 0, 1, 2, -1 }, // BGR
+        { 3, 3, 3, -1 }, // AlphaGreyscale
+    };
+    const int *order = channels[static_cast<int>(layout)];
+    int bpp = order[3] == -1 ? 3 : 4;
+    int dstPitch = dstW * bpp;
+    quint8 *dstBlock = dst + (blockY * 4) * dstPitch + blockX * 4 * bpp;
+
+    quint8 bytes[BLOCK_SIZE_4X4X4];
+    for (int i = 0; i < BLOCK_SIZE_4X4X4; i++)
+        bytes[i] = ROUND_FLOAT_TO_BYTE(blockARGB[i]);
+    if (clearAlpha)
+    {
+        for (int i = 3; i < BLOCK_SIZE_4X4X4; i += 4)
+            bytes[i] = 255;
+    }
+
+    for (int y = 0; y < 4; y++)
+    {
+        quint8 *dstRow = dstBlock + (y * dstPitch);
+        const quint8 *src = bytes + y * 4 * 4;
+        for (int x = 0; x < 4; x++, src += 4, dstRow += bpp)
+        {
+            for (int c = 0; c < bpp; c++)
+                dstRow[c] = src[order[c]];
+        }
+    }
+}
+
+ByteBuffer Image::decompressMipmapToBytes(PixelFormat srcFormat, const ByteBuffer src, int w, int h,
+                                          ByteLayout layout, bool clearAlpha)
+{
+    int bpp = (layout == ByteLayout::RGBA || layout == ByteLayout::ARGB) ? 4 : 3;
+    auto dst = ByteBuffer(w * h * bpp);
+    int blocksY = h / 4;
+
+    BC7BlockDecoder **bc7Decoder = nullptr;
+    int cores = omp_get_max_threads();
+    if (srcFormat == PixelFormat::BC7)
+    {
+        bc7Decoder = new BC7BlockDecoder *[cores];
+        for (int p = 0; p < cores; p++)
+        {
+            int status = BC7CreateDecoder(&bc7Decoder[p]);
+            if (status != 0)
+            {
+                CRASH();
+            }
+        }
+    }
+
+    // Blocks are decoded by the same code as decompressMipmap() and
+    // rounded straight into the destination, so no full float image is needed.
+    #pragma omp parallel for num_threads(cores)
+    for (int y = 0; y < blocksY; y++)
+    {
+        for (int x = 0; x < w / 4; x++)
+        {
+            float block[BLOCK_SIZE_4X4X4];
+            decompressBlockToInternal(srcFormat, src.ptr(), w, x, y,
+                                      bc7Decoder ? bc7Decoder[omp_get_thread_num()] : nullptr, block);
+            writeBlockInternalToBytes(block, dst.ptr(), w, x, y, layout, clearAlpha);
+        }
+    }
+
+    if (srcFormat == PixelFormat::BC7)
+    {
+        for (int p = 0; p < cores; p++)
+        {
+            if (BC7DestoyDecoder(bc7Decoder[p]) != 0)
+            {
+                CRASH();
+            }
+        }
+        delete[] bc7Decoder;
+    }
+
+    return dst;
+}
+
+bool Image::detectAlphaDataDXT5(const ByteBuffer src, int w, int h)
+{
+    for (int y = 0; y < h / 4; y++)
+    {
+        for (int x = 0; x < w / 4; x++)
+        {
+            uint block[4];
+            readBlockDxtBpp8((quint8 *)block, src.ptr(), w, x, y);
+
+            // Same alpha ramp as DxtcDecompressAlphaBlock, reduced to a mask
+            // of ramp entries which round back to fully opaque.
+            float alpha[8];
+            alpha[0] = CONVERT_BYTE_TO_FLOAT(block[0] & 0xff);
+            alpha[1] = CONVERT_BYTE_TO_FLOAT((block[0] >> 8) & 0xff);
+            if (alpha[0] > alpha[1])
+            {
+                for (int i = 2; i < 8; i++)
+                    alpha[i] = ((8 - i) * alpha[0] + (i - 1) * alpha[1]) / 7;
+            }
+            else
+            {
+                for (int i = 2; i < 6; i++)
+                    alpha[i] = ((6 - i) * alpha[0] + (i - 1) * alpha[1]) / 5;
+                alpha[6] = 0;
+                alpha[7] = 1.0f;
+            }
+            quint8 opaqueMask = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                if (ROUND_FLOAT_TO_BYTE(alpha[i]) == 255)
+                    opaqueMask |= 1 << i;
+            }
+            if (opaqueMask == 0xff)
+                continue;
+            if (opaqueMask == 0)
+                return true;
+
+            quint64 indices = ((quint64)block[0] >> 16) | ((quint64)block[1] << 16);
+            for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+            {
+                if ((opaqueMask & (1 << ((indices >> (i * 3)) & 0x7))) == 0)
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool Image::detectAlphaDataBC7(const ByteBuffer src, int w, int h)
+{
+    BC7BlockDecoder *bc7Decoder = nullptr;
+    bool hasAlpha = false;
+
+    for (int y = 0; y < h / 4 && !hasAlpha; y++)
+    {
+        for (int x = 0; x < w / 4; x++)
+        {
+            quint8 block[BLOCK_SIZE_4X4X4];
+            readBlockDxtBpp8(block, src.ptr(), w, x, y);
+
+            // Modes 0-3 carry no alpha and always decode to opaque texels.
+            if (block[0] & 0x0f)
+                continue;
+            // Reserved mode, the decoder leaves such block undefined.
+            if (block[0] == 0)
+            {
+                hasAlpha = true;
+                break;
+            }
+
+            if (bc7Decoder == nullptr && BC7CreateDecoder(&bc7Decoder) != 0)
+            {
+                CRASH();
+            }
+            float dstBlock[BLOCK_SIZE_4X4][4];
+            BC7DecompressBlock(bc7Decoder, block, dstBlock);
+            for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+            {
+                if (ROUND_FLOAT_TO_BYTE(dstBlock[i][3] / 255.0f) != 255)
+                {
+                    hasAlpha = true;
+                    break;
+                }
+            }
+            if (hasAlpha)
+                break;
+        }
+    }
+
+    if (bc7Decoder && BC7DestoyDecoder(bc7Decoder) != 0)
+    {
+        CRASH();
+    }
+
+    return hasAlpha;
+}
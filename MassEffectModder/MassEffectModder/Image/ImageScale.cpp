@@ -0,0 +1,268 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#if defined(__aarch64__)
+#include "../sse2neon/sse2neon.h"
+#else
+#include <emmintrin.h>
+#endif
+
+#include <Image/Image.h>
+#include <Helpers/Logs.h>
+
+Image::MipFilter Image::mipFilter = Image::MipFilter::Box;
+
+namespace {
+
+const int MipFilterTaps = 8;
+const int ParallelMinPixels = 0x10000;
+const float Pi = 3.14159265358979323846f;
+
+// Taps of 2:1 decimation, applied to source pixels starting at 2 * x + firstTap
+struct MipFilterKernel
+{
+    int firstTap;
+    float weights[MipFilterTaps];
+};
+
+float sinc(float x)
+{
+    if (fabsf(x) < 1e-6f)
+        return 1.0f;
+    x *= Pi;
+    return sinf(x) / x;
+}
+
+float besselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    float halfX = x * 0.5f;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-8f)
+            break;
+    }
+    return sum;
+}
+
+// Both filters span 2 destination pixels each side, which is 8 source pixels at 2:1
+MipFilterKernel makeMipFilterKernel(Image::MipFilter filter)
+{
+    const float radius = 2.0f;
+    const float kaiserAlpha = 4.0f;
+
+    MipFilterKernel kernel{};
+    kernel.firstTap = 1 - MipFilterTaps / 2;
+    float sum = 0.0f;
+    for (int t = 0; t < MipFilterTaps; t++)
+    {
+        // Distance from centre between source pixels 2x and 2x + 1, in destination pixels
+        float d = ((kernel.firstTap + t) - 0.5f) * 0.5f;
+        float weight = 0.0f;
+        if (fabsf(d) < radius)
+        {
+            if (filter == Image::MipFilter::Lanczos)
+                weight = sinc(d) * sinc(d / radius);
+            else
+            {
+                float r = d / radius;
+                weight = sinc(d) * besselI0(kaiserAlpha * sqrtf(1.0f - r * r)) / besselI0(kaiserAlpha);
+            }
+        }
+        kernel.weights[t] = weight;
+        sum += weight;
+    }
+    for (int t = 0; t < MipFilterTaps; t++)
+        kernel.weights[t] /= sum;
+    return kernel;
+}
+
+// Negative lobes can overshoot, keep values in range of normalized formats
+inline __m128 clampUnit(__m128 v)
+{
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+// Kernel is symmetric, mirrored taps are summed first and share weight.
+// Pairs are reduced as a tree to keep dependency chains short.
+inline __m128 filterPairs(__m128 pair0, __m128 pair1, __m128 pair2, __m128 pair3, const __m128 *weights)
+{
+    __m128 acc0 = _mm_add_ps(_mm_mul_ps(pair0, weights[0]), _mm_mul_ps(pair1, weights[1]));
+    __m128 acc1 = _mm_add_ps(_mm_mul_ps(pair2, weights[2]), _mm_mul_ps(pair3, weights[3]));
+    return _mm_add_ps(acc0, acc1);
+}
+
+// Taps are consecutive RGBA pixels
+inline __m128 filterTaps(const float *taps, const __m128 *weights)
+{
+    return filterPairs(_mm_add_ps(_mm_loadu_ps(taps), _mm_loadu_ps(taps + 28)),
+                       _mm_add_ps(_mm_loadu_ps(taps + 4), _mm_loadu_ps(taps + 24)),
+                       _mm_add_ps(_mm_loadu_ps(taps + 8), _mm_loadu_ps(taps + 20)),
+                       _mm_add_ps(_mm_loadu_ps(taps + 12), _mm_loadu_ps(taps + 16)), weights);
+}
+
+void filterLineHorizontal(const float *src, float *dst, int srcCount, int dstCount,
+                          const MipFilterKernel &kernel, bool clampOutput)
+{
+    __m128 weights[MipFilterTaps / 2];
+    for (int t = 0; t < MipFilterTaps / 2; t++)
+        weights[t] = _mm_set1_ps(kernel.weights[t]);
+
+    for (int x = 0; x < dstCount; x++)
+    {
+        int first = 2 * x + kernel.firstTap;
+        __m128 acc;
+        if (first >= 0 && first + MipFilterTaps <= srcCount)
+        {
+            acc = filterTaps(src + first * 4, weights);
+        }
+        else
+        {
+            __m128 taps[MipFilterTaps];
+            for (int t = 0; t < MipFilterTaps; t++)
+                taps[t] = _mm_loadu_ps(src + qBound(0, first + t, srcCount - 1) * 4);
+            acc = filterPairs(_mm_add_ps(taps[0], taps[7]), _mm_add_ps(taps[1], taps[6]),
+                              _mm_add_ps(taps[2], taps[5]), _mm_add_ps(taps[3], taps[4]), weights);
+        }
+        _mm_storeu_ps(dst + x * 4, clampOutput ? clampUnit(acc) : acc);
+    }
+}
+
+ByteBuffer downscaleInternalBox(const ByteBuffer src, int w, int h)
+{
+    const float *srcPtr = src.ptrAsFloat();
+
+    if (w == 1 || h == 1)
+    {
+        int dstCount = (w * h) / 2;
+        ByteBuffer tmpData(dstCount * 4 * sizeof(float));
+        float *ptr = tmpData.ptrAsFloat();
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (int x = 0; x < dstCount; x++)
+        {
+            __m128 sum = _mm_add_ps(_mm_loadu_ps(srcPtr + x * 8), _mm_loadu_ps(srcPtr + x * 8 + 4));
+            _mm_storeu_ps(ptr + x * 4, _mm_mul_ps(sum, half));
+        }
+        return tmpData;
+    }
+
+    int dstW = w / 2;
+    int dstH = h / 2;
+    ByteBuffer tmpData(dstW * dstH * 4 * sizeof(float));
+    float *ptr = tmpData.ptrAsFloat();
+    int pitch = w * 4;
+    #pragma omp parallel for if (dstW * dstH >= ParallelMinPixels)
+    for (int y = 0; y < dstH; y++)
+    {
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        const float *row0 = srcPtr + y * 2 * pitch;
+        const float *row1 = row0 + pitch;
+        float *dstRow = ptr + y * dstW * 4;
+        for (int x = 0; x < dstW; x++)
+        {
+            __m128 sum = _mm_add_ps(_mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row0 + x * 8 + 4));
+            sum = _mm_add_ps(sum, _mm_loadu_ps(row1 + x * 8));
+            sum = _mm_add_ps(sum, _mm_loadu_ps(row1 + x * 8 + 4));
+            _mm_storeu_ps(dstRow + x * 4, _mm_mul_ps(sum, quarter));
+        }
+    }
+    return tmpData;
+}
+
+// Separable filter: source rows are decimated into a small ring which stays in cache,
+// columns of the ring are then filtered into output rows
+ByteBuffer downscaleInternalFiltered(const ByteBuffer src, int w, int h, Image::MipFilter filter)
+{
+    MipFilterKernel kernel = makeMipFilterKernel(filter);
+    const float *srcPtr = src.ptrAsFloat();
+
+    if (w == 1 || h == 1)
+    {
+        int dstCount = (w * h) / 2;
+        ByteBuffer tmpData(dstCount * 4 * sizeof(float));
+        filterLineHorizontal(srcPtr, tmpData.ptrAsFloat(), w * h, dstCount, kernel, true);
+        return tmpData;
+    }
+
+    int dstW = w / 2;
+    int dstH = h / 2;
+    ByteBuffer tmpData(dstW * dstH * 4 * sizeof(float));
+    float *ptr = tmpData.ptrAsFloat();
+    #pragma omp parallel if (dstW * dstH >= ParallelMinPixels)
+    {
+        __m128 weights[MipFilterTaps / 2];
+        for (int t = 0; t < MipFilterTaps / 2; t++)
+            weights[t] = _mm_set1_ps(kernel.weights[t]);
+        ByteBuffer ringData(MipFilterTaps * dstW * 4 * sizeof(float));
+        float *ring = ringData.ptrAsFloat();
+        int ringRows[MipFilterTaps];
+        for (int t = 0; t < MipFilterTaps; t++)
+            ringRows[t] = -1;
+
+        #pragma omp for schedule(static)
+        for (int y = 0; y < dstH; y++)
+        {
+            const float *rows[MipFilterTaps];
+            for (int t = 0; t < MipFilterTaps; t++)
+            {
+                int srcRow = qBound(0, 2 * y + kernel.firstTap + t, h - 1);
+                int slot = srcRow % MipFilterTaps;
+                if (ringRows[slot] != srcRow)
+                {
+                    filterLineHorizontal(srcPtr + srcRow * w * 4, ring + slot * dstW * 4, w, dstW, kernel, false);
+                    ringRows[slot] = srcRow;
+                }
+                rows[t] = ring + slot * dstW * 4;
+            }
+            float *dstRow = ptr + y * dstW * 4;
+            for (int x = 0; x < dstW * 4; x += 4)
+            {
+                __m128 acc = filterPairs(_mm_add_ps(_mm_loadu_ps(rows[0] + x), _mm_loadu_ps(rows[7] + x)),
+                                         _mm_add_ps(_mm_loadu_ps(rows[1] + x), _mm_loadu_ps(rows[6] + x)),
+                                         _mm_add_ps(_mm_loadu_ps(rows[2] + x), _mm_loadu_ps(rows[5] + x)),
+                                         _mm_add_ps(_mm_loadu_ps(rows[3] + x), _mm_loadu_ps(rows[4] + x)),
+                                         weights);
+                _mm_storeu_ps(dstRow + x, clampUnit(acc));
+            }
+        }
+        ringData.Free();
+    }
+    return tmpData;
+}
+
+} // namespace
+
+// Mips of 8-bit sources are downscaled in float too, each level comes from unrounded
+// previous level so rounding does not accumulate down the chain
+ByteBuffer Image::downscaleInternal(const ByteBuffer src, int w, int h)
+{
+    if (w == 1 && h == 1)
+        CRASH_MSG("1x1 can not be downscaled");
+
+    if (mipFilter == MipFilter::Box)
+        return downscaleInternalBox(src, w, h);
+
+    return downscaleInternalFiltered(src, w, h, mipFilter);
+}
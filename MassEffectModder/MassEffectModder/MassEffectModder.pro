@@ -34,14 +34,19 @@ SOURCES += \
     Helpers/Logs.cpp \
     Helpers/MemoryStream.cpp \
     Helpers/MiscHelpers.cpp \
+    Helpers/PackagePrefetcher.cpp \
     Helpers/Stream.cpp \
     Image/Image.cpp \
     Image/ImageBMP.cpp \
     Image/ImageDDS.cpp \
+    Image/ImageScale.cpp \
     Image/ImageTGA.cpp \
     Md5/MD5BadEntries.cpp \
     Md5/MD5ModEntries.cpp \
     MipMaps/MipMap.cpp \
+    MipMaps/MipMapsCache.cpp \
+    MipMaps/MipMapsJournal.cpp \
+    MipMaps/MipMapsPlan.cpp \
     MipMaps/MipMapsReplace.cpp \
     Misc/Misc.cpp \
     Misc/MiscCheckGame.cpp \
@@ -49,6 +54,7 @@ SOURCES += \
     Misc/MiscModsInstall.cpp \
     Misc/MiscProcessGame.cpp \
     Misc/MiscTexture.cpp \
+    Misc/ModConvertCache.cpp \
     Program/ConfigIni.cpp \
     Program/Main.cpp \
     Program/SignalHandler.cpp \
@@ -76,6 +82,7 @@ SOURCES += \
 SOURCES += \
     CmdLine/CmdLineHelp.cpp \
     CmdLine/CmdLineParams.cpp \
+    CmdLine/CmdLineServer.cpp \
     CmdLine/CmdLineTools.cpp
 }
 
@@ -95,6 +102,7 @@ HEADERS += \
     Helpers/Logs.h \
     Helpers/MemoryStream.h \
     Helpers/MiscHelpers.h \
+    Helpers/PackagePrefetcher.h \
     Helpers/QSort.h \
     Helpers/Stream.h \
     Image/Image.h \
@@ -102,7 +110,10 @@ HEADERS += \
     Md5/MD5ModEntries.h \
     Misc/CommonStrings.h \
     Misc/Misc.h \
+    Misc/ModConvertCache.h \
     MipMaps/MipMap.h \
+    MipMaps/MipMapsCache.h \
+    MipMaps/MipMapsJournal.h \
     MipMaps/MipMaps.h \
     Program/ConfigIni.h \
     Program/SignalHandler.h \
@@ -127,6 +138,7 @@ HEADERS += \
 } else {
 HEADERS += \
     CmdLine/CmdLineParams.h \
+    CmdLine/CmdLineServer.h \
     CmdLine/CmdLineTools.h
 }
 
@@ -26,17 +26,7 @@ MipMap::MipMap(int w, int h, PixelFormat format)
     width = origWidth = w;
     height = origHeight = h;
 
-    if (format == PixelFormat::DXT1 ||
-        format == PixelFormat::DXT3 ||
-        format == PixelFormat::DXT5 ||
-        format == PixelFormat::BC5 ||
-        format == PixelFormat::BC7)
-    {
-        if (width < 4)
-            width = 4;
-        if (height < 4)
-            height = 4;
-    }
+    alignToBlockSize(width, height, format);
 
     buffer = ByteBuffer(getBufferSize(width, height, format));
     memset(buffer.ptr(), 0, buffer.size());
@@ -47,17 +37,7 @@ MipMap::MipMap(const ByteBuffer &src, int w, int h, PixelFormat format, bool ski
     width = origWidth = w;
     height = origHeight = h;
 
-    if (format == PixelFormat::DXT1 ||
-        format == PixelFormat::DXT3 ||
-        format == PixelFormat::DXT5 ||
-        format == PixelFormat::BC5 ||
-        format == PixelFormat::BC7)
-    {
-        if (width < 4)
-            width = 4;
-        if (height < 4)
-            height = 4;
-    }
+    alignToBlockSize(width, height, format);
 
     if (!skipCheck)
     {
@@ -68,6 +48,61 @@ MipMap::MipMap(const ByteBuffer &src, int w, int h, PixelFormat format, bool ski
     buffer = ByteBuffer(src.ptr(), src.size());
 }
 
+MipMap::MipMap(const std::shared_ptr<const void> &owner, const ByteBuffer &view, int w, int h, PixelFormat format)
+{
+    width = origWidth = w;
+    height = origHeight = h;
+
+    alignToBlockSize(width, height, format);
+
+    if (view.size() != getBufferSize(width, height, format))
+        CRASH_MSG("Data size of texture is not valid.");
+
+    buffer = view;
+    viewOwner = owner;
+}
+
+void MipMap::Free()
+{
+    buffer.Free();
+    viewOwner.reset();
+}
+
+std::shared_ptr<const void> MipMap::shareBuffer(const ByteBuffer &data)
+{
+    auto owned = new ByteBuffer(data);
+    return std::shared_ptr<const void>(owned, [](ByteBuffer *buffer)
+    {
+        buffer->Free();
+        delete buffer;
+    });
+}
+
+ByteBuffer& MipMap::getWritableData()
+{
+    if (viewOwner)
+    {
+        buffer = ByteBuffer(buffer.ptr(), buffer.size());
+        viewOwner.reset();
+    }
+    return buffer;
+}
+
+void MipMap::alignToBlockSize(int &w, int &h, PixelFormat format)
+{
+    if (format == PixelFormat::DXT1 ||
+        format == PixelFormat::DXT3 ||
+        format == PixelFormat::DXT5 ||
+        format == PixelFormat::BC5 ||
+        format == PixelFormat::BC7)
+    {
+        if (w < 4)
+            w = 4;
+        if (h < 4)
+            h = 4;
+    }
+}
+
 int MipMap::getBufferSize(int w, int h, PixelFormat format)
 {
     switch (format)
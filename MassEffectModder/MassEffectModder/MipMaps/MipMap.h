@@ -30,6 +30,7 @@ class MipMap
 private:
 
     ByteBuffer buffer;
+    std::shared_ptr<const void> viewOwner; // set when buffer points into shared source data
     int width;
     int height;
     int origWidth;
@@ -39,9 +40,14 @@ public:
 
     MipMap(int w, int h, PixelFormat format);
     MipMap(const ByteBuffer &data, int w, int h, PixelFormat format, bool skipCheck = false);
-    void Free() { buffer.Free(); }
+    MipMap(const std::shared_ptr<const void> &owner, const ByteBuffer &view, int w, int h, PixelFormat format);
+    void Free();
+    static std::shared_ptr<const void> shareBuffer(const ByteBuffer &data);
     static int getBufferSize(int w, int h, PixelFormat format);
-    ByteBuffer& getRefData() { return buffer; }
+    static void alignToBlockSize(int &w, int &h, PixelFormat format);
+    const ByteBuffer& getRefData() const { return buffer; }
+    ByteBuffer& getWritableData();
+    bool isView() const { return viewOwner != nullptr; }
     int getWidth() { return width; }
     int getHeight() { return height; }
     int getOrigWidth() { return origWidth; }
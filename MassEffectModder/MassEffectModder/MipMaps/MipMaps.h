@@ -105,6 +105,16 @@ struct MapPackagesToMod
     long weight;
 };
 
+struct ModsInstallPlan
+{
+    QList<MapPackagesToMod> packages;
+    QList<int> missingMods;
+    int overriddenMods;
+    int exports;
+};
+
+class MipMapsJournal;
+
 class MipMaps
 {
 public:
@@ -120,11 +130,16 @@ public:
                             QList<ModEntry> &modsToReplace,
                             bool appendMarker, bool verify,
                             int cacheAmount,
-                            ProgressCallback callback, void *callbackHandle);
+                            ProgressCallback callback, void *callbackHandle,
+                            MipMapsJournal *journal = nullptr);
+    void planModsFromList(QList<TextureMapEntry> &textures, QList<ModEntry> &modsToReplace,
+                          ModsInstallPlan &plan);
     QString replaceModsFromList(QList<TextureMapEntry> &textures, QStringList &pkgsToMarker,
                                 QList<ModEntry> &modsToReplace,
                                 bool appendMarker, bool verify, int cacheAmount,
-                                ProgressCallback callback, void *callbackHandle);
+                                ProgressCallback callback, void *callbackHandle,
+                                MipMapsJournal *journal = nullptr);
+    static quint64 GetCacheLimit(int cacheAmount, int &memoryAmount);
     static void RemoveLowerMips(Image *image);
 };
 
@@ -0,0 +1,184 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include <MipMaps/MipMapsCache.h>
+#include <Helpers/MiscHelpers.h>
+#include <Helpers/Logs.h>
+
+MipMapsCache::MipMapsCache(quint64 limit)
+    : cacheLimit(limit), cacheUsage(0), useCounter(0), scratchFile(nullptr),
+      hits(0), misses(0), spillHits(0), evictions(0)
+{
+    scratchPath = QDir::tempPath() + QString("/MEM_mipmaps_cache_%1.bin")
+            .arg(QCoreApplication::applicationPid());
+}
+
+MipMapsCache::~MipMapsCache()
+{
+    if (scratchFile)
+    {
+        delete scratchFile;
+        QFile(scratchPath).remove();
+    }
+}
+
+void MipMapsCache::FreeMipMaps(ModEntry &mod)
+{
+    foreach(MipMap mip, mod.cacheCprMipmaps)
+    {
+        mip.Free();
+    }
+    mod.cacheCprMipmaps.clear();
+    mod.cacheCprMipmapsDecompressedSize.clear();
+}
+
+void MipMapsCache::Spill(ModEntry &mod, int modIndex)
+{
+    if (spilledMods.contains(modIndex))
+        return;
+
+    if (scratchFile == nullptr)
+        scratchFile = new FileStream(scratchPath, FileMode::Create, FileAccess::ReadWrite);
+
+    QList<SpilledMipMap> mips;
+    scratchFile->SeekEnd();
+    for (int m = 0; m < mod.cacheCprMipmaps.count(); m++)
+    {
+        SpilledMipMap mip{};
+        mip.offset = scratchFile->Position();
+        mip.size = mod.cacheCprMipmaps[m].getRefData().size();
+        mip.origWidth = mod.cacheCprMipmaps[m].getOrigWidth();
+        mip.origHeight = mod.cacheCprMipmaps[m].getOrigHeight();
+        scratchFile->WriteFromBuffer(mod.cacheCprMipmaps[m].getRefData());
+        mips.push_back(mip);
+    }
+    spilledMods.insert(modIndex, mips);
+}
+
+void MipMapsCache::Evict(ModEntry &mod, int modIndex)
+{
+    Spill(mod, modIndex);
+    // Decompressed sizes are kept to restore spilled mips
+    QList<int> decompressedSize = mod.cacheCprMipmapsDecompressedSize;
+    FreeMipMaps(mod);
+    mod.cacheCprMipmapsDecompressedSize = decompressedSize;
+    cacheUsage -= mod.cacheSize;
+    residentMods.remove(modIndex);
+    evictions++;
+}
+
+bool MipMapsCache::Fetch(ModEntry &mod, int modIndex)
+{
+    if (mod.cacheCprMipmaps.count() != 0)
+    {
+        residentMods[modIndex] = ++useCounter;
+        hits++;
+        return true;
+    }
+
+    auto spilled = spilledMods.constFind(modIndex);
+    if (spilled == spilledMods.constEnd())
+    {
+        misses++;
+        return false;
+    }
+
+    mod.cacheSize = 0;
+    foreach (SpilledMipMap mip, spilled.value())
+    {
+        scratchFile->JumpTo(mip.offset);
+        ByteBuffer data = scratchFile->ReadToBuffer(mip.size);
+        mod.cacheCprMipmaps.push_back(MipMap(data, mip.origWidth, mip.origHeight,
+                                             mod.cachedPixelFormat, true));
+        mod.cacheSize += data.size();
+        data.Free();
+    }
+    cacheUsage += mod.cacheSize;
+    residentMods[modIndex] = ++useCounter;
+    spillHits++;
+    return true;
+}
+
+void MipMapsCache::Insert(ModEntry &mod, int modIndex)
+{
+    cacheUsage += mod.cacheSize;
+    residentMods[modIndex] = ++useCounter;
+}
+
+void MipMapsCache::Release(ModEntry &mod, int modIndex)
+{
+    if (residentMods.remove(modIndex) != 0)
+        cacheUsage -= mod.cacheSize;
+    FreeMipMaps(mod);
+    spilledMods.remove(modIndex);
+}
+
+void MipMapsCache::Trim(QList<ModEntry> &modsToReplace, ModEntry &currentMod, int currentModIndex)
+{
+    // Evict textures needed by less packages first, least recently used if equal
+    while (cacheUsage > cacheLimit)
+    {
+        int victim = -1;
+        for (auto it = residentMods.constBegin(); it != residentMods.constEnd(); it++)
+        {
+            if (it.key() == currentModIndex)
+                continue;
+            if (victim == -1)
+            {
+                victim = it.key();
+                continue;
+            }
+            const ModEntry &mod = modsToReplace[it.key()];
+            const ModEntry &victimMod = modsToReplace[victim];
+            if (mod.instance < victimMod.instance ||
+                (mod.instance == victimMod.instance && it.value() < residentMods.value(victim)))
+            {
+                victim = it.key();
+            }
+        }
+        if (victim == -1)
+            break;
+        Evict(modsToReplace[victim], victim);
+    }
+
+    if (cacheUsage > cacheLimit && residentMods.contains(currentModIndex))
+        Evict(currentMod, currentModIndex);
+}
+
+void MipMapsCache::ReportStats()
+{
+    if (g_ipc)
+    {
+        ConsoleWrite(QString("[IPC]CACHE_HITS ") + QString::number(hits));
+        ConsoleWrite(QString("[IPC]CACHE_SPILL_HITS ") + QString::number(spillHits));
+        ConsoleWrite(QString("[IPC]CACHE_MISSES ") + QString::number(misses));
+        ConsoleWrite(QString("[IPC]CACHE_EVICTIONS ") + QString::number(evictions));
+        ConsoleSync();
+    }
+    else
+    {
+        PINFO(QString("Cache hits: ") + QString::number(hits) +
+              ", from scratch file: " + QString::number(spillHits) +
+              ", misses: " + QString::number(misses) +
+              ", evictions: " + QString::number(evictions) + "\n");
+    }
+}
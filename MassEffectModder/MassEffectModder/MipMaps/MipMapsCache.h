@@ -0,0 +1,71 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef MIPMAPS_CACHE_H
+#define MIPMAPS_CACHE_H
+
+#include <MipMaps/MipMaps.h>
+#include <Helpers/FileStream.h>
+
+class MipMapsCache
+{
+private:
+
+    struct SpilledMipMap
+    {
+        qint64 offset;
+        qint64 size;
+        int origWidth;
+        int origHeight;
+    };
+
+    quint64 cacheLimit;
+    quint64 cacheUsage;
+    quint64 useCounter;
+    QHash<int, quint64> residentMods;
+    QHash<int, QList<SpilledMipMap>> spilledMods;
+    QString scratchPath;
+    FileStream *scratchFile;
+
+    quint64 hits;
+    quint64 misses;
+    quint64 spillHits;
+    quint64 evictions;
+
+    void FreeMipMaps(ModEntry &mod);
+    void Spill(ModEntry &mod, int modIndex);
+    void Evict(ModEntry &mod, int modIndex);
+
+public:
+
+    MipMapsCache(quint64 limit);
+    ~MipMapsCache();
+
+    bool Fetch(ModEntry &mod, int modIndex);
+    void Insert(ModEntry &mod, int modIndex);
+    void Release(ModEntry &mod, int modIndex);
+    void Trim(QList<ModEntry> &modsToReplace, ModEntry &currentMod, int currentModIndex);
+    quint64 Usage() { return cacheUsage; }
+    void ReportStats();
+};
+
+#endif
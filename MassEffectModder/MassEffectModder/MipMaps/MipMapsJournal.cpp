@@ -0,0 +1,499 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <MipMaps/MipMapsJournal.h>
+#include <GameData/GameData.h>
+#include <GameData/Package.h>
+#include <Helpers/MiscHelpers.h>
+#include <Helpers/Logs.h>
+
+namespace {
+
+void WriteString(Stream &stream, const QString &str)
+{
+    stream.WriteInt32(str.length());
+    stream.WriteStringASCII(str);
+}
+
+QString ReadString(Stream &stream)
+{
+    QString str;
+    stream.ReadStringASCII(str, stream.ReadInt32());
+    return str;
+}
+
+} // namespace
+
+MipMapsJournal::MipMapsJournal()
+    : journalFile(nullptr)
+{
+}
+
+MipMapsJournal::~MipMapsJournal()
+{
+    delete journalFile;
+}
+
+QString MipMapsJournal::JournalPath(MeType gameId)
+{
+    QString path = QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation).first() +
+            "/MassEffectModder";
+    return path + QString("/mele%1install.journal").arg((int)gameId);
+}
+
+QByteArray MipMapsJournal::ModsSignature(MeType gameId, const QStringList &modFiles)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QByteArray::number((int)gameId));
+    foreach (const QString &file, modFiles)
+    {
+        QFileInfo info(file);
+        hash.addData(info.absoluteFilePath().toUtf8());
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+    return hash.result();
+}
+
+void MipMapsJournal::ReportError(const QString &message)
+{
+    if (g_ipc)
+    {
+        ConsoleWrite(QString("[IPC]ERROR ") + message);
+        ConsoleSync();
+    }
+    else
+    {
+        PERROR(QString("Error: ") + message + "\n");
+    }
+}
+
+QHash<QString, qint64> MipMapsJournal::CollectTfcSizes()
+{
+    // Texture data is appended only to TFC files created by MEM
+    QHash<QString, qint64> sizes;
+    QFileInfoList list = QDir(g_GameData->MainData()).entryInfoList(QStringList("TexturesMEM*.tfc"),
+                                                                    QDir::Files);
+    foreach (const QFileInfo &info, list)
+        sizes.insert(info.fileName(), info.size());
+    return sizes;
+}
+
+void MipMapsJournal::WriteTfcSizes(Stream &stream, const QHash<QString, qint64> &sizes)
+{
+    stream.WriteInt32(sizes.count());
+    for (auto it = sizes.constBegin(); it != sizes.constEnd(); it++)
+    {
+        WriteString(stream, it.key());
+        stream.WriteInt64(it.value());
+    }
+}
+
+void MipMapsJournal::ReadTfcSizes(Stream &stream, QHash<QString, qint64> &sizes)
+{
+    sizes.clear();
+    int count = stream.ReadInt32();
+    for (int i = 0; i < count; i++)
+    {
+        QString name = ReadString(stream);
+        sizes.insert(name, stream.ReadInt64());
+    }
+}
+
+void MipMapsJournal::WriteRecord(RecordType type, MemoryStream &record)
+{
+    if (journalFile == nullptr)
+        return;
+
+    journalFile->WriteUInt32(type);
+    journalFile->WriteUInt32(record.Length());
+    record.SeekBegin();
+    journalFile->CopyFrom(record, record.Length());
+    // Record must be on disk before the change it guards starts
+    journalFile->Sync();
+}
+
+bool MipMapsJournal::Create(MeType gameId, const QStringList &modFiles, bool modded)
+{
+    journalPath = JournalPath(gameId);
+    QDir().mkpath(DirName(journalPath));
+    delete journalFile;
+    journalFile = new FileStream(journalPath, FileMode::Create, FileAccess::WriteOnly);
+    journalFile->WriteUInt32(JOURNAL_TAG);
+    journalFile->WriteUInt32(JOURNAL_VERSION);
+    journalFile->WriteUInt32(gameId);
+    QByteArray signature = ModsSignature(gameId, modFiles);
+    journalFile->WriteFromBuffer(reinterpret_cast<quint8 *>(signature.data()), signature.size());
+    journalFile->WriteByte(modded ? 1 : 0);
+
+    completedPackages.clear();
+    arcEntries.clear();
+    completedCrcs.clear();
+    pendingPackage = "";
+    tfcSizes = CollectTfcSizes();
+    MemoryStream record;
+    WriteTfcSizes(record, tfcSizes);
+    WriteRecord(RecordBaseline, record);
+
+    return true;
+}
+
+bool MipMapsJournal::Load(MeType gameId, const QStringList &modFiles, bool &modded)
+{
+    QByteArray signature = ModsSignature(gameId, modFiles);
+    FileStream fs = FileStream(journalPath, FileMode::Open, FileAccess::ReadOnly);
+    if (fs.Length() < 12 + signature.size() + 1 ||
+        fs.ReadUInt32() != JOURNAL_TAG ||
+        fs.ReadUInt32() != JOURNAL_VERSION)
+    {
+        ReportError("Installation checkpoint file is damaged, resume not possible.");
+        return false;
+    }
+    bool sameGame = fs.ReadUInt32() == (quint32)gameId;
+    ByteBuffer storedSignature = fs.ReadToBuffer(signature.size());
+    bool sameMods = memcmp(storedSignature.ptr(), signature.constData(), signature.size()) == 0;
+    storedSignature.Free();
+    if (!sameGame || !sameMods)
+    {
+        ReportError("Installation checkpoint was made for different game or mods, resume not possible.");
+        return false;
+    }
+    modded = fs.ReadByte() != 0;
+
+    // Records are replayed up to the last complete one, a torn tail is dropped
+    QHash<int, ArcEntry> pendingArcs;
+    qint64 validEnd = fs.Position();
+    bool baseline = false;
+    while (fs.Position() + 8 <= fs.Length())
+    {
+        quint32 type = fs.ReadUInt32();
+        quint32 size = fs.ReadUInt32();
+        if (fs.Position() + size > fs.Length())
+            break;
+        ByteBuffer buffer = fs.ReadToBuffer(size);
+        MemoryStream record(buffer);
+        buffer.Free();
+        switch (type)
+        {
+        case RecordBaseline:
+            ReadTfcSizes(record, tfcSizes);
+            baseline = true;
+            break;
+        case RecordBegin:
+        {
+            pendingPackage = ReadString(record);
+            ReadTfcSizes(record, tfcSizes);
+            pendingArcs.clear();
+            int count = record.ReadInt32();
+            for (int i = 0; i < count; i++)
+            {
+                ArcEntry arc;
+                int modIndex = record.ReadInt32();
+                arc.tfcName = ReadString(record);
+                record.ReadToBuffer(arc.tfcGuid, 16);
+                arc.tfcDLC = record.ReadByte() != 0;
+                int mipsCount = record.ReadInt32();
+                for (int m = 0; m < mipsCount; m++)
+                {
+                    Texture::TextureMipMap mipmap;
+                    mipmap.storageType = (StorageTypes)record.ReadInt32();
+                    mipmap.uncompressedSize = record.ReadInt32();
+                    mipmap.compressedSize = record.ReadInt32();
+                    mipmap.dataOffset = record.ReadUInt32();
+                    mipmap.internalOffset = record.ReadUInt32();
+                    mipmap.width = record.ReadInt32();
+                    mipmap.height = record.ReadInt32();
+                    arc.mipmaps.append(mipmap);
+                }
+                pendingArcs.insert(modIndex, arc);
+            }
+            break;
+        }
+        case RecordDone:
+        {
+            QString packagePath = ReadString(record);
+            qint64 packageSize = record.ReadInt64();
+            completedPackages.insert(packagePath, packageSize);
+            QList<CrcEntry> crcEntries;
+            int count = record.ReadInt32();
+            for (int i = 0; i < count; i++)
+            {
+                CrcEntry entry;
+                entry.texturesIndex = record.ReadInt32();
+                entry.listIndex = record.ReadInt32();
+                entry.exportID = record.ReadInt32();
+                int crcsCount = record.ReadInt32();
+                for (int m = 0; m < crcsCount; m++)
+                    entry.crcs.append(record.ReadUInt32());
+                crcEntries.append(entry);
+            }
+            completedCrcs.insert(packagePath, crcEntries);
+            if (packagePath == pendingPackage)
+            {
+                for (auto it = pendingArcs.constBegin(); it != pendingArcs.constEnd(); it++)
+                    arcEntries.insert(it.key(), it.value());
+                pendingArcs.clear();
+                pendingPackage = "";
+            }
+            break;
+        }
+        default:
+            ReportError("Installation checkpoint file is damaged, resume not possible.");
+            return false;
+        }
+        validEnd = fs.Position();
+    }
+    fs.Close();
+
+    if (!baseline)
+    {
+        ReportError("Installation checkpoint file is damaged, resume not possible.");
+        return false;
+    }
+    QFile(journalPath).resize(validEnd);
+
+    return true;
+}
+
+bool MipMapsJournal::Validate()
+{
+    for (auto it = completedPackages.constBegin(); it != completedPackages.constEnd(); it++)
+    {
+        QFileInfo info(g_GameData->GamePath() + it.key());
+        if (!info.exists() || info.size() != it.value())
+        {
+            ReportError(QString("Package changed after it was installed: ") + it.key() +
+                        ", resume not possible.");
+            return false;
+        }
+    }
+
+    // Package is saved aside and moved over the original when complete,
+    // so the interrupted one is still the old file, only the partial copy is dropped
+    if (pendingPackage.length() != 0)
+    {
+        QString tempPath = Package::SaveTempPath(g_GameData->GamePath() + pendingPackage);
+        if (QFile::exists(tempPath))
+        {
+            PINFO(QString("Removing partially saved package: ") + pendingPackage + "\n");
+            QFile(tempPath).remove();
+        }
+        Package package{};
+        if (package.Open(g_GameData->GamePath() + pendingPackage) != 0)
+        {
+            ReportError(QString("Package damaged by interrupted installation: ") + pendingPackage +
+                        ", restore game data before installing again.");
+            return false;
+        }
+    }
+
+    QHash<QString, qint64> currentSizes = CollectTfcSizes();
+    for (auto it = tfcSizes.constBegin(); it != tfcSizes.constEnd(); it++)
+    {
+        if (currentSizes.value(it.key(), -1) < it.value())
+        {
+            ReportError(QString("TFC file is shorter than recorded in installation checkpoint: ") +
+                        it.key() + ", resume not possible.");
+            return false;
+        }
+    }
+
+    // Data appended after last checkpoint is not referenced by any saved package
+    for (auto it = currentSizes.constBegin(); it != currentSizes.constEnd(); it++)
+    {
+        QString tfcPath = g_GameData->MainData() + "/" + it.key();
+        if (!tfcSizes.contains(it.key()))
+        {
+            PINFO(QString("Removing TFC file not covered by checkpoint: ") + it.key() + "\n");
+            QFile(tfcPath).remove();
+            g_GameData->InvalidateInventoryFile(tfcPath);
+        }
+        else if (it.value() > tfcSizes[it.key()])
+        {
+            PINFO(QString("Truncating TFC file to checkpoint: ") + it.key() + "\n");
+            QFile(tfcPath).resize(tfcSizes[it.key()]);
+            g_GameData->InvalidateInventoryFile(tfcPath);
+        }
+    }
+
+    return true;
+}
+
+bool MipMapsJournal::Resume(MeType gameId, const QStringList &modFiles, bool &modded)
+{
+    journalPath = JournalPath(gameId);
+    if (!QFile::exists(journalPath))
+    {
+        ReportError("No interrupted installation to resume.");
+        return false;
+    }
+    if (!Load(gameId, modFiles, modded) || !Validate())
+        return false;
+
+    delete journalFile;
+    journalFile = new FileStream(journalPath, FileMode::Open, FileAccess::ReadWrite);
+    journalFile->SeekEnd();
+
+    PINFO(QString("Resuming installation, packages already installed: ") +
+          QString::number(completedPackages.count()) + "\n");
+
+    return true;
+}
+
+bool MipMapsJournal::IsCompleted(const QString &packagePath)
+{
+    return completedPackages.contains(packagePath);
+}
+
+bool MipMapsJournal::RestoreArc(ModEntry &mod, int modIndex)
+{
+    if (mod.arcTexture.count() != 0 || !arcEntries.contains(modIndex))
+        return false;
+
+    const ArcEntry &arc = arcEntries[modIndex];
+    mod.arcTfcName = arc.tfcName;
+    memcpy(mod.arcTfcGuid, arc.tfcGuid, 16);
+    mod.arcTfcDLC = arc.tfcDLC;
+    mod.CopyMipMapsList(mod.arcTexture, arc.mipmaps);
+    return true;
+}
+
+// Verification CRCs of textures installed before interruption, false if some are missing
+bool MipMapsJournal::RestoreCrcs(const MapPackagesToMod &package, QList<TextureMapEntry> &textures)
+{
+    const QList<CrcEntry> crcEntries = completedCrcs.value(package.packagePath);
+    bool complete = true;
+    foreach (const MapPackagesToModEntry &entryMap, package.textures)
+    {
+        bool found = false;
+        foreach (const CrcEntry &entry, crcEntries)
+        {
+            if (entry.texturesIndex == entryMap.texturesIndex && entry.listIndex == entryMap.listIndex)
+            {
+                if (entry.texturesIndex < textures.count() &&
+                    entry.listIndex < textures[entry.texturesIndex].list.count() &&
+                    textures[entry.texturesIndex].list[entry.listIndex].exportID == entry.exportID)
+                {
+                    textures[entry.texturesIndex].list[entry.listIndex].crcs = entry.crcs;
+                    found = entry.crcs.count() != 0;
+                }
+                break;
+            }
+        }
+        if (!found)
+            complete = false;
+    }
+    return complete;
+}
+
+void MipMapsJournal::BeginPackage(const QString &packagePath, const QList<ModEntry> &modsToReplace,
+                                  const QList<int> &arcMods)
+{
+    if (journalFile == nullptr)
+        return;
+
+    pendingPackage = packagePath;
+    tfcSizes = CollectTfcSizes();
+
+    MemoryStream record;
+    WriteString(record, packagePath);
+    WriteTfcSizes(record, tfcSizes);
+    QList<int> validArcs;
+    foreach (int modIndex, arcMods)
+    {
+        if (modsToReplace[modIndex].arcTexture.count() != 0 && !validArcs.contains(modIndex))
+            validArcs.append(modIndex);
+    }
+    record.WriteInt32(validArcs.count());
+    foreach (int modIndex, validArcs)
+    {
+        const ModEntry &mod = modsToReplace[modIndex];
+        record.WriteInt32(modIndex);
+        WriteString(record, mod.arcTfcName);
+        record.WriteFromBuffer(const_cast<quint8 *>(mod.arcTfcGuid), 16);
+        record.WriteByte(mod.arcTfcDLC ? 1 : 0);
+        record.WriteInt32(mod.arcTexture.count());
+        foreach (const Texture::TextureMipMap &mipmap, mod.arcTexture)
+        {
+            record.WriteInt32(mipmap.storageType);
+            record.WriteInt32(mipmap.uncompressedSize);
+            record.WriteInt32(mipmap.compressedSize);
+            record.WriteUInt32(mipmap.dataOffset);
+            record.WriteUInt32(mipmap.internalOffset);
+            record.WriteInt32(mipmap.width);
+            record.WriteInt32(mipmap.height);
+        }
+    }
+    WriteRecord(RecordBegin, record);
+}
+
+void MipMapsJournal::CompletePackage(const MapPackagesToMod &package, const QList<TextureMapEntry> &textures)
+{
+    if (journalFile == nullptr)
+        return;
+
+    const QString &packagePath = package.packagePath;
+    qint64 packageSize = QFileInfo(g_GameData->GamePath() + packagePath).size();
+    MemoryStream record;
+    WriteString(record, packagePath);
+    record.WriteInt64(packageSize);
+
+    // Final CRCs of replaced textures, a texture replaced several times is stored once
+    QList<CrcEntry> crcEntries;
+    foreach (const MapPackagesToModEntry &entryMap, package.textures)
+    {
+        bool duplicate = false;
+        foreach (const CrcEntry &entry, crcEntries)
+        {
+            if (entry.texturesIndex == entryMap.texturesIndex && entry.listIndex == entryMap.listIndex)
+            {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate)
+            continue;
+        const TextureMapPackageEntry &matched = textures[entryMap.texturesIndex].list[entryMap.listIndex];
+        crcEntries.append(CrcEntry{ entryMap.texturesIndex, entryMap.listIndex, matched.exportID, matched.crcs });
+    }
+    record.WriteInt32(crcEntries.count());
+    foreach (const CrcEntry &entry, crcEntries)
+    {
+        record.WriteInt32(entry.texturesIndex);
+        record.WriteInt32(entry.listIndex);
+        record.WriteInt32(entry.exportID);
+        record.WriteInt32(entry.crcs.count());
+        foreach (uint crc, entry.crcs)
+            record.WriteUInt32(crc);
+    }
+    WriteRecord(RecordDone, record);
+    completedPackages.insert(packagePath, packageSize);
+    completedCrcs.insert(packagePath, crcEntries);
+    pendingPackage = "";
+}
+
+void MipMapsJournal::Remove()
+{
+    delete journalFile;
+    journalFile = nullptr;
+    if (journalPath.length() != 0)
+        QFile(journalPath).remove();
+}
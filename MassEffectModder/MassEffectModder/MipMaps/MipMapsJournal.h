@@ -0,0 +1,94 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef MIPMAPS_JOURNAL_H
+#define MIPMAPS_JOURNAL_H
+
+#include <MipMaps/MipMaps.h>
+#include <Helpers/FileStream.h>
+#include <Helpers/MemoryStream.h>
+
+#define JOURNAL_TAG     0x4A4D454D // 'MEMJ'
+#define JOURNAL_VERSION 2
+
+// Checkpoints of texture installation, one record per finished package
+class MipMapsJournal
+{
+private:
+
+    enum RecordType
+    {
+        RecordBaseline = 0,
+        RecordBegin,
+        RecordDone
+    };
+
+    struct ArcEntry
+    {
+        QString tfcName;
+        quint8 tfcGuid[16];
+        bool tfcDLC;
+        QList<Texture::TextureMipMap> mipmaps;
+    };
+
+    struct CrcEntry
+    {
+        int texturesIndex;
+        int listIndex;
+        int exportID;
+        QList<uint> crcs;
+    };
+
+    QString journalPath;
+    FileStream *journalFile;
+    QHash<QString, qint64> completedPackages;
+    QHash<int, ArcEntry> arcEntries;
+    QHash<QString, QList<CrcEntry>> completedCrcs;
+    QHash<QString, qint64> tfcSizes;
+    QString pendingPackage;
+
+    static QString JournalPath(MeType gameId);
+    static QByteArray ModsSignature(MeType gameId, const QStringList &modFiles);
+    static void ReportError(const QString &message);
+    static QHash<QString, qint64> CollectTfcSizes();
+    static void WriteTfcSizes(Stream &stream, const QHash<QString, qint64> &sizes);
+    static void ReadTfcSizes(Stream &stream, QHash<QString, qint64> &sizes);
+    void WriteRecord(RecordType type, MemoryStream &record);
+    bool Load(MeType gameId, const QStringList &modFiles, bool &modded);
+    bool Validate();
+
+public:
+
+    MipMapsJournal();
+    ~MipMapsJournal();
+
+    bool Create(MeType gameId, const QStringList &modFiles, bool modded);
+    bool Resume(MeType gameId, const QStringList &modFiles, bool &modded);
+    bool IsCompleted(const QString &packagePath);
+    bool RestoreArc(ModEntry &mod, int modIndex);
+    bool RestoreCrcs(const MapPackagesToMod &package, QList<TextureMapEntry> &textures);
+    void BeginPackage(const QString &packagePath, const QList<ModEntry> &modsToReplace,
+                      const QList<int> &arcMods);
+    void CompletePackage(const MapPackagesToMod &package, const QList<TextureMapEntry> &textures);
+    void Remove();
+};
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include <MipMaps/MipMaps.h>
+#include <Helpers/MiscHelpers.h>
+#include <Helpers/Logs.h>
+#include <Helpers/QSort.h>
+
+namespace {
+
+int comparePaths(const MapTexturesToMod &e1, const MapTexturesToMod &e2)
+{
+    int compResult = AsciiStringCompareCaseIgnore(e1.packagePath, e2.packagePath);
+    if (compResult < 0)
+        return -1;
+    if (compResult > 0)
+        return 1;
+    if (e1.texturesIndex < e2.texturesIndex)
+        return -1;
+    if (e1.texturesIndex > e2.texturesIndex)
+        return 1;
+    if (e1.listIndex < e2.listIndex)
+        return -1;
+    if (e1.listIndex > e2.listIndex)
+        return 1;
+    return 0;
+}
+
+} // namespace
+
+void MipMaps::planModsFromList(QList<TextureMapEntry> &textures, QList<ModEntry> &modsToReplace,
+                               ModsInstallPlan &plan)
+{
+    plan.packages.clear();
+    plan.missingMods.clear();
+    plan.overriddenMods = 0;
+    plan.exports = 0;
+
+    // Remove blank textures and overridden entries, last mod wins
+    QHash<uint, int> modsByCrc;
+    QVector<bool> skipMod(modsToReplace.count(), false);
+    for (int i = 0; i < modsToReplace.count(); i++)
+    {
+        const ModEntry &mod = modsToReplace[i];
+        // Filter replacing blank textures
+        if (TreeScan::IsBlankTexture(mod.textureCrc))
+        {
+            skipMod[i] = true;
+            continue;
+        }
+        if (mod.textureCrc == 0)
+            continue;
+
+        auto previous = modsByCrc.find(mod.textureCrc);
+        if (previous != modsByCrc.end())
+        {
+            if (g_ipc)
+            {
+                ConsoleWrite(QString("[IPC]MOD_OVERRIDE ") + mod.textureName +
+                             QString::asprintf("_0x%08X", mod.textureCrc) + ", " + mod.memPath);
+                ConsoleSync();
+            }
+            else
+            {
+                PINFO(QString("Override texture: ") + mod.textureName +
+                      QString::asprintf("_0x%08X", mod.textureCrc) + ", " + mod.memPath + "\n");
+            }
+            skipMod[previous.value()] = true;
+            plan.overriddenMods++;
+            previous.value() = i;
+        }
+        else
+        {
+            modsByCrc.insert(mod.textureCrc, i);
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < modsToReplace.count(); i++)
+    {
+        if (skipMod[i])
+            continue;
+        if (count != i)
+            modsToReplace[count] = modsToReplace[i];
+        count++;
+    }
+    while (modsToReplace.count() > count)
+        modsToReplace.removeLast();
+
+    modsByCrc.clear();
+    for (int i = 0; i < modsToReplace.count(); i++)
+    {
+        if (modsToReplace[i].textureCrc != 0)
+            modsByCrc.insert(modsToReplace[i].textureCrc, i);
+    }
+
+    // Map textures to mods, one pass over textures map
+    QList<MapTexturesToMod> map = QList<MapTexturesToMod>();
+    QVector<bool> matchedMod(modsToReplace.count(), false);
+    for (int k = 0; k < textures.count(); k++)
+    {
+        auto found = modsByCrc.constFind(textures[k].crc);
+        if (found == modsByCrc.constEnd())
+            continue;
+        int index = found.value();
+        matchedMod[index] = true;
+
+        for (int t = 0; t < textures[k].list.count(); t++)
+        {
+            if (textures[k].list[t].path.length() == 0)
+                continue;
+
+            MapTexturesToMod entry{};
+            entry.packagePath = textures[k].list[t].path;
+            entry.modIndex = index;
+            entry.listIndex = t;
+            entry.texturesIndex = k;
+            map.push_back(entry);
+
+            modsToReplace[index].instance++;
+        }
+    }
+
+    for (int i = 0; i < modsToReplace.count(); i++)
+    {
+        if (!matchedMod[i])
+            plan.missingMods.push_back(i);
+    }
+
+    QSort(map, 0, map.count() - 1, comparePaths);
+    QString previousPath;
+    int packagesIndex = -1;
+    for (int i = 0; i < map.count(); i++)
+    {
+        MapPackagesToModEntry entry{};
+        entry.modIndex = map[i].modIndex;
+        entry.texturesIndex = map[i].texturesIndex;
+        entry.listIndex = map[i].listIndex;
+        QString path = map[i].packagePath.toLower();
+        if (AsciiStringMatch(previousPath, path))
+        {
+            MapPackagesToMod &mapEntry = plan.packages[packagesIndex];
+            mapEntry.usage += modsToReplace[map[i].modIndex].memEntrySize;
+            mapEntry.instances += modsToReplace[map[i].modIndex].instance;
+            mapEntry.textures.push_back(entry);
+        }
+        else
+        {
+            MapPackagesToMod mapEntry{};
+            mapEntry.textures.push_back(entry);
+            mapEntry.packagePath = map[i].packagePath;
+            mapEntry.usage = modsToReplace[map[i].modIndex].memEntrySize;
+            mapEntry.instances = modsToReplace[map[i].modIndex].instance;
+            previousPath = path;
+            plan.packages.push_back(mapEntry);
+            packagesIndex++;
+        }
+        plan.exports++;
+    }
+
+    PINFO(QString("Install plan: packages: ") + QString::number(plan.packages.count()) +
+          ", exports: " + QString::number(plan.exports) +
+          ", overridden textures: " + QString::number(plan.overriddenMods) +
+          ", textures not present in game: " + QString::number(plan.missingMods.count()) + "\n");
+}
@@ -20,20 +20,158 @@
  */
 
 #include <MipMaps/MipMaps.h>
+#include <MipMaps/MipMapsCache.h>
+#include <MipMaps/MipMapsJournal.h>
 #include <GameData/GameData.h>
 #include <GameData/Package.h>
 #include <Texture/Texture.h>
 #include <Texture/TextureMovie.h>
 #include <Misc/Misc.h>
 #include <Helpers/MiscHelpers.h>
+#include <Helpers/PackagePrefetcher.h>
 #include <Helpers/Logs.h>
-#include <Helpers/QSort.h>
 #include <Wrappers.h>
 
 namespace {
 
 const quint8 tfcNewGuid[16] = { 0xB4, 0xD2, 0xD7, 0x16, 0x08, 0x4A, 0x4B, 0x99, 0x9F, 0xC9, 0x07, 0x89, 0x87, 0xE0, 0x38, 0x21 };
 
+// Appends movie at the archive end, MEM entries are decoded straight into the archive
+bool WriteMovieData(FileStream &archiveFs, const ByteBuffer &data, const ModEntry &mod,
+                    quint32 &dataSize, int &w, int &h)
+{
+    qint64 start = archiveFs.Position();
+    if (data.size() != 0)
+    {
+        archiveFs.WriteFromBuffer(data);
+    }
+    else
+    {
+        FileStream fs = FileStream(mod.memPath, FileMode::Open, FileAccess::ReadOnly);
+        fs.JumpTo(mod.memEntryOffset);
+        if (!Misc::decompressData(fs, mod.memEntrySize, archiveFs))
+            return false;
+    }
+    dataSize = archiveFs.Position() - start;
+    if (dataSize < 28)
+        return false;
+    if (data.size() == 0)
+    {
+        archiveFs.JumpTo(start + 20);
+        w = archiveFs.ReadInt32();
+        h = archiveFs.ReadInt32();
+        archiveFs.JumpTo(start + dataSize);
+    }
+    return true;
+}
+
+void ReportMovieDataError(const ModEntry &mod)
+{
+    if (g_ipc)
+    {
+        ConsoleWrite(QString("[IPC]ERROR ") + mod.textureName + " MEM file: " + mod.memPath);
+        ConsoleSync();
+    }
+    PERROR(QString("Failed decompress data: ") + mod.textureName +
+           " MEM file: " + mod.memPath + "\n");
+}
+
+struct VerifyEntry
+{
+    int textureIndex;
+    int listIndex;
+};
+
+struct VerifyMessage
+{
+    QString text;
+    bool error;
+    bool ipc;
+};
+
+struct PackageVerifyReport
+{
+    QList<VerifyMessage> messages;
+    bool errors;
+    bool done;
+};
+
+void AddVerifyError(PackageVerifyReport &report, const QString &ipcMessage, const QString &message)
+{
+    if (g_ipc)
+        report.messages.push_back(VerifyMessage{ ipcMessage, true, true });
+    else
+        report.messages.push_back(VerifyMessage{ message, true, false });
+    report.errors = true;
+}
+
+// Runs on a worker thread, the package and TFC readers are private to the call
+void VerifyPackageTextures(const QString &packagePath, const QList<TextureMapEntry> &textures,
+                           const QVector<VerifyEntry> &entries, PackageVerifyReport &report)
+{
+    Package package{};
+    if (package.Open(g_GameData->GamePath() + packagePath) != 0)
+    {
+        AddVerifyError(report, QString("[IPC]ERROR Issue opening package file: ") + packagePath,
+                       QString("Error: Issue opening package file: ") + packagePath + "\n");
+        return;
+    }
+
+    foreach (VerifyEntry entry, entries)
+    {
+        const TextureMapEntry &foundTexture = textures[entry.textureIndex];
+        const TextureMapPackageEntry &matchedTexture = foundTexture.list[entry.listIndex];
+        if (!g_ipc)
+        {
+            report.messages.push_back(VerifyMessage{ QString("Texture: ") + QString::number(entry.textureIndex + 1) +
+                                      " of " + QString::number(textures.count()) + " " + foundTexture.name +
+                                      " in " + matchedTexture.path + "\n", false, false });
+        }
+        auto exportData = package.getExportData(matchedTexture.exportID);
+        if (exportData.ptr() == nullptr)
+        {
+            AddVerifyError(report,
+                           QString("[IPC]ERROR Texture ") + foundTexture.name +
+                           " has broken export data in package: " +
+                           matchedTexture.path + "Export UIndex: " +
+                           QString::number(matchedTexture.exportID + 1) + " Skipping...",
+                           QString("Error: Texture ") + foundTexture.name +
+                           " has broken export data in package: " +
+                           matchedTexture.path + "\nExport UIndex: " +
+                           QString::number(matchedTexture.exportID + 1) + "\nSkipping...\n");
+            continue;
+        }
+        Texture texture = Texture(package, matchedTexture.exportID, exportData);
+        exportData.Free();
+        for (int m = 0; m < matchedTexture.crcs.count(); m++)
+        {
+            if (matchedTexture.crcs[m] != texture.getCrcData(texture.getMipMapDataByIndex(m)))
+            {
+                AddVerifyError(report,
+                               QString("[IPC]ERROR Texture ") + foundTexture.name +
+                               " CRC does not match, mipmap: " +
+                               QString::number(m) + ", Package: " +
+                               matchedTexture.path + ", Export UIndex: " +
+                               QString::number(matchedTexture.exportID + 1),
+                               QString("Error: Texture ") + foundTexture.name +
+                               " CRC does not match, mipmap: " +
+                               QString::number(m) + "\nPackage: " +
+                               matchedTexture.path + "\nExport UIndex: " +
+                               QString::number(matchedTexture.exportID + 1) + "\n");
+            }
+        }
+    }
+}
+
+// Each worker holds a whole decompressed package, keep them within memory
+int VerifyWorkersCount()
+{
+    int memoryAmount = DetectAmountMemoryGB();
+    if (memoryAmount == 0)
+        memoryAmount = 16;
+    return qMax(1, qMin(omp_get_max_threads(), memoryAmount / 2));
+}
+
 } // namespace
 
 PixelFormat MipMaps::changeTextureType(PixelFormat gamePixelFormat, PixelFormat texturePixelFormat, Texture &texture)
@@ -187,91 +325,86 @@ void MipMaps::RemoveLowerMips(Image *image)
 bool MipMaps::VerifyTextures(QList<TextureMapEntry> &textures,
                              ProgressCallback callback, void *callbackHandle)
 {
-    bool errors = false;
-    int lastProgress = -1;
-
+    // Group entries by package, in order of first appearance
+    QStringList packagesList;
+    QVector<QVector<VerifyEntry>> packagesEntries;
+    QHash<QString, int> packagesIndex;
     for (int k = 0; k < textures.count(); k++)
     {
-#ifdef GUI
-        QApplication::processEvents();
-#endif
-        int newProgress = (k + 1) * 100 / textures.count();
-        if (lastProgress != newProgress)
+        for (int t = 0; t < textures[k].list.count(); t++)
         {
-            lastProgress = newProgress;
-            if (g_ipc)
+            const TextureMapPackageEntry &entry = textures[k].list[t];
+            if (entry.path.length() == 0 || entry.crcs.count() == 0)
+                continue;
+            int index = packagesIndex.value(entry.path, -1);
+            if (index == -1)
             {
-                ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
-                ConsoleSync();
+                index = packagesList.count();
+                packagesIndex.insert(entry.path, index);
+                packagesList.append(entry.path);
+                packagesEntries.push_back(QVector<VerifyEntry>());
             }
-            else if (callback)
+            packagesEntries[index].push_back(VerifyEntry{ k, t });
+        }
+    }
+
+    int count = packagesList.count();
+    QVector<PackageVerifyReport> reports(count, PackageVerifyReport{ QList<VerifyMessage>(), false, false });
+    PackageVerifyReport *reportsPtr = reports.data();
+    std::mutex reportLock;
+    int nextReport = 0;
+    int lastProgress = -1;
+    bool errors = false;
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(VerifyWorkersCount())
+    for (int i = 0; i < count; i++)
+    {
+        VerifyPackageTextures(packagesList.at(i), textures, packagesEntries.at(i), reportsPtr[i]);
+
+        // Reports are flushed in package order as soon as all earlier packages are done
+        std::lock_guard<std::mutex> guard(reportLock);
+        reportsPtr[i].done = true;
+        while (nextReport < count && reportsPtr[nextReport].done)
+        {
+            foreach (VerifyMessage message, reportsPtr[nextReport].messages)
             {
-                callback(callbackHandle, newProgress, "Verifing textures");
+                if (message.ipc)
+                {
+                    ConsoleWrite(message.text);
+                    ConsoleSync();
+                }
+                else if (message.error)
+                {
+                    PERROR(message.text);
+                }
+                else
+                {
+                    PINFO(message.text);
+                }
             }
+            reportsPtr[nextReport].messages.clear();
+            if (reportsPtr[nextReport].errors)
+                errors = true;
+            nextReport++;
         }
-        for (int t = 0; t < textures[k].list.count(); t++)
+
+        // GUI progress and events are only allowed from the main thread
+        if (omp_get_thread_num() == 0)
         {
-            TextureMapEntry foundTexture = textures[k];
-            if (textures[k].list[t].path.length() == 0)
-                continue;
-            TextureMapPackageEntry matchedTexture = textures[k].list[t];
-            if (matchedTexture.crcs.count() != 0)
+#ifdef GUI
+            QApplication::processEvents();
+#endif
+            int newProgress = nextReport * 100 / count;
+            if (lastProgress != newProgress)
             {
-                if (!g_ipc)
+                lastProgress = newProgress;
+                if (g_ipc)
                 {
-                    PINFO(QString("Texture: ") + QString::number(k + 1) + " of " + QString::number(k) +
-                          + " " + foundTexture.name + " in " + matchedTexture.path + "\n");
+                    ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+                    ConsoleSync();
                 }
-                Package package{};
-                if (package.Open(g_GameData->GamePath() + matchedTexture.path) != 0)
+                else if (callback)
                 {
-                    auto exportData = package.getExportData(matchedTexture.exportID);
-                    if (exportData.ptr() == nullptr)
-                    {
-                        if (g_ipc)
-                        {
-                            ConsoleWrite(QString("[IPC]ERROR Texture ") + foundTexture.name +
-                                         " has broken export data in package: " +
-                                         matchedTexture.path + "Export UIndex: " +
-                                         QString::number(matchedTexture.exportID + 1) + " Skipping...");
-                            ConsoleSync();
-                        }
-                        else
-                        {
-                            PERROR(QString("Error: Texture ") + foundTexture.name +
-                                   " has broken export data in package: " +
-                                   matchedTexture.path + "\nExport UIndex: " +
-                                   QString::number(matchedTexture.exportID + 1) + "\nSkipping...\n");
-                        }
-                        errors = true;
-                        continue;
-                    }
-                    Texture texture = Texture(package, matchedTexture.exportID, exportData);
-                    exportData.Free();
-                    for (int m = 0; m < matchedTexture.crcs.count(); m++)
-                    {
-                        if (matchedTexture.crcs[m] != texture.getCrcData(texture.getMipMapDataByIndex(m)))
-                        {
-                            if (g_ipc)
-                            {
-                                ConsoleWrite(QString("[IPC]ERROR Texture ") + foundTexture.name +
-                                             " CRC does not match, mipmap: " +
-                                             QString::number(m) + ", Package: " +
-                                             matchedTexture.path + ", Export UIndex: " +
-                                             QString::number(matchedTexture.exportID + 1));
-                                ConsoleSync();
-                            }
-                            else
-                            {
-                                PERROR(QString("Error: Texture ") + foundTexture.name +
-                                       " CRC does not match, mipmap: " +
-                                       QString::number(m) + "\nPackage: " +
-                                       matchedTexture.path + "\nExport UIndex: " +
-                                       QString::number(matchedTexture.exportID + 1) + "\n");
-                            }
-                            errors = true;
-                        }
-                    }
+                    callback(callbackHandle, newProgress, "Verifing textures");
                 }
             }
         }
@@ -279,21 +412,29 @@ bool MipMaps::VerifyTextures(QList<TextureMapEntry> &textures,
     return errors;
 }
 
+quint64 MipMaps::GetCacheLimit(int cacheAmount, int &memoryAmount)
+{
+    memoryAmount = DetectAmountMemoryGB();
+    if (memoryAmount == 0)
+        memoryAmount = 16;
+    quint64 cacheLimit = (memoryAmount - 2) * 1024ULL * 1024 * 1024;
+    if (cacheAmount >= 0 && cacheAmount <= 100)
+        cacheLimit = (quint64)((memoryAmount * 1024ULL * 1024 * 1024) * (cacheAmount / 100.0));
+    return cacheLimit;
+}
+
 QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapEntry> &textures,
                                  QStringList &pkgsToMarker,
                                  QList<ModEntry> &modsToReplace,
                                  bool appendMarker, bool verify, int cacheAmount,
-                                 ProgressCallback callback, void *callbackHandle)
+                                 ProgressCallback callback, void *callbackHandle,
+                                 MipMapsJournal *journal)
 {
     QString errors = "";
     int lastProgress = -1;
-    int memoryAmount = DetectAmountMemoryGB();
-    if (memoryAmount == 0)
-        memoryAmount = 16;
-    quint64 cacheUsage = 0;
-    quint64 cacheLimit = (memoryAmount - 2) * 1024ULL * 1024 * 1024;
-    if (cacheAmount >= 0 && cacheAmount <= 100)
-        cacheLimit = (quint64)((memoryAmount * 1024ULL * 1024 * 1024) * (cacheAmount / 100.0));
+    int memoryAmount;
+    quint64 cacheLimit = GetCacheLimit(cacheAmount, memoryAmount);
+    MipMapsCache cache(cacheLimit);
 
     if (g_ipc)
     {
@@ -302,8 +443,20 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
         ConsoleSync();
     }
 
+    int unverifiedPackages = 0;
+    QStringList packagesList;
+    for (int e = 0; e < map.count(); e++)
+    {
+        if (journal && journal->IsCompleted(map[e].packagePath))
+            packagesList.append("");
+        else
+            packagesList.append(g_GameData->GamePath() + map[e].packagePath);
+    }
+    PackagePrefetcher prefetcher(packagesList);
+
     for (int e = 0; e < map.count(); e++)
     {
+        prefetcher.Advance(e);
         if (g_ipc)
         {
             ConsoleWrite(QString("[IPC]PROCESSING_FILE ") + map[e].packagePath);
@@ -330,6 +483,31 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
             }
         }
 
+        if (journal && journal->IsCompleted(map[e].packagePath))
+        {
+            // Installed before interruption, only mods bookkeeping and verification CRCs are replayed
+            if (verify && !journal->RestoreCrcs(map[e], textures))
+                unverifiedPackages++;
+            for (int p = 0; p < map[e].textures.count(); p++)
+            {
+                const MapPackagesToModEntry &entryMap = map[e].textures[p];
+                ModEntry mod = modsToReplace[entryMap.modIndex];
+                journal->RestoreArc(mod, entryMap.modIndex);
+                mod.instance--;
+                if (mod.instance < 0)
+                    CRASH();
+                if (mod.instance == 0)
+                {
+                    cache.Release(mod, entryMap.modIndex);
+                    mod.arcTexture.clear();
+                }
+                modsToReplace.replace(entryMap.modIndex, mod);
+            }
+            if (appendMarker)
+                pkgsToMarker.removeOne(map[e].packagePath);
+            continue;
+        }
+
         Package package{};
         if (package.Open(g_GameData->GamePath() + map[e].packagePath) != 0)
         {
@@ -349,6 +527,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
             continue;
         }
 
+        QList<int> arcMods;
         for (int p = 0; p < map[e].textures.count(); p++)
         {
 #ifdef GUI
@@ -381,18 +560,21 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                 TextureMovie textureMovie = TextureMovie(package, matched.exportID, exportData);
                 exportData.Free();
 
+                // Movies appended to TFC are decoded from the MEM entry straight into the archive
+                StorageTypes storageType = textureMovie.getStorageType();
+                bool streamToArchive = storageType == StorageTypes::extUnc && mod.injectedMovieTexture.size() == 0;
                 ByteBuffer data;
                 if (mod.injectedMovieTexture.size() != 0)
                 {
                     data = mod.injectedMovieTexture;
                 }
-                else
+                else if (!streamToArchive)
                 {
                     FileStream fs = FileStream(mod.memPath, FileMode::Open, FileAccess::ReadOnly);
                     fs.JumpTo(mod.memEntryOffset);
                     data = Misc::decompressData(fs, mod.memEntrySize);
                 }
-                if (data.size() == 0)
+                if (!streamToArchive && data.size() == 0)
                 {
                     if (g_ipc)
                     {
@@ -403,11 +585,12 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                            " MEM file: " + mod.memPath + "\n");
                     continue;
                 }
-                int w = *reinterpret_cast<qint32 *>(data.ptr() + 20);
-                int h = *reinterpret_cast<qint32 *>(data.ptr() + 24);
-                textureMovie.getProperties().setIntValue("SizeX", w);
-                textureMovie.getProperties().setIntValue("SizeY", h);
-                StorageTypes storageType = textureMovie.getStorageType();
+                int w = 0, h = 0;
+                if (!streamToArchive)
+                {
+                    w = *reinterpret_cast<qint32 *>(data.ptr() + 20);
+                    h = *reinterpret_cast<qint32 *>(data.ptr() + 24);
+                }
                 if (storageType == StorageTypes::extUnc)
                 {
                     QString archive = textureMovie.getProperties().getProperty("TextureFileCacheName").getValueName();
@@ -427,6 +610,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                             {
                                 FileStream fs = FileStream(DLCArchiveFile, FileMode::Create, FileAccess::WriteOnly);
                                 fs.WriteFromBuffer(textureMovie.getProperties().getProperty("TFCFileGuid").getValueStruct());
+                                g_GameData->InvalidateInventoryFile(DLCArchiveFile);
                                 archiveFile = DLCArchiveFile;
                             }
                             else
@@ -459,6 +643,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                                     textureMovie.getProperties().setStructValue("TFCFileGuid", "Guid", guid);
                                     FileStream fs = FileStream(archiveFile, FileMode::Create, FileAccess::WriteOnly);
                                     fs.WriteFromBuffer(guid);
+                                    g_GameData->InvalidateInventoryFile(archiveFile);
                                     guid.Free();
                                     break;
                                 }
@@ -478,14 +663,41 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                         }
                         FileStream archiveFs = FileStream(archiveFile, FileMode::Open, FileAccess::ReadWrite);
                         archiveFs.SeekEnd();
-                        textureMovie.replaceMovieData(data, archiveFs.Position());
-                        archiveFs.WriteFromBuffer(data);
+                        quint32 dataOffset = archiveFs.Position();
+                        quint32 dataSize = 0;
+                        if (!WriteMovieData(archiveFs, data, mod, dataSize, w, h))
+                        {
+                            archiveFs.Close();
+                            QFile(archiveFile).resize(dataOffset);
+                            g_GameData->InvalidateInventoryFile(archiveFile);
+                            ReportMovieDataError(mod);
+                            continue;
+                        }
+                        textureMovie.replaceMovieData(dataSize, dataOffset);
+                        g_GameData->InvalidateInventoryFile(archiveFile);
                     }
                     else
                     {
+                        // Existing TFC data is overwritten, so decode and validate
+                        // the movie before touching the archive
+                        if (data.size() == 0)
+                        {
+                            FileStream fs = FileStream(mod.memPath, FileMode::Open, FileAccess::ReadOnly);
+                            fs.JumpTo(mod.memEntryOffset);
+                            data = Misc::decompressData(fs, mod.memEntrySize);
+                            if (data.size() < 28)
+                            {
+                                data.Free();
+                                ReportMovieDataError(mod);
+                                continue;
+                            }
+                            w = *reinterpret_cast<qint32 *>(data.ptr() + 20);
+                            h = *reinterpret_cast<qint32 *>(data.ptr() + 24);
+                        }
                         FileStream archiveFs = FileStream(archiveFile, FileMode::Open, FileAccess::ReadWrite);
                         archiveFs.JumpTo(textureMovie.getDataOffset());
                         archiveFs.WriteFromBuffer(data);
+                        g_GameData->InvalidateInventoryFile(archiveFile);
                     }
                 }
                 else
@@ -494,6 +706,8 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                 }
                 if (mod.injectedMovieTexture.size() == 0)
                     data.Free();
+                textureMovie.getProperties().setIntValue("SizeX", w);
+                textureMovie.getProperties().setIntValue("SizeY", h);
 
                 ByteBuffer bufferProperties = textureMovie.getProperties().toArray();
                 {
@@ -523,7 +737,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                 texture.getProperties().setIntValue("InternalFormatLODBias", -10);
 
                 Image *image = nullptr;
-                if (mod.cacheCprMipmaps.count() == 0)
+                if (!cache.Fetch(mod, entryMap.modIndex))
                 {
                     if (mod.injectedTexture != nullptr)
                     {
@@ -545,8 +759,8 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                                    " MEM file: " + mod.memPath + "\n");
                             continue;
                         }
-                        image = new Image(data, ImageFormat::DDS);
-                        data.Free();
+                        // mips reference the payload, it is released with the image
+                        image = new Image(data, MipMap::shareBuffer(data), ImageFormat::DDS);
                     }
 
                     if (!Misc::CheckImage(*image, texture, mod.textureName))
@@ -608,7 +822,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                         mod.cacheSize += data.size();
                         data.Free();
                     }
-                    cacheUsage += mod.cacheSize;
+                    cache.Insert(mod, entryMap.modIndex);
                 }
                 else
                 {
@@ -707,6 +921,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                             {
                                 FileStream fs = FileStream(DLCArchiveFile, FileMode::Create, FileAccess::WriteOnly);
                                 fs.WriteFromBuffer(texture.getProperties().getProperty("TFCFileGuid").getValueStruct());
+                                g_GameData->InvalidateInventoryFile(DLCArchiveFile);
                                 archiveFile = DLCArchiveFile;
                             }
                             else
@@ -741,6 +956,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                                 texture.getProperties().setStructValue("TFCFileGuid", "Guid", guid);
                                 FileStream fs = FileStream(archiveFile, FileMode::Create, FileAccess::WriteOnly);
                                 fs.WriteFromBuffer(guid);
+                                g_GameData->InvalidateInventoryFile(archiveFile);
                                 guid.Free();
                                 break;
                             }
@@ -810,6 +1026,7 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                             fs.SeekEnd();
                             mipmap.dataOffset = (uint)fs.Position();
                             fs.WriteFromBuffer(mipmap.newData);
+                            g_GameData->InvalidateInventoryFile(archiveFile);
                         }
                         else
                         {
@@ -866,11 +1083,12 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                     mod.CopyMipMapsList(mod.arcTexture, texture.mipMapsList);
                     memcpy(mod.arcTfcGuid, texture.getProperties().getProperty("TFCFileGuid").getValueStruct().ptr(), 16);
                     mod.arcTfcName = texture.getProperties().getProperty("TextureFileCacheName").getValueName();
+                    arcMods.append(entryMap.modIndex);
                 }
 
                 if (g_ipc)
                 {
-                    ConsoleWrite(QString("[IPC]CACHE_USAGE ") + QString::number(cacheUsage));
+                    ConsoleWrite(QString("[IPC]CACHE_USAGE ") + QString::number(cache.Usage()));
                     ConsoleSync();
                 }
 
@@ -879,23 +1097,12 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
                     CRASH();
                 if (mod.instance == 0)
                 {
-                    foreach(MipMap mip, mod.cacheCprMipmaps)
-                    {
-                        mip.Free();
-                    }
-                    mod.cacheCprMipmaps.clear();
-                    cacheUsage -= mod.cacheSize;
-
+                    cache.Release(mod, entryMap.modIndex);
                     mod.arcTexture.clear();
                 }
-                else if (cacheUsage > cacheLimit)
+                else
                 {
-                    foreach(MipMap mip, mod.cacheCprMipmaps)
-                    {
-                        mip.Free();
-                    }
-                    mod.cacheCprMipmaps.clear();
-                    cacheUsage -= mod.cacheSize;
+                    cache.Trim(modsToReplace, mod, entryMap.modIndex);
                 }
 
                 if (mod.injectedTexture == nullptr)
@@ -906,10 +1113,32 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
             }
         }
 
+        if (journal)
+            journal->BeginPackage(map[e].packagePath, modsToReplace, arcMods);
+        // Failed save leaves the package pending, resume installs it again
         if (package.SaveToFile(false, false, appendMarker))
         {
             if (appendMarker)
                 pkgsToMarker.removeOne(package.packagePath);
+            if (journal)
+                journal->CompletePackage(map[e], textures);
+        }
+    }
+
+    cache.ReportStats();
+
+    if (unverifiedPackages != 0)
+    {
+        QString warning = QString("Warning: ") + QString::number(unverifiedPackages) +
+                          " packages installed before interruption have no recorded CRCs and are not verified.";
+        if (g_ipc)
+        {
+            ConsoleWrite(QString("[IPC]ERROR ") + warning);
+            ConsoleSync();
+        }
+        else
+        {
+            PERROR(warning + "\n");
         }
     }
 
@@ -924,146 +1153,27 @@ QString MipMaps::replaceTextures(QList<MapPackagesToMod> &map, QList<TextureMapE
     return errors;
 }
 
-namespace {
-
-int comparePaths(const MapTexturesToMod &e1, const MapTexturesToMod &e2)
-{
-    int compResult = AsciiStringCompareCaseIgnore(e1.packagePath, e2.packagePath);
-    if (compResult < 0)
-        return -1;
-    if (compResult > 0)
-        return 1;
-    if (e1.texturesIndex < e2.texturesIndex)
-        return -1;
-    if (e1.texturesIndex > e2.texturesIndex)
-        return 1;
-    if (e1.listIndex < e2.listIndex)
-        return -1;
-    if (e1.listIndex > e2.listIndex)
-        return 1;
-    return 0;
-}
-
-} // namespace
-
 QString MipMaps::replaceModsFromList(QList<TextureMapEntry> &textures, QStringList &pkgsToMarker,
                                      QList<ModEntry> &modsToReplace,
                                      bool appendMarker, bool verify,
-                                     int cacheAmount, ProgressCallback callback, void *callbackHandle)
+                                     int cacheAmount, ProgressCallback callback, void *callbackHandle,
+                                     MipMapsJournal *journal)
 {
     QString errors;
+    ModsInstallPlan plan;
 
-    // Remove duplicates
-    for (int i = 0; i < modsToReplace.count(); i++)
-    {
-        ModEntry mod = modsToReplace[i];
-        // Filter replacing blank textures
-        if (TreeScan::IsBlankTexture(mod.textureCrc))
-        {
-            modsToReplace.removeAt(i);
-            i--;
-            continue;
-        }
-
-        for (int l = 0; l < i; l++)
-        {
-            if ((mod.textureCrc != 0 && mod.textureCrc == modsToReplace[l].textureCrc))
-            {
-                if (g_ipc)
-                {
-                    ConsoleWrite(QString("[IPC]MOD_OVERRIDE ") + mod.textureName +
-                                 QString::asprintf("_0x%08X", mod.textureCrc) + ", " + mod.memPath);
-                    ConsoleSync();
-                }
-                else
-                {
-                    PINFO(QString("Override texture: ") + mod.textureName +
-                          QString::asprintf("_0x%08X", mod.textureCrc) + ", " + mod.memPath + "\n");
-                }
-                modsToReplace.removeAt(l);
-                i--;
-                break;
-            }
-        }
-    }
-
-    QList<MapTexturesToMod> map = QList<MapTexturesToMod>();
-
-    for (int k = 0; k < textures.count(); k++)
-    {
-        int index = -1;
-        for (int t = 0; t < modsToReplace.count(); t++)
-        {
-            if (textures[k].crc == modsToReplace[t].textureCrc)
-            {
-                index = t;
-                break;
-            }
-        }
-        if (index == -1)
-            continue;
-
-        for (int t = 0; t < textures[k].list.count(); t++)
-        {
-            if (textures[k].list[t].path.length() == 0)
-                continue;
-
-            MapTexturesToMod entry{};
-            entry.packagePath = textures[k].list[t].path;
-            entry.modIndex = index;
-            entry.listIndex = t;
-            entry.texturesIndex = k;
-            map.push_back(entry);
-
-            ModEntry mod = modsToReplace[index];
-            mod.instance++;
-            modsToReplace.replace(index, mod);
-        }
-    }
-
-    QSort(map, 0, map.count() - 1, comparePaths);
-    auto mapPackages = QList<MapPackagesToMod>();
-    QString previousPath;
-    int packagesIndex = -1;
-    for (int i = 0; i < map.count(); i++)
-    {
-        MapPackagesToModEntry entry{};
-        entry.modIndex = map[i].modIndex;
-        entry.texturesIndex = map[i].texturesIndex;
-        entry.listIndex = map[i].listIndex;
-        QString path = map[i].packagePath.toLower();
-        if (AsciiStringMatch(previousPath, path))
-        {
-            MapPackagesToMod mapEntry = mapPackages[packagesIndex];
-            mapEntry.usage += modsToReplace[map[i].modIndex].memEntrySize;
-            mapEntry.instances += modsToReplace[map[i].modIndex].instance;
-            mapEntry.textures.push_back(entry);
-            mapPackages.replace(packagesIndex, mapEntry);
-        }
-        else
-        {
-            MapPackagesToMod mapEntry{};
-            mapEntry.textures.push_back(entry);
-            mapEntry.packagePath = map[i].packagePath;
-            mapEntry.usage = modsToReplace[map[i].modIndex].memEntrySize;
-            mapEntry.instances = modsToReplace[map[i].modIndex].instance;
-            previousPath = map[i].packagePath.toLower();
-            mapPackages.push_back(mapEntry);
-            packagesIndex++;
-        }
-    }
-    map.clear();
+    planModsFromList(textures, modsToReplace, plan);
 
-    if (mapPackages.count() != 0)
+    if (plan.packages.count() != 0)
     {
         if (!g_ipc)
         {
             PINFO("\nInstalling texture mods...\n");
         }
 
-        errors += replaceTextures(mapPackages, textures, pkgsToMarker, modsToReplace,
+        errors += replaceTextures(plan.packages, textures, pkgsToMarker, modsToReplace,
                                   appendMarker, verify, cacheAmount,
-                                  callback, callbackHandle);
+                                  callback, callbackHandle, journal);
     }
 
     modsToReplace.clear();
@@ -22,6 +22,7 @@
 #include <Misc/Misc.h>
 #include <GameData/GameData.h>
 #include <Helpers/MiscHelpers.h>
+#include <Helpers/PackagePrefetcher.h>
 #include <Helpers/Logs.h>
 
 bool Misc::SetGameDataPath(MeType gameId, const QString &path)
@@ -184,11 +185,13 @@ long Misc::elapsedTime()
 void Misc::startStageTimer()
 {
     timerStage.start();
+    PackagePrefetcher::ResetStageStats();
 }
 
 void Misc::restartStageTimer()
 {
     timerStage.start();
+    PackagePrefetcher::ResetStageStats();
 }
 
 long Misc::elapsedStageTime()
@@ -31,6 +31,8 @@
 #include "CommonStrings.h"
 
 class MipMaps;
+class MipMapsJournal;
+struct ModEntry;
 
 struct MD5ModFileEntry
 {
@@ -82,7 +84,7 @@ public:
                                          PixelFormat texturePixelFormat,
                                          TextureType flags, bool bc7format = false);
     static uint scanFilenameForCRC(const QString &inputFile);
-    static uint GetCRCFromTextureMap(QList<TextureMapEntry> &textures, int exportId,
+    static uint GetCRCFromTextureMap(const QList<TextureMapEntry> &textures, int exportId,
                                      const QString &path);
     static TextureMapEntry FoundTextureInTheMap(QList<TextureMapEntry> &textures, uint crc);
     static TextureMapEntry FoundTextureInTheInternalMap(MeType gameId, uint crc);
@@ -92,7 +94,9 @@ public:
                                     ProgressCallback callback, void *callbackHandle);
     static bool InstallMods(MeType gameId, Resources &resources, QStringList &modFiles, bool guiInstallerMode, bool alotInstallerMode,
                            bool skipMarkers, bool verify, int cacheAmount,
-                           ProgressCallback callback, void *callbackHandle);
+                           ProgressCallback callback, void *callbackHandle, bool resume = false);
+    static bool PlanInstallMods(MeType gameId, Resources &resources, QStringList &modFiles, int cacheAmount,
+                                ProgressCallback callback, void *callbackHandle);
 
     static bool extractMEM(MeType gameId, QFileInfoList &inputList, QString &outputDir,
                            ProgressCallback callback, void *callbackHandle);
@@ -102,9 +106,12 @@ public:
                            ProgressCallback callback, void *callbackHandle);
     static bool ReportBadMods();
     static bool ReportMods();
+    static void prepareModsList(QStringList &files, QList<TextureMapEntry> &textures,
+                                QList<ModEntry> &modsToReplace, QStringList &skippedTextures);
     static bool applyMods(QStringList &files, QList<TextureMapEntry> &textures, QStringList &pkgsToMarker,
                           MipMaps &mipMaps, bool alotMode, bool verify, int cacheAmount,
-                          ProgressCallback callback, void *callbackHandle);
+                          ProgressCallback callback, void *callbackHandle,
+                          MipMapsJournal *journal = nullptr);
     static QString CorrectTexture(Image *image, Texture &texture, PixelFormat newPixelFormat,
                                   const QString &textureName, float bc7quality);
     static bool CorrectTexture(Image &image, TextureMapEntry &f, int numMips,
@@ -128,6 +135,7 @@ public:
                                void *callbackHandle);
     static bool compressData(ByteBuffer inputData, Stream &ouputStream, CompressionDataType compType = CompressionDataType::LZMA);
     static ByteBuffer decompressData(Stream &stream, long compressedSize);
+    static bool decompressData(Stream &stream, long compressedSize, Stream &outputStream);
 };
 
 #endif
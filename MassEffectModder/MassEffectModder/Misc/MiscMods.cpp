@@ -20,6 +20,7 @@
  */
 
 #include <Misc/Misc.h>
+#include <Misc/ModConvertCache.h>
 #include <MipMaps/MipMaps.h>
 #include <Wrappers.h>
 #include <Helpers/MiscHelpers.h>
@@ -141,6 +142,35 @@ bool Misc::DetectBc7FromFile(const QString &file)
     return idx > 0;
 }
 
+namespace {
+
+struct MergedMemEntry
+{
+    QString path;
+    qint64 offset;
+    qint64 size;
+    quint32 tag;
+    quint32 flags;
+    QByteArray hash;
+};
+
+QByteArray HashMemEntryData(FileStream &fs, qint64 offset, qint64 size)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    std::unique_ptr<quint8[]> buffer (new quint8[0x100000]);
+    fs.JumpTo(offset);
+    while (size != 0)
+    {
+        qint64 count = qMin(size, (qint64)0x100000);
+        fs.ReadToBuffer(buffer.get(), count);
+        hash.addData(reinterpret_cast<const char *>(buffer.get()), count);
+        size -= count;
+    }
+    return hash.result();
+}
+
+} // namespace
+
 bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                                MeType gameId, QList<TextureMapEntry> &textures,
                                bool fastMode, bool markToConvert, bool bc7format, float bc7quality,
@@ -151,6 +181,8 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
     QStringList ddsList;
 
     QList<FileMod> modFiles = QList<FileMod>();
+    QHash<quint32, MergedMemEntry> mergedEntries;
+    int duplicatedEntries = 0;
 
     QString dir = DirName(memFilePath);
     if (dir != memFilePath)
@@ -161,6 +193,10 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
 
     Misc::startTimer();
 
+    ModConvertCache convertCache(ModConvertCache::DefaultPath(), ModConvertCache::DefaultLimit(),
+                                 ModConvertCache::DefaultMaxAge());
+    CompressionDataType compType = fastMode ? CompressionDataType::Zlib : CompressionDataType::LZMA;
+
     FileStream outFs = FileStream(memFilePath, FileMode::Create, FileAccess::WriteOnly);
     outFs.WriteUInt32(TextureModTag);
     outFs.WriteUInt32(TextureModVersion);
@@ -220,17 +256,43 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                 fileMod.flags = fs.ReadUInt64();
                 qint64 prevPos = fs.Position();
                 fs.JumpTo(fileMod.offset);
-                fileMod.offset = outFs.Position();
-                if (fileMod.tag == FileTextureTag ||
-                    fileMod.tag == FileMovieTextureTag)
+                if (fileMod.tag != FileTextureTag &&
+                    fileMod.tag != FileMovieTextureTag)
                 {
-                    outFs.WriteUInt32(fs.ReadUInt32()); // flags
-                    outFs.WriteUInt32(fs.ReadUInt32()); // crc
-                }
-                else
                     CRASH();
+                }
+                quint32 textureFlags = fs.ReadUInt32();
+                quint32 crc = fs.ReadUInt32();
+                qint64 dataOffset = fs.Position();
+
+                // Skip entry identical to the latest one for the same CRC, it would not change install result
+                auto merged = mergedEntries.find(crc);
+                QByteArray hash;
+                if (merged != mergedEntries.end() && merged->tag == fileMod.tag &&
+                    merged->flags == textureFlags && merged->size == fileMod.size)
+                {
+                    if (merged->hash.isEmpty())
+                    {
+                        FileStream mergedFs = FileStream(merged->path, FileMode::Open, FileAccess::ReadOnly);
+                        merged->hash = HashMemEntryData(mergedFs, merged->offset, merged->size);
+                    }
+                    hash = HashMemEntryData(fs, dataOffset, fileMod.size);
+                    if (hash == merged->hash)
+                    {
+                        PINFO(QString("Skipping duplicated entry: ") + fileMod.name +
+                              QString::asprintf("_0x%08X", crc) + "\n");
+                        duplicatedEntries++;
+                        fs.JumpTo(prevPos);
+                        continue;
+                    }
+                    fs.JumpTo(dataOffset);
+                }
+                mergedEntries.insert(crc, { file, dataOffset, fileMod.size, fileMod.tag, textureFlags, hash });
 
-                outFs.CopyFrom(fs, fileMod.size);
+                fileMod.offset = outFs.Position();
+                outFs.WriteUInt32(textureFlags);
+                outFs.WriteUInt32(crc);
+                outFs.CopyFromFile(fs, fileMod.size);
                 fs.JumpTo(prevPos);
                 modFiles.push_back(fileMod);
             }
@@ -267,7 +329,40 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
                 }
             }
 
-            Image image(file, ImageFormat::UnknownImageFormat);
+            QByteArray cacheKey;
+            if (convertCache.Enabled())
+            {
+                cacheKey = ModConvertCache::MakeKey(file, ModConvertCache::MakeParams(f, GetNumberOfMipsFromMap(f),
+                                                   forceHash, entryMarkToConvert, bc7format, bc7quality, compType));
+                quint32 textureFlags{};
+                if (entryMarkToConvert)
+                    textureFlags |= (quint32)ModTextureFlags::MarkToConvert;
+                if (forceHash)
+                    textureFlags |= (quint32)ModTextureFlags::ForceHash;
+                qint64 entryOffset = outFs.Position();
+                outFs.WriteUInt32(textureFlags);
+                outFs.WriteUInt32(crc);
+                FileMod fileMod{};
+                if (convertCache.Fetch(cacheKey, outFs, fileMod.size))
+                {
+                    PDEBUG(QString("Using cached conversion of texture: ") + BaseName(file) + "\n");
+                    fileMod.tag = FileTextureTag;
+                    fileMod.name = f.name;
+                    fileMod.offset = entryOffset;
+                    modFiles.push_back(fileMod);
+                    mergedEntries.remove(crc);
+                    continue;
+                }
+                outFs.JumpTo(entryOffset);
+            }
+
+            ByteBuffer mappedData;
+            std::shared_ptr<const void> mappedFile;
+            if (file.endsWith(".dds", Qt::CaseInsensitive))
+                mappedFile = Image::mapFile(file, mappedData);
+            Image image = mappedFile ? Image(mappedData, mappedFile, ImageFormat::DDS) :
+                                       Image(file, ImageFormat::UnknownImageFormat);
+            mappedFile.reset();
             if (forceHash)
             {
                 f.width = image.getMipMaps().first()->getOrigWidth();
@@ -305,8 +400,13 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
             fileMod.tag = FileTextureTag;
             fileMod.name = f.name;
             std::unique_ptr<Stream> dst (new MemoryStream());
-            Misc::compressData(data, *dst, fastMode ? CompressionDataType::Zlib : CompressionDataType::LZMA);
+            Misc::compressData(data, *dst, compType);
             data.Free();
+            if (!cacheKey.isEmpty())
+            {
+                dst->SeekBegin();
+                convertCache.Store(cacheKey, *dst, dst->Length());
+            }
             dst->SeekBegin();
             fileMod.offset = outFs.Position();
             fileMod.size = dst->Length();
@@ -319,6 +419,7 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
             outFs.WriteUInt32(crc);
             outFs.CopyFrom(*dst, dst->Length());
             modFiles.push_back(fileMod);
+            mergedEntries.remove(crc);
         }
         else if (file.endsWith(".bik", Qt::CaseInsensitive))
         {
@@ -402,9 +503,13 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
             outFs.WriteUInt32(crc);
             outFs.CopyFrom(*dst, dst->Length());
             modFiles.push_back(fileMod);
+            mergedEntries.remove(crc);
         }
     }
 
+    convertCache.ReportStats();
+    convertCache.Trim();
+
     if (modFiles.count() == 0)
     {
         outFs.Close();
@@ -421,6 +526,9 @@ bool Misc::convertDataModtoMem(QFileInfoList &files, QString &memFilePath,
         return false;
     }
 
+    if (duplicatedEntries != 0)
+        PINFO(QString("Skipped duplicated entries: ") + QString::number(duplicatedEntries) + "\n");
+
     qint64 pos = outFs.Position();
     outFs.SeekBegin();
     outFs.WriteUInt32(TextureModTag);
@@ -554,9 +662,24 @@ bool Misc::extractMEM(MeType gameId, QFileInfoList &inputList, QString &outputDi
                 }
             }
 
-            ByteBuffer dst = Misc::decompressData(fs, size);
-            if (dst.size() == 0)
+            QString filename = outputMODdir + "/" + modFiles[i].name + QString::asprintf("_0x%08X", crc);
+            if (flags == ModTextureFlags::ForceHash)
+                filename += "-hash";
+            if (flags & ModTextureFlags::MarkToConvert)
+                filename += "-memconvert";
+            if (modFiles[i].tag == FileTextureTag)
+                filename += ".dds";
+            else
+                filename += ".bik";
+
+            bool decompressed;
+            {
+                FileStream output = FileStream(filename, FileMode::Create, FileAccess::ReadWrite);
+                decompressed = Misc::decompressData(fs, size, output);
+            }
+            if (!decompressed)
             {
+                QFile::remove(filename);
                 if (g_ipc)
                 {
                     ConsoleWrite(QString("[IPC]ERROR_FILE_NOT_COMPATIBLE ") + file.absoluteFilePath());
@@ -566,25 +689,6 @@ bool Misc::extractMEM(MeType gameId, QFileInfoList &inputList, QString &outputDi
                 PERROR("Extracting MEM mod files failed.\n\n");
                 return false;
             }
-
-            if (modFiles[i].tag == FileTextureTag ||
-                modFiles[i].tag == FileMovieTextureTag)
-            {
-                QString filename = outputMODdir + "/" + modFiles[i].name + QString::asprintf("_0x%08X", crc);
-                if (flags == ModTextureFlags::ForceHash)
-                    filename += "-hash";
-                if (flags & ModTextureFlags::MarkToConvert)
-                    filename += "-memconvert";
-                if (modFiles[i].tag == FileTextureTag)
-                    filename += ".dds";
-                else if (modFiles[i].tag == FileMovieTextureTag)
-                    filename += ".bik";
-                else
-                    CRASH();
-                FileStream output = FileStream(filename, FileMode::Create, FileAccess::ReadWrite);
-                output.WriteFromBuffer(dst);
-            }
-            dst.Free();
         }
     }
 
@@ -672,52 +776,55 @@ bool Misc::compressData(ByteBuffer inputData, Stream &ouputStream, CompressionDa
     return true;
 }
 
-ByteBuffer Misc::decompressData(Stream &stream, long compressedSize)
+namespace {
+
+struct MemChunkHeader
+{
+    CompressionDataType compType;
+    uint maxBlockSize;
+    uint uncompressedSize;
+    QList<Package::ChunkBlock> blocks;
+};
+
+bool ReadMemChunkHeader(Stream &stream, long compressedSize, MemChunkHeader &header)
 {
     uint compressedChunkSize = stream.ReadUInt32();
-    uint uncompressedChunkSize = stream.ReadUInt32();
-    uint maxBlockSize = stream.ReadUInt32();
-    auto compType = (CompressionDataType)(maxBlockSize & 0xffff);
-    if ((maxBlockSize & ~0xffff) == 0)
-        maxBlockSize = 0x40000; // original size 256KB
-    auto data = ByteBuffer(uncompressedChunkSize);
-    uint blocksCount = (uncompressedChunkSize + maxBlockSize - 1) / maxBlockSize;
-    if ((compressedChunkSize + ModsDataEnums::SizeOfChunk + ModsDataEnums::SizeOfChunkBlock * blocksCount) != (uint)compressedSize)
+    header.uncompressedSize = stream.ReadUInt32();
+    header.maxBlockSize = stream.ReadUInt32();
+    header.compType = (CompressionDataType)(header.maxBlockSize & 0xffff);
+    if ((header.maxBlockSize & ~0xffff) == 0)
+        header.maxBlockSize = 0x40000; // original size 256KB
+    uint blocksCount = (header.uncompressedSize + header.maxBlockSize - 1) / header.maxBlockSize;
+    if ((compressedChunkSize + Misc::ModsDataEnums::SizeOfChunk +
+         Misc::ModsDataEnums::SizeOfChunkBlock * blocksCount) != (uint)compressedSize)
     {
-        data.Free();
-        return ByteBuffer{};
+        return false;
     }
 
-    QList<Package::ChunkBlock> blocks{};
+    header.blocks.clear();
     for (uint b = 0; b < blocksCount; b++)
     {
         Package::ChunkBlock block{};
         block.comprSize = stream.ReadUInt32();
         block.uncomprSize = stream.ReadUInt32();
-        blocks.push_back(block);
+        if (block.uncomprSize > header.maxBlockSize)
+            return false;
+        header.blocks.push_back(block);
     }
 
-    for (int b = 0; b < blocks.count(); b++)
-    {
-        Package::ChunkBlock block = blocks[b];
-        block.compressedBuffer = new quint8[block.comprSize];
-        if (block.compressedBuffer == nullptr)
-            CRASH_MSG((QString("Out of memory! - amount: ") +
-                       QString::number(block.comprSize)).toStdString().c_str());
-        stream.ReadToBuffer(block.compressedBuffer, block.comprSize);
-        block.uncompressedBuffer = new quint8[maxBlockSize * 2];
-        if (block.uncompressedBuffer == nullptr)
-            CRASH_MSG((QString("Out of memory! - amount: ") +
-                       QString::number(maxBlockSize * 2)).toStdString().c_str());
-        blocks[b] = block;
-    }
+    return true;
+}
 
+// Decompress blocks in range, uncompressed buffers must be already assigned
+bool DecompressMemBlocks(CompressionDataType compType, QList<Package::ChunkBlock> &blocks,
+                         int first, int count)
+{
     bool failed = false;
     #pragma omp parallel for
-    for (int b = 0; b < blocks.count(); b++)
+    for (int b = first; b < first + count; b++)
     {
-        uint dstLen = ModsDataEnums::MaxBlockSize * 2;
-        Package::ChunkBlock block = blocks[b];
+        const Package::ChunkBlock &block = blocks[b];
+        uint dstLen = block.uncomprSize;
         if (compType == CompressionDataType::Zlib)
         {
             if (ZlibDecompress(block.compressedBuffer, block.comprSize, block.uncompressedBuffer, &dstLen) == -100)
@@ -725,7 +832,6 @@ ByteBuffer Misc::decompressData(Stream &stream, long compressedSize)
         }
         else if (compType == CompressionDataType::LZMA)
         {
-            dstLen = block.uncomprSize;
             if (LzmaDecompress(block.compressedBuffer, block.comprSize, block.uncompressedBuffer, &dstLen) != 0)
                 failed = true;
         }
@@ -737,19 +843,67 @@ ByteBuffer Misc::decompressData(Stream &stream, long compressedSize)
         }
     }
 
-    int dstPos = 0;
-    foreach (Package::ChunkBlock block, blocks)
+    return !failed;
+}
+
+// Read compressed data of next blocks window, buffers are reused between windows
+void ReadMemBlocksWindow(Stream &stream, QList<Package::ChunkBlock> &blocks, int first, int count,
+                         quint8 *compressedBuffers[], uint compressedBufferSizes[])
+{
+    for (int i = 0; i < count; i++)
     {
-        if (!failed)
+        Package::ChunkBlock &block = blocks[first + i];
+        if (compressedBufferSizes[i] < block.comprSize)
         {
-            memcpy(data.ptr() + dstPos, block.uncompressedBuffer, block.uncomprSize);
-            dstPos += block.uncomprSize;
+            delete[] compressedBuffers[i];
+            compressedBuffers[i] = new quint8[block.comprSize];
+            if (compressedBuffers[i] == nullptr)
+                CRASH_MSG((QString("Out of memory! - amount: ") +
+                           QString::number(block.comprSize)).toStdString().c_str());
+            compressedBufferSizes[i] = block.comprSize;
         }
-        delete[] block.uncompressedBuffer;
-        delete[] block.compressedBuffer;
+        block.compressedBuffer = compressedBuffers[i];
+        stream.ReadToBuffer(block.compressedBuffer, block.comprSize);
     }
+}
 
-    if (failed)
+} // namespace
+
+ByteBuffer Misc::decompressData(Stream &stream, long compressedSize)
+{
+    MemChunkHeader header;
+    if (!ReadMemChunkHeader(stream, compressedSize, header))
+        return ByteBuffer{};
+
+    auto data = ByteBuffer(header.uncompressedSize);
+    int windowSize = omp_get_max_threads();
+    std::unique_ptr<quint8 *[]> compressedBuffers(new quint8 *[windowSize]());
+    std::unique_ptr<uint[]> compressedBufferSizes(new uint[windowSize]());
+
+    bool failed = false;
+    quint64 dstPos = 0;
+    for (int first = 0; first < header.blocks.count() && !failed; first += windowSize)
+    {
+        int count = qMin(windowSize, header.blocks.count() - first);
+        for (int b = first; b < first + count; b++)
+        {
+            header.blocks[b].uncompressedBuffer = data.ptr() + dstPos;
+            dstPos += header.blocks[b].uncomprSize;
+        }
+        if (dstPos > (quint64)data.size())
+        {
+            failed = true;
+            break;
+        }
+        ReadMemBlocksWindow(stream, header.blocks, first, count,
+                            compressedBuffers.get(), compressedBufferSizes.get());
+        failed = !DecompressMemBlocks(header.compType, header.blocks, first, count);
+    }
+
+    for (int i = 0; i < windowSize; i++)
+        delete[] compressedBuffers[i];
+
+    if (failed || dstPos != (quint64)data.size())
     {
         data.Free();
         return ByteBuffer{};
@@ -757,3 +911,46 @@ ByteBuffer Misc::decompressData(Stream &stream, long compressedSize)
 
     return data;
 }
+
+bool Misc::decompressData(Stream &stream, long compressedSize, Stream &outputStream)
+{
+    MemChunkHeader header;
+    if (!ReadMemChunkHeader(stream, compressedSize, header))
+        return false;
+
+    int windowSize = omp_get_max_threads();
+    std::unique_ptr<quint8 *[]> compressedBuffers(new quint8 *[windowSize]());
+    std::unique_ptr<uint[]> compressedBufferSizes(new uint[windowSize]());
+    auto uncompressedBuffer = new quint8[(size_t)header.maxBlockSize * windowSize];
+    if (uncompressedBuffer == nullptr)
+        CRASH_MSG((QString("Out of memory! - amount: ") +
+                   QString::number((quint64)header.maxBlockSize * windowSize)).toStdString().c_str());
+
+    bool failed = false;
+    quint64 dstPos = 0;
+    for (int first = 0; first < header.blocks.count() && !failed; first += windowSize)
+    {
+        int count = qMin(windowSize, header.blocks.count() - first);
+        for (int i = 0; i < count; i++)
+            header.blocks[first + i].uncompressedBuffer = uncompressedBuffer + (size_t)header.maxBlockSize * i;
+        ReadMemBlocksWindow(stream, header.blocks, first, count,
+                            compressedBuffers.get(), compressedBufferSizes.get());
+        failed = !DecompressMemBlocks(header.compType, header.blocks, first, count);
+        if (failed)
+            break;
+        for (int b = first; b < first + count; b++)
+        {
+            outputStream.WriteFromBuffer(header.blocks[b].uncompressedBuffer, header.blocks[b].uncomprSize);
+            dstPos += header.blocks[b].uncomprSize;
+        }
+#ifdef GUI
+        QApplication::processEvents();
+#endif
+    }
+
+    for (int i = 0; i < windowSize; i++)
+        delete[] compressedBuffers[i];
+    delete[] uncompressedBuffer;
+
+    return !failed && dstPos == header.uncompressedSize;
+}
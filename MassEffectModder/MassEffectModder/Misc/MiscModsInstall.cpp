@@ -24,47 +24,16 @@
 #include <GameData/TOCFile.h>
 #include <GameData/UserSettings.h>
 #include <MipMaps/MipMaps.h>
+#include <MipMaps/MipMapsJournal.h>
 #include <Wrappers.h>
 #include <Helpers/MiscHelpers.h>
+#include <Helpers/PackagePrefetcher.h>
 #include <Helpers/Logs.h>
 #include <Helpers/FileStream.h>
 
-bool Misc::applyMods(QStringList &files, QList<TextureMapEntry> &textures,
-                     QStringList &pkgsToMarker,
-                     MipMaps &mipMaps, bool appendMarker,
-                     bool verify, int cacheAmount,
-                     ProgressCallback callback, void *callbackHandle)
+void Misc::prepareModsList(QStringList &files, QList<TextureMapEntry> &textures,
+                           QList<ModEntry> &modsToReplace, QStringList &skippedTextures)
 {
-    bool status = true;
-    int currentNumberOfTotalMods = 1;
-
-    QList<ModEntry> modsToReplace;
-
-    Misc::restartStageTimer();
-
-    for (int i = 0; i < files.count(); i++)
-    {
-        if (QFile(files[i]).size() == 0)
-        {
-            if (g_ipc)
-            {
-                ConsoleWrite(QString("[IPC]ERROR MEM mod file has 0 length: ") + files[i]);
-                ConsoleSync();
-            }
-            else
-            {
-                PERROR(QString("MEM mod file is 0 bytes in length: ") + files[i] + "\n");
-            }
-            continue;
-        }
-        FileStream fs = FileStream(files[i], FileMode::Open, FileAccess::ReadOnly);
-        if (!Misc::CheckMEMHeader(fs, files[i]))
-            continue;
-        fs.JumpTo(fs.ReadInt64());
-        fs.SkipInt32();
-        fs.SkipInt32();
-    }
-
     for (int i = 0; i < files.count(); i++)
     {
         if (g_ipc)
@@ -98,7 +67,7 @@ bool Misc::applyMods(QStringList &files, QList<TextureMapEntry> &textures,
             modFiles.push_back(fileMod);
         }
         numFiles = modFiles.count();
-        for (int l = 0; l < numFiles; l++, currentNumberOfTotalMods++)
+        for (int l = 0; l < numFiles; l++)
         {
             quint32 crc = 0, textureFlags = 0;
             fs.JumpTo(modFiles[l].offset);
@@ -144,14 +113,54 @@ bool Misc::applyMods(QStringList &files, QList<TextureMapEntry> &textures,
                 {
                     PINFO(QString("Texture skipped. Texture ") + modFiles[l].name +
                           " is not present in your game setup.\n");
+                    skippedTextures.push_back(modFiles[l].name + QString::asprintf("_0x%08X", crc));
                 }
             }
         }
     }
+}
+
+bool Misc::applyMods(QStringList &files, QList<TextureMapEntry> &textures,
+                     QStringList &pkgsToMarker,
+                     MipMaps &mipMaps, bool appendMarker,
+                     bool verify, int cacheAmount,
+                     ProgressCallback callback, void *callbackHandle,
+                     MipMapsJournal *journal)
+{
+    bool status = true;
+    QList<ModEntry> modsToReplace;
+
+    Misc::restartStageTimer();
+
+    for (int i = 0; i < files.count(); i++)
+    {
+        if (QFile(files[i]).size() == 0)
+        {
+            if (g_ipc)
+            {
+                ConsoleWrite(QString("[IPC]ERROR MEM mod file has 0 length: ") + files[i]);
+                ConsoleSync();
+            }
+            else
+            {
+                PERROR(QString("MEM mod file is 0 bytes in length: ") + files[i] + "\n");
+            }
+            continue;
+        }
+        FileStream fs = FileStream(files[i], FileMode::Open, FileAccess::ReadOnly);
+        if (!Misc::CheckMEMHeader(fs, files[i]))
+            continue;
+        fs.JumpTo(fs.ReadInt64());
+        fs.SkipInt32();
+        fs.SkipInt32();
+    }
+
+    QStringList skippedTextures;
+    prepareModsList(files, textures, modsToReplace, skippedTextures);
 
     mipMaps.replaceModsFromList(textures, pkgsToMarker, modsToReplace,
                                 appendMarker, verify, cacheAmount,
-                                callback, callbackHandle);
+                                callback, callbackHandle, journal);
 
     PINFO("Processing textures finished.\n\n");
 
@@ -161,6 +170,7 @@ bool Misc::applyMods(QStringList &files, QList<TextureMapEntry> &textures,
         ConsoleWrite(QString("[IPC]STAGE_TIMING %1").arg(elapsed));
         ConsoleSync();
     }
+    PackagePrefetcher::ReportStageStats();
 
     if (verify)
     {
@@ -183,6 +193,7 @@ bool Misc::applyMods(QStringList &files, QList<TextureMapEntry> &textures,
             ConsoleWrite(QString("[IPC]STAGE_TIMING %1").arg(elapsed));
             ConsoleSync();
         }
+        PackagePrefetcher::ReportStageStats();
     }
 
     return status;
@@ -191,9 +202,10 @@ bool Misc::applyMods(QStringList &files, QList<TextureMapEntry> &textures,
 bool Misc::InstallMods(MeType gameId, Resources &resources, QStringList &modFiles,
                        bool guiInstallerMode, bool alotInstallerMode,
                        bool skipMarkers, bool verify, int cacheAmount,
-                       ProgressCallback callback, void *callbackHandle)
+                       ProgressCallback callback, void *callbackHandle, bool resume)
 {
     MipMaps mipMaps;
+    MipMapsJournal journal;
     QStringList pkgsToRepack;
     QStringList pkgsToMarker;
 
@@ -222,9 +234,11 @@ bool Misc::InstallMods(MeType gameId, Resources &resources, QStringList &modFile
     Misc::startTimer();
 
     bool modded = detectMod(gameId);
+    if (resume && !journal.Resume(gameId, modFiles, modded))
+        return false;
     if (g_ipc)
     {
-        if (!modded)
+        if (!modded && !resume)
         {
             ConsoleWrite("[IPC]STAGE_ADD STAGE_PRESCAN");
             ConsoleWrite("[IPC]STAGE_ADD STAGE_SCAN");
@@ -249,14 +263,18 @@ bool Misc::InstallMods(MeType gameId, Resources &resources, QStringList &modFile
         }
         pkgsToMarker.removeOne(g_GameData->MainData() + "/SFXTest.pcc");
 
-        PINFO("Scan textures started...\n");
-        if (!TreeScan::PrepareListOfTextures(gameId, resources, textures, true,
-                                        callback, callbackHandle))
+        // Textures map was saved by interrupted installation before any package was changed
+        if (!resume)
         {
-            PERROR("Failed to scan textures!\n");
-            return false;
+            PINFO("Scan textures started...\n");
+            if (!TreeScan::PrepareListOfTextures(gameId, resources, textures, true,
+                                            callback, callbackHandle))
+            {
+                PERROR("Failed to scan textures!\n");
+                return false;
+            }
+            PINFO("Scan textures finished.\n\n");
         }
-        PINFO("Scan textures finished.\n\n");
     }
 
 
@@ -266,7 +284,7 @@ bool Misc::InstallMods(MeType gameId, Resources &resources, QStringList &modFile
         ConsoleWrite("[IPC]STAGE_CONTEXT STAGE_INSTALLTEXTURES");
         ConsoleSync();
     }
-    if (modded)
+    if (modded || resume)
     {
         QString path = QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation).first() +
                 "/MassEffectModder";
@@ -275,8 +293,10 @@ bool Misc::InstallMods(MeType gameId, Resources &resources, QStringList &modFile
             return false;
     }
 
+    if (!resume)
+        journal.Create(gameId, modFiles, modded);
     Misc::applyMods(modFiles, textures, pkgsToMarker, mipMaps,
-                    true, verify, cacheAmount, callback, callbackHandle);
+                    true, verify, cacheAmount, callback, callbackHandle, &journal);
 
 
 
@@ -290,6 +310,7 @@ bool Misc::InstallMods(MeType gameId, Resources &resources, QStringList &modFile
     }
 
     TOCBinFile::UpdateAllTOCBinFiles(gameId);
+    journal.Remove();
 
     if (g_ipc)
     {
@@ -305,6 +326,130 @@ bool Misc::InstallMods(MeType gameId, Resources &resources, QStringList &modFile
     return true;
 }
 
+bool Misc::PlanInstallMods(MeType gameId, Resources &resources, QStringList &modFiles, int cacheAmount,
+                           ProgressCallback callback, void *callbackHandle)
+{
+    MipMaps mipMaps;
+    QList<TextureMapEntry> textures;
+
+    Misc::startTimer();
+
+    PINFO("Install dry run started...\n");
+
+    bool modded = detectMod(gameId);
+    if (modded)
+    {
+        QString path = QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation).first() +
+                "/MassEffectModder";
+        QString mapFile = path + QString("/mele%1map.bin").arg((int)gameId);
+        if (!TreeScan::loadTexturesMapFile(mapFile, textures))
+            return false;
+    }
+    else
+    {
+        PINFO("Scan textures started...\n");
+        if (!TreeScan::PrepareListOfTextures(gameId, resources, textures, false,
+                                             callback, callbackHandle))
+        {
+            PERROR("Failed to scan textures!\n");
+            return false;
+        }
+        PINFO("Scan textures finished.\n\n");
+    }
+
+    QList<ModEntry> modsToReplace;
+    QStringList skippedTextures;
+    prepareModsList(modFiles, textures, modsToReplace, skippedTextures);
+
+    ModsInstallPlan plan;
+    mipMaps.planModsFromList(textures, modsToReplace, plan);
+
+    // Only chunk headers are read, payloads stay compressed
+    quint64 modsRead = 0, modsUncompressed = 0, maxModUncompressed = 0;
+    int texturesToConvert = 0;
+    for (int i = 0; i < modsToReplace.count(); i++)
+    {
+        const ModEntry &mod = modsToReplace[i];
+        if (mod.instance == 0)
+            continue;
+        FileStream fs = FileStream(mod.memPath, FileMode::Open, FileAccess::ReadOnly);
+        fs.JumpTo(mod.memEntryOffset);
+        fs.SkipInt32(); // compressed size
+        quint64 uncompressedSize = fs.ReadUInt32();
+        modsRead += mod.memEntrySize;
+        modsUncompressed += uncompressedSize;
+        maxModUncompressed = qMax(maxModUncompressed, uncompressedSize);
+        if (mod.markConvert)
+            texturesToConvert++;
+    }
+
+    quint64 packagesSize = 0, maxPackageSize = 0;
+    for (int i = 0; i < plan.packages.count(); i++)
+    {
+        quint64 size = g_GameData->InventoryFileSize(plan.packages[i].packagePath);
+        packagesSize += size;
+        maxPackageSize = qMax(maxPackageSize, size);
+    }
+
+    int memoryAmount;
+    quint64 cacheLimit = MipMaps::GetCacheLimit(cacheAmount, memoryAmount);
+    quint64 bytesRead = packagesSize + modsRead;
+    quint64 bytesWritten = packagesSize + modsUncompressed;
+    // Cached mips plus working set of largest texture and package
+    quint64 peakMemory = qMin(cacheLimit, modsUncompressed) + maxModUncompressed * 3 + maxPackageSize;
+    // Rough estimation assuming ~200MB/s of sustained disk throughput
+    quint64 estimatedTime = (bytesRead + bytesWritten) * 1000 / (200ULL * 1024 * 1024);
+
+    if (g_ipc)
+    {
+        for (int i = 0; i < plan.packages.count(); i++)
+        {
+            ConsoleWrite(QString("[IPC]DRYRUN_PACKAGE ") + plan.packages[i].packagePath);
+        }
+        for (int i = 0; i < skippedTextures.count(); i++)
+        {
+            ConsoleWrite(QString("[IPC]DRYRUN_SKIPPED_TEXTURE ") + skippedTextures[i]);
+        }
+        ConsoleWrite(QString("[IPC]DRYRUN_PACKAGES ") + QString::number(plan.packages.count()));
+        ConsoleWrite(QString("[IPC]DRYRUN_EXPORTS ") + QString::number(plan.exports));
+        ConsoleWrite(QString("[IPC]DRYRUN_OVERRIDES ") + QString::number(plan.overriddenMods));
+        ConsoleWrite(QString("[IPC]DRYRUN_TEXTURES_TO_CONVERT ") + QString::number(texturesToConvert));
+        ConsoleWrite(QString("[IPC]DRYRUN_BYTES_READ ") + QString::number(bytesRead));
+        ConsoleWrite(QString("[IPC]DRYRUN_BYTES_WRITTEN ") + QString::number(bytesWritten));
+        ConsoleWrite(QString("[IPC]DRYRUN_TFC_GROWTH ") + QString::number(modsUncompressed));
+        ConsoleWrite(QString("[IPC]DRYRUN_PEAK_MEMORY ") + QString::number(peakMemory));
+        ConsoleWrite(QString("[IPC]DRYRUN_ESTIMATED_TIME ") + QString::number(estimatedTime));
+        ConsoleSync();
+    }
+    else
+    {
+        for (int i = 0; i < plan.packages.count(); i++)
+        {
+            PINFO(QString("Package: ") + plan.packages[i].packagePath + ", textures: " +
+                  QString::number(plan.packages[i].textures.count()) + "\n");
+        }
+        PINFO("\nInstall plan:\n");
+        PINFO(QString("Packages to rewrite: ") + QString::number(plan.packages.count()) + "\n");
+        PINFO(QString("Exports to replace: ") + QString::number(plan.exports) + "\n");
+        PINFO(QString("Overridden textures: ") + QString::number(plan.overriddenMods) + "\n");
+        PINFO(QString("Skipped textures: ") + QString::number(skippedTextures.count()) + "\n");
+        PINFO(QString("Textures to convert: ") + QString::number(texturesToConvert) + "\n");
+        PINFO(QString("Bytes to read: ") + getBytesFormat(bytesRead) + "\n");
+        PINFO(QString("Bytes to write: ") + getBytesFormat(bytesWritten) + "\n");
+        PINFO(QString("TFC growth (upper bound): ") + getBytesFormat(modsUncompressed) + "\n");
+        PINFO(QString("Cache limit: ") + getBytesFormat(cacheLimit) + "\n");
+        PINFO(QString("Peak memory: ") + getBytesFormat(peakMemory) + "\n");
+        PINFO(QString("Estimated I/O time: ") + getTimerFormat(estimatedTime) + "\n");
+    }
+
+    long elapsed = Misc::elapsedTime();
+    PINFO(Misc::getTimerFormat(elapsed) + "\n");
+
+    PINFO("\nInstall dry run finished.\n\n");
+
+    return true;
+}
+
 bool Misc::ApplyPostInstall(MeType gameId, QStringList &mods)
 {
     applyModTag(mods);
@@ -19,6 +19,13 @@
  *
  */
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <atomic>
+
 #include <Misc/Misc.h>
 #include <GameData/GameData.h>
 #include <GameData/TOCFile.h>
@@ -53,8 +60,105 @@ void Misc::applyModTag(QStringList &mods)
     fs.WriteInt16(0);
     fs.WriteInt16(MEM_VERSION);
     fs.WriteUInt32(MEMI_TAG);
+    g_GameData->InvalidateInventoryFile(g_GameData->MainData() + "/SFXTest.pcc");
+}
+
+namespace {
+
+enum class PackageMarker
+{
+    Error,
+    Absent,
+    Present,
+};
+
+// Positional I/O on separate descriptors, safe to run from parallel workers
+PackageMarker ProcessPackageMarker(const QString &path, bool appendMarker)
+{
+    char marker[MEMMarkerLength];
+    PackageMarker status = PackageMarker::Absent;
+#if defined(_WIN32)
+    QFile file(path);
+    if (!file.open(appendMarker ? QIODevice::ReadWrite : QIODevice::ReadOnly))
+        return PackageMarker::Error;
+    qint64 size = file.size();
+    if (size >= (qint64)MEMMarkerLength)
+    {
+        if (!file.seek(size - MEMMarkerLength) ||
+            file.read(marker, MEMMarkerLength) != (qint64)MEMMarkerLength)
+        {
+            return PackageMarker::Error;
+        }
+        if (memcmp(marker, MEMendFileMarker, MEMMarkerLength) == 0)
+            status = PackageMarker::Present;
+    }
+    if (status == PackageMarker::Absent && appendMarker)
+    {
+        if (!file.seek(size) ||
+            file.write(MEMendFileMarker, MEMMarkerLength) != (qint64)MEMMarkerLength)
+        {
+            return PackageMarker::Error;
+        }
+    }
+#else
+    int fd = open(QFile::encodeName(path).constData(), appendMarker ? O_RDWR : O_RDONLY);
+    if (fd == -1)
+        return PackageMarker::Error;
+    struct stat st{};
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return PackageMarker::Error;
+    }
+    if (st.st_size >= (off_t)MEMMarkerLength)
+    {
+        if (pread(fd, marker, MEMMarkerLength, st.st_size - MEMMarkerLength) != (ssize_t)MEMMarkerLength)
+        {
+            close(fd);
+            return PackageMarker::Error;
+        }
+        if (memcmp(marker, MEMendFileMarker, MEMMarkerLength) == 0)
+            status = PackageMarker::Present;
+    }
+    if (status == PackageMarker::Absent && appendMarker)
+    {
+        if (pwrite(fd, MEMendFileMarker, MEMMarkerLength, st.st_size) != (ssize_t)MEMMarkerLength)
+            status = PackageMarker::Error;
+    }
+    close(fd);
+#endif
+    return status;
+}
+
+int MarkersWorkersCount()
+{
+    // Mostly waiting for I/O, use more workers than cores
+    return qMax(8, omp_get_max_threads() * 2);
+}
+
+// Called from the master thread only, keeps callbacks on the caller thread
+void ReportMarkersProgress(int processed, int total, int step, int &lastProgress, bool ipc,
+                           const QString &stage, Misc::ProgressCallback callback, void *callbackHandle)
+{
+    if (total == 0)
+        return;
+    int newProgress = processed * 100 / total;
+    if ((newProgress - lastProgress) < step)
+        return;
+    lastProgress = newProgress;
+    if (ipc)
+    {
+        ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+        ConsoleSync();
+    }
+    else if (callback)
+    {
+        callback(callbackHandle, newProgress, stage);
+    }
 }
 
+} // namespace
+
 bool Misc::CheckForMarkers(ProgressCallback callback, void *callbackHandle)
 {
     QStringList packages;
@@ -66,38 +170,48 @@ bool Misc::CheckForMarkers(ProgressCallback callback, void *callbackHandle)
         packages.push_back(g_GameData->packageFiles[i]);
     }
 
+    QVector<PackageMarker> markers(packages.count(), PackageMarker::Absent);
+    PackageMarker *markersPtr = markers.data();
+    std::atomic<int> processed(0);
     int lastProgress = -1;
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(MarkersWorkersCount())
+    for (int i = 0; i < packages.count(); i++)
+    {
+        markersPtr[i] = ProcessPackageMarker(g_GameData->GamePath() + packages.at(i), false);
+        processed++;
+        if (omp_get_thread_num() == 0)
+        {
+            ReportMarkersProgress(processed, packages.count(), 5, lastProgress, g_ipc,
+                                  "Checking for texture markers", callback, callbackHandle);
+        }
+    }
+    ReportMarkersProgress(packages.count(), packages.count(), 5, lastProgress, g_ipc,
+                          "Checking for texture markers", callback, callbackHandle);
+
     for (int i = 0; i < packages.count(); i++)
     {
-        int newProgress = (i + 1) * 100 / packages.count();
-        if ((newProgress - lastProgress) >= 5)
+        if (markers[i] == PackageMarker::Present)
         {
-            lastProgress = newProgress;
             if (g_ipc)
             {
-                ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+                ConsoleWrite(QString("[IPC]ERROR_FILEMARKER_FOUND ") + packages[i]);
                 ConsoleSync();
             }
-            else if (callback)
+            else
             {
-                callback(callbackHandle, newProgress, "Checking for texture markers");
+                PERROR(QString("Error: detected texture marker: ") + packages[i] + "\n");
             }
         }
-
-        FileStream fs = FileStream(g_GameData->GamePath() + packages[i], FileMode::Open, FileAccess::ReadOnly);
-        fs.Seek(-MEMMarkerLength, SeekOrigin::End);
-        QString marker;
-        fs.ReadStringASCII(marker, MEMMarkerLength);
-        if (marker == QString(MEMendFileMarker))
+        else if (markers[i] == PackageMarker::Error)
         {
             if (g_ipc)
             {
-                ConsoleWrite(QString("[IPC]ERROR_FILEMARKER_FOUND ") + packages[i]);
+                ConsoleWrite(QString("[IPC]ERROR Failed to read package file: ") + packages[i]);
                 ConsoleSync();
             }
             else
             {
-                PERROR(QString("Error: detected texture marker: ") + packages[i] + "\n");
+                PERROR(QString("Error: failed to read package file: ") + packages[i] + "\n");
             }
         }
     }
@@ -116,30 +230,26 @@ bool Misc::MarkersPresent(ProgressCallback callback, void *callbackHandle)
         packages.push_back(g_GameData->packageFiles[i]);
     }
 
+    std::atomic<bool> found(false);
+    std::atomic<int> processed(0);
     int lastProgress = -1;
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(MarkersWorkersCount())
     for (int i = 0; i < packages.count(); i++)
     {
-        int newProgress = (i + 1) * 100 / packages.count();
-        if ((newProgress - lastProgress) >= 5)
-        {
-            lastProgress = newProgress;
-            if (callback)
-            {
-                callback(callbackHandle, newProgress, "Checking for texture markers");
-            }
-        }
-
-        FileStream fs = FileStream(g_GameData->GamePath() + packages[i], FileMode::Open, FileAccess::ReadOnly);
-        fs.Seek(-MEMMarkerLength, SeekOrigin::End);
-        QString marker;
-        fs.ReadStringASCII(marker, MEMMarkerLength);
-        if (marker == QString(MEMendFileMarker))
+        // Skip remaining packages once any worker found a marker
+        if (found)
+            continue;
+        if (ProcessPackageMarker(g_GameData->GamePath() + packages.at(i), false) == PackageMarker::Present)
+            found = true;
+        processed++;
+        if (omp_get_thread_num() == 0)
         {
-            return true;
+            ReportMarkersProgress(processed, packages.count(), 5, lastProgress, false,
+                                  "Checking for texture markers", callback, callbackHandle);
         }
     }
 
-    return false;
+    return found;
 }
 
 void Misc::detectBrokenMod(QStringList &mods)
@@ -241,34 +351,40 @@ void Misc::AddMarkers(QStringList &pkgsToMarker,
         ConsoleWrite("[IPC]STAGE_CONTEXT STAGE_MARKERS");
         ConsoleSync();
     }
+    QVector<PackageMarker> markers(pkgsToMarker.count(), PackageMarker::Absent);
+    PackageMarker *markersPtr = markers.data();
+    std::atomic<int> processed(0);
     int lastProgress = -1;
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(MarkersWorkersCount())
+    for (int i = 0; i < pkgsToMarker.count(); i++)
+    {
+        markersPtr[i] = ProcessPackageMarker(g_GameData->GamePath() + pkgsToMarker.at(i), true);
+        processed++;
+        if (omp_get_thread_num() == 0)
+        {
+            ReportMarkersProgress(processed, pkgsToMarker.count(), 10, lastProgress, g_ipc,
+                                  "Adding texture markers", callback, callbackHandle);
+        }
+    }
+    ReportMarkersProgress(pkgsToMarker.count(), pkgsToMarker.count(), 10, lastProgress, g_ipc,
+                          "Adding texture markers", callback, callbackHandle);
+
     for (int i = 0; i < pkgsToMarker.count(); i++)
     {
-        int newProgress = (i + 1) * 100 / pkgsToMarker.count();
-        if ((newProgress - lastProgress) >= 10)
+        PDEBUG(QString("Misc::AddMarkers File: ") + pkgsToMarker[i] + "\n");
+        g_GameData->InvalidateInventoryFile(pkgsToMarker[i]);
+        if (markers[i] == PackageMarker::Error)
         {
-            lastProgress = newProgress;
             if (g_ipc)
             {
-                ConsoleWrite(QString("[IPC]TASK_PROGRESS ") + QString::number(newProgress));
+                ConsoleWrite(QString("[IPC]ERROR Failed to add marker to package file: ") + pkgsToMarker[i]);
                 ConsoleSync();
             }
-            else if (callback)
+            else
             {
-                callback(callbackHandle, newProgress, "Adding texture markers");
+                PERROR(QString("Error: failed to add marker to package file: ") + pkgsToMarker[i] + "\n");
             }
         }
-        PDEBUG(QString("Misc::AddMarkers File: ") + pkgsToMarker[i] + "\n");
-        FileStream fs = FileStream(g_GameData->GamePath() + pkgsToMarker[i], FileMode::Open, FileAccess::ReadWrite);
-        fs.Seek(-MEMMarkerLength, SeekOrigin::End);
-        QString marker;
-        fs.ReadStringASCII(marker, MEMMarkerLength);
-        QString str(MEMendFileMarker);
-        if (marker != str)
-        {
-            fs.SeekEnd();
-            fs.WriteStringASCII(str);
-        }
     }
     long elapsed = Misc::elapsedStageTime();
     if (g_ipc)
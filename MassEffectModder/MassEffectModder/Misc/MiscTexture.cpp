@@ -103,7 +103,7 @@ TextureMapEntry Misc::FoundTextureInTheInternalMap(MeType gameId, uint crc)
     return f;
 }
 
-uint Misc::GetCRCFromTextureMap(QList<TextureMapEntry> &textures, int exportId,
+uint Misc::GetCRCFromTextureMap(const QList<TextureMapEntry> &textures, int exportId,
                                 const QString &path)
 {
     for (int k = 0; k < textures.count(); k++)
@@ -0,0 +1,242 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include <Misc/ModConvertCache.h>
+#include <Misc/Misc.h>
+#include <Texture/TextureScan.h>
+#include <Image/Image.h>
+#include <Helpers/Logs.h>
+#include <Helpers/MiscHelpers.h>
+
+#define ConvertCacheTag       0x45434D4D // 'MMCE'
+#define ConvertCacheVersion   1
+
+namespace {
+
+QString convertCacheDefaultPath;
+quint64 convertCacheDefaultLimit = 4096ULL * 1024 * 1024;
+int convertCacheDefaultMaxAge = 0;
+
+struct CacheFileEntry
+{
+    QString path;
+    qint64 size;
+    QDateTime modified;
+};
+
+} // namespace
+
+ModConvertCache::ModConvertCache(const QString &path, quint64 limit, int maxAge)
+    : sizeLimit(limit), maxAgeDays(maxAge), hits(0), misses(0)
+{
+    if (path.isEmpty())
+        return;
+
+    QDir().mkpath(path);
+    if (!Misc::checkWriteAccessDir(path))
+    {
+        PERROR(QString("Conversion cache directory is not writable: ") + path +
+               ", cache disabled.\n");
+        return;
+    }
+    cacheDir = QDir::cleanPath(path);
+}
+
+QString ModConvertCache::EntryPath(const QByteArray &key)
+{
+    QString name = QString(key.toHex());
+    return cacheDir + "/" + name.left(2) + "/" + name + ".bin";
+}
+
+// Everything besides source content which affects converted texture payload
+QByteArray ModConvertCache::MakeParams(const TextureMapEntry &f, int numMips, bool forceHash, bool markToConvert,
+                                       bool bc7format, float bc7quality, CompressionDataType compType)
+{
+    QStringList params;
+    params << QString::number(TextureModVersion) << QString::number((int)compType)
+           << QString::number(forceHash);
+    if (!forceHash)
+    {
+        params << QString::number((int)f.pixfmt) << QString::number((int)f.type)
+               << QString::number(f.width) << QString::number(f.height)
+               << QString::number(numMips);
+    }
+    params << QString::number(markToConvert) << QString::number(bc7format)
+           << QString::number(bc7quality, 'g', 9)
+           << QString::number(128) // DXT1 alpha threshold used by CorrectTexture
+           << QString::number((int)Image::GetDxtQuality()) << QString::number((int)Image::GetBc7Profile())
+           << QString::number((int)Image::GetMipFilter());
+    return params.join('|').toUtf8();
+}
+
+QByteArray ModConvertCache::MakeKey(const QString &file, const QByteArray &params)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    FileStream fs = FileStream(file, FileMode::Open, FileAccess::ReadOnly);
+    std::unique_ptr<quint8[]> buffer (new quint8[0x100000]);
+    qint64 size = fs.Length();
+    while (size != 0)
+    {
+        qint64 count = qMin(size, (qint64)0x100000);
+        fs.ReadToBuffer(buffer.get(), count);
+        hash.addData(reinterpret_cast<const char *>(buffer.get()), count);
+        size -= count;
+    }
+    hash.addData(params);
+    hash.addData(QByteArray(MEM_VERSION));
+    return hash.result();
+}
+
+bool ModConvertCache::Fetch(const QByteArray &key, FileStream &outFs, qint64 &size)
+{
+    if (!Enabled())
+        return false;
+
+    QString path = EntryPath(key);
+    QFileInfo info(path);
+    // Header: tag, version, key, payload size
+    qint64 headerSize = 4 + 4 + key.size() + 8;
+    if (!info.exists() || info.size() < headerSize)
+    {
+        misses++;
+        return false;
+    }
+
+    FileStream fs = FileStream(path, FileMode::Open, FileAccess::ReadOnly);
+    quint32 tag = fs.ReadUInt32();
+    quint32 version = fs.ReadUInt32();
+    ByteBuffer storedKey = fs.ReadToBuffer(key.size());
+    bool keyMatch = memcmp(storedKey.ptr(), key.constData(), key.size()) == 0;
+    storedKey.Free();
+    size = fs.ReadInt64();
+    if (tag != ConvertCacheTag || version != ConvertCacheVersion || !keyMatch ||
+        size <= 0 || headerSize + size != info.size())
+    {
+        fs.Close();
+        QFile(path).remove();
+        misses++;
+        return false;
+    }
+    outFs.CopyFromFile(fs, size);
+    fs.Close();
+
+    // Modification time tracks last use for eviction
+    QFile entry(path);
+    if (entry.open(QIODevice::ReadWrite))
+        entry.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    hits++;
+    return true;
+}
+
+void ModConvertCache::Store(const QByteArray &key, Stream &payload, qint64 size)
+{
+    if (!Enabled())
+        return;
+
+    QString path = EntryPath(key);
+    QDir().mkpath(DirName(path));
+    QString tempPath = path + QString(".%1.tmp").arg(QCoreApplication::applicationPid());
+    {
+        FileStream fs = FileStream(tempPath, FileMode::Create, FileAccess::WriteOnly);
+        fs.WriteUInt32(ConvertCacheTag);
+        fs.WriteUInt32(ConvertCacheVersion);
+        fs.WriteFromBuffer((quint8 *)key.constData(), key.size());
+        fs.WriteInt64(size);
+        fs.CopyFrom(payload, size);
+    }
+    // Another build could store same entry meanwhile, keep the one already in place
+    if (!QFile::rename(tempPath, path))
+        QFile(tempPath).remove();
+}
+
+void ModConvertCache::Trim()
+{
+    if (!Enabled())
+        return;
+
+    QList<CacheFileEntry> entries;
+    quint64 totalSize = 0;
+    QDateTime expire = QDateTime::currentDateTime().addDays(-maxAgeDays);
+    int evicted = 0;
+    QDirIterator iterator(cacheDir, QStringList() << "*.bin", QDir::Files, QDirIterator::Subdirectories);
+    while (iterator.hasNext())
+    {
+        iterator.next();
+        QFileInfo info = iterator.fileInfo();
+        if (maxAgeDays > 0 && info.lastModified() < expire)
+        {
+            QFile(info.absoluteFilePath()).remove();
+            evicted++;
+            continue;
+        }
+        entries.push_back({ info.absoluteFilePath(), info.size(), info.lastModified() });
+        totalSize += info.size();
+    }
+
+    if (totalSize > sizeLimit)
+    {
+        std::sort(entries.begin(), entries.end(), [](const CacheFileEntry &e1, const CacheFileEntry &e2) {
+            return e1.modified < e2.modified;
+        });
+        for (int i = 0; i < entries.count() && totalSize > sizeLimit; i++)
+        {
+            QFile(entries[i].path).remove();
+            totalSize -= entries[i].size;
+            evicted++;
+        }
+    }
+
+    if (evicted != 0)
+        PINFO(QString("Conversion cache: evicted ") + QString::number(evicted) + " entries, " +
+              Misc::getBytesFormat(totalSize) + " in use.\n");
+}
+
+void ModConvertCache::ReportStats()
+{
+    if (!Enabled() || hits + misses == 0)
+        return;
+
+    PINFO(QString("Conversion cache: ") + QString::number(hits) + " hits, " +
+          QString::number(misses) + " misses.\n");
+}
+
+QString ModConvertCache::DefaultPath()
+{
+    return convertCacheDefaultPath;
+}
+
+quint64 ModConvertCache::DefaultLimit()
+{
+    return convertCacheDefaultLimit;
+}
+
+int ModConvertCache::DefaultMaxAge()
+{
+    return convertCacheDefaultMaxAge;
+}
+
+void ModConvertCache::SetDefaults(const QString &path, quint64 limit, int maxAge)
+{
+    convertCacheDefaultPath = path;
+    convertCacheDefaultLimit = limit;
+    convertCacheDefaultMaxAge = maxAge;
+}
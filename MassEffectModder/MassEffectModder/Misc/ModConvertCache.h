@@ -0,0 +1,64 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef MOD_CONVERT_CACHE_H
+#define MOD_CONVERT_CACHE_H
+
+#include <Helpers/FileStream.h>
+#include <Types/MemTypes.h>
+
+struct TextureMapEntry;
+
+// On-disk store of compressed MEM entry payloads, addressed by hash of source
+// file content and conversion parameters
+class ModConvertCache
+{
+private:
+
+    QString cacheDir;
+    quint64 sizeLimit;
+    int maxAgeDays;
+    int hits;
+    int misses;
+
+    QString EntryPath(const QByteArray &key);
+
+public:
+
+    ModConvertCache(const QString &path, quint64 limit, int maxAge);
+
+    bool Enabled() { return !cacheDir.isEmpty(); }
+    static QByteArray MakeParams(const TextureMapEntry &f, int numMips, bool forceHash, bool markToConvert,
+                                 bool bc7format, float bc7quality, CompressionDataType compType);
+    static QByteArray MakeKey(const QString &file, const QByteArray &params);
+    bool Fetch(const QByteArray &key, FileStream &outFs, qint64 &size);
+    void Store(const QByteArray &key, Stream &payload, qint64 size);
+    void Trim();
+    void ReportStats();
+
+    static QString DefaultPath();
+    static quint64 DefaultLimit();
+    static int DefaultMaxAge();
+    static void SetDefaults(const QString &path, quint64 limit, int maxAge);
+};
+
+#endif
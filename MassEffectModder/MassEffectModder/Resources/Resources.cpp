@@ -24,6 +24,15 @@
 #include <Helpers/FileStream.h>
 #include <Wrappers.h>
 
+namespace {
+
+bool keepTablesLoaded = false;
+bool tablesCached = false;
+QStringList cachedTablePkgs[3];
+QList<MD5FileEntry> cachedEntries[3];
+
+} // namespace
+
 void Resources::loadMD5Table(const QString &path, QStringList &tables, QList<MD5FileEntry> &entries)
 {
     ByteBuffer decompressed;
@@ -72,13 +81,50 @@ void Resources::loadMD5Tables()
     if (MD5tablesLoaded)
         CRASH();
 
+    if (tablesCached)
+    {
+        tablePkgsME1 = cachedTablePkgs[0];
+        tablePkgsME2 = cachedTablePkgs[1];
+        tablePkgsME3 = cachedTablePkgs[2];
+        entriesME1 = cachedEntries[0];
+        entriesME2 = cachedEntries[1];
+        entriesME3 = cachedEntries[2];
+        MD5tablesLoaded = true;
+        return;
+    }
+
     loadMD5Table(":/MD5EntriesME1.bin", tablePkgsME1, entriesME1);
     loadMD5Table(":/MD5EntriesME2.bin", tablePkgsME2, entriesME2);
     loadMD5Table(":/MD5EntriesME3.bin", tablePkgsME3, entriesME3);
 
+    if (keepTablesLoaded)
+    {
+        cachedTablePkgs[0] = tablePkgsME1;
+        cachedTablePkgs[1] = tablePkgsME2;
+        cachedTablePkgs[2] = tablePkgsME3;
+        cachedEntries[0] = entriesME1;
+        cachedEntries[1] = entriesME2;
+        cachedEntries[2] = entriesME3;
+        tablesCached = true;
+    }
+
     MD5tablesLoaded = true;
 }
 
+void Resources::KeepTablesLoaded(bool enable)
+{
+    keepTablesLoaded = enable;
+    if (enable)
+        return;
+
+    for (int i = 0; i < 3; i++)
+    {
+        cachedTablePkgs[i].clear();
+        cachedEntries[i].clear();
+    }
+    tablesCached = false;
+}
+
 void Resources::unloadMD5Tables()
 {
     if (!MD5tablesLoaded)
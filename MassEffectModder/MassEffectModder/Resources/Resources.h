@@ -74,6 +74,8 @@ public:
     ~Resources() { unloadMD5Tables(); }
     void loadMD5Tables();
     void unloadMD5Tables();
+    // Parsed tables are shared by later instances, used by long running modes
+    static void KeepTablesLoaded(bool enable);
 };
 
 #endif
@@ -89,6 +89,108 @@ void TextureMovie::replaceMovieData(ByteBuffer newData, uint offset)
         CRASH();
 }
 
+void TextureMovie::replaceMovieData(quint32 size, uint offset)
+{
+    if (storageType != StorageTypes::extUnc)
+        CRASH();
+
+    compressedSize = size;
+    uncompressedSize = size;
+
+    delete textureData;
+    textureData = new MemoryStream();
+    if (GameData::gameType != MeType::ME3_TYPE)
+    {
+        textureData->WriteZeros(16);
+    }
+    textureData->WriteUInt32(storageType);
+    textureData->WriteInt32(uncompressedSize);
+    textureData->WriteInt32(compressedSize);
+    dataOffset = offset;
+    textureData->WriteUInt32(dataOffset);
+}
+
+FileStream *TextureMovie::openArchive()
+{
+    QString filename;
+    QString archive = properties->getProperty("TextureFileCacheName").getValueName();
+    filename = g_GameData->MainData() + "/" + archive + ".tfc";
+    if (packagePath.contains("/DLC", Qt::CaseInsensitive))
+    {
+        QString DLCArchiveFile = g_GameData->GamePath() + DirName(packagePath) + "/" + archive + ".tfc";
+        if (QFile(DLCArchiveFile).exists())
+            filename = DLCArchiveFile;
+        else if (!QFile(filename).exists())
+        {
+            QStringList files = FilterByFilename(g_GameData->tfcFiles, archive + ".tfc");
+            if (files.count() == 1)
+                filename = g_GameData->GamePath() + files.first();
+            else if (files.count() == 0)
+            {
+                if (g_ipc)
+                {
+                    ConsoleWrite("[IPC]ERROR_REFERENCED_TFC_NOT_FOUND " + archive + ".tfc");
+                    ConsoleSync();
+                }
+                else
+                {
+                    PERROR(QString("Referenced TFC file not found, do you have a patch for a mod that is not installed?: ") + archive + ".tfc" + "\n");
+                }
+                return nullptr;
+            }
+            else
+            {
+                QString list;
+                foreach(QString file, files)
+                    list += file + "\n";
+                PERROR((QString("Multiple instances of TFC file found, this is not supported: ") + archive + ".tfc\n" +
+                           list).toStdString().c_str());
+                return nullptr;
+            }
+        }
+    }
+
+    if (!QFile(filename).exists())
+    {
+        if (g_ipc)
+        {
+            ConsoleWrite("[IPC]ERROR_REFERENCED_TFC_NOT_FOUND " + g_GameData->RelativeGameData(filename));
+            ConsoleSync();
+        }
+        else
+        {
+            PERROR(QString("Referenced TFC file not found, do you have a patch for a mod that is not installed?: " + filename + "\n"));
+        }
+        PERROR(QString("\nPackage: ") + packagePath +
+               "\nStorageType: " + QString::number(storageType) +
+               "\nExport UIndex: " + QString::number(dataExportId + 1) +
+               "\nExternal file offset: " + QString::number(dataOffset) + "\n");
+        return nullptr;
+    }
+    auto fs = new FileStream(filename, FileMode::Open, FileAccess::ReadOnly);
+    fs->JumpTo(dataOffset);
+    quint32 tag = fs->ReadUInt32();
+    if (tag != BIK1_TAG && tag != BIK2_TAG && tag != BIK2_202205_TAG)
+    {
+        if (g_ipc)
+        {
+            ConsoleWrite("[IPC]ERROR Unsupported bink movie texture version version");
+            ConsoleSync();
+        }
+        else
+        {
+            PERROR(QString("Unsupported texture movie texture version\n"));
+        }
+        PERROR(QString("\nPackage: ") + packagePath +
+               "\nStorageType: " + QString::number(storageType) +
+               "\nExport UIndex: " + QString::number(dataExportId + 1) + "\n");
+        delete fs;
+        return nullptr;
+    }
+    fs->JumpTo(dataOffset);
+    return fs;
+}
+
 const ByteBuffer TextureMovie::getData()
 {
     ByteBuffer data;
@@ -112,82 +214,10 @@ const ByteBuffer TextureMovie::getData()
     case StorageTypes::extUnc:
     case StorageTypes::extUnc2:
         {
-            QString filename;
-            QString archive = properties->getProperty("TextureFileCacheName").getValueName();
-            filename = g_GameData->MainData() + "/" + archive + ".tfc";
-            if (packagePath.contains("/DLC", Qt::CaseInsensitive))
-            {
-                QString DLCArchiveFile = g_GameData->GamePath() + DirName(packagePath) + "/" + archive + ".tfc";
-                if (QFile(DLCArchiveFile).exists())
-                    filename = DLCArchiveFile;
-                else if (!QFile(filename).exists())
-                {
-                    QStringList files = FilterByFilename(g_GameData->tfcFiles, archive + ".tfc");
-                    if (files.count() == 1)
-                        filename = g_GameData->GamePath() + files.first();
-                    else if (files.count() == 0)
-                    {
-                        if (g_ipc)
-                        {
-                            ConsoleWrite("[IPC]ERROR_REFERENCED_TFC_NOT_FOUND " + archive + ".tfc");
-                            ConsoleSync();
-                        }
-                        else
-                        {
-                            PERROR(QString("Referenced TFC file not found, do you have a patch for a mod that is not installed?: ") + archive + ".tfc" + "\n");
-                        }
-                        return ByteBuffer();
-                    }
-                    else
-                    {
-                        QString list;
-                        foreach(QString file, files)
-                            list += file + "\n";
-                        PERROR((QString("Multiple instances of TFC file found, this is not supported: ") + archive + ".tfc\n" +
-                                   list).toStdString().c_str());
-                        return ByteBuffer();
-                    }
-                }
-            }
-
-            if (!QFile(filename).exists())
-            {
-                if (g_ipc)
-                {
-                    ConsoleWrite("[IPC]ERROR_REFERENCED_TFC_NOT_FOUND " + g_GameData->RelativeGameData(filename));
-                    ConsoleSync();
-                }
-                else
-                {
-                    PERROR(QString("Referenced TFC file not found, do you have a patch for a mod that is not installed?: " + filename + "\n"));
-                }
-                PERROR(QString("\nPackage: ") + packagePath +
-                       "\nStorageType: " + QString::number(storageType) +
-                       "\nExport UIndex: " + QString::number(dataExportId + 1) +
-                       "\nExternal file offset: " + QString::number(dataOffset) + "\n");
+            std::unique_ptr<FileStream> fs(openArchive());
+            if (fs == nullptr)
                 return ByteBuffer();
-            }
-            auto fs = FileStream(filename, FileMode::Open, FileAccess::ReadOnly);
-            fs.JumpTo(dataOffset);
-            quint32 tag = fs.ReadUInt32();
-            if (tag != BIK1_TAG && tag != BIK2_TAG && tag != BIK2_202205_TAG)
-            {
-                if (g_ipc)
-                {
-                    ConsoleWrite("[IPC]ERROR Unsupported bink movie texture version version");
-                    ConsoleSync();
-                }
-                else
-                {
-                    PERROR(QString("Unsupported texture movie texture version\n"));
-                }
-                PERROR(QString("\nPackage: ") + packagePath +
-                       "\nStorageType: " + QString::number(storageType) +
-                       "\nExport UIndex: " + QString::number(dataExportId + 1) + "\n");
-                return ByteBuffer();
-            }
-            fs.JumpTo(dataOffset);
-            data = fs.ReadToBuffer(uncompressedSize);
+            data = fs->ReadToBuffer(uncompressedSize);
             break;
         }
     case StorageTypes::empty:
@@ -199,10 +229,49 @@ const ByteBuffer TextureMovie::getData()
 
 uint TextureMovie::getCrcData()
 {
-    ByteBuffer data = getData();
-    uint crc = ~crc32_16bytes_prefetch(data.ptr(), data.size());
-    data.Free();
-    return crc;
+    if (storageType != StorageTypes::extUnc && storageType != StorageTypes::extUnc2)
+    {
+        ByteBuffer data = getData();
+        uint crc = ~crc32_16bytes_prefetch(data.ptr(), data.size());
+        data.Free();
+        return crc;
+    }
+
+    // Movies are large, checksum them in chunks instead of loading whole
+    uint crc = 0;
+    std::unique_ptr<FileStream> fs(openArchive());
+    if (fs != nullptr)
+    {
+        ByteBuffer buffer(qMin((quint32)crcBufferSize, uncompressedSize));
+        quint32 left = uncompressedSize;
+        while (left != 0)
+        {
+            quint32 size = qMin(left, (quint32)buffer.size());
+            fs->ReadToBuffer(buffer.ptr(), size);
+            crc = crc32_16bytes_prefetch(buffer.ptr(), size, crc);
+            left -= size;
+        }
+        buffer.Free();
+    }
+    return ~crc;
+}
+
+bool TextureMovie::copyData(FileStream &output)
+{
+    if (storageType == StorageTypes::pccUnc)
+    {
+        textureData->JumpTo(dataOffset);
+        output.CopyFrom(*textureData, uncompressedSize);
+        return true;
+    }
+    if (storageType != StorageTypes::extUnc && storageType != StorageTypes::extUnc2)
+        CRASH_MSG("Texture Movies cannot be stored as compressed data! This is not supported.");
+
+    std::unique_ptr<FileStream> fs(openArchive());
+    if (fs == nullptr)
+        return false;
+    output.CopyFromFile(*fs, uncompressedSize);
+    return true;
 }
 
 const ByteBuffer TextureMovie::toArray()
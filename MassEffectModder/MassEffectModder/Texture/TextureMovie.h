@@ -40,6 +40,13 @@ private:
     quint32 compressedSize;
     quint32 dataOffset;
 
+    enum
+    {
+        crcBufferSize = 0x400000, // 4MB
+    };
+
+    FileStream *openArchive();
+
 public:
 
     TextureMovie(Package &package, int exportId, const ByteBuffer &data);
@@ -49,8 +56,10 @@ public:
     quint32 getUncompressedSize() { return uncompressedSize; }
     quint32 getDataOffset() { return dataOffset; }
     void replaceMovieData(ByteBuffer data, uint offset);
+    void replaceMovieData(quint32 size, uint offset);
     bool hasTextureData() { return textureData != nullptr; }
     const ByteBuffer getData();
+    bool copyData(FileStream &output);
     uint getCrcData();
     const ByteBuffer toArray();
 };
@@ -20,6 +20,7 @@
  */
 
 #include <Helpers/MiscHelpers.h>
+#include <Helpers/PackagePrefetcher.h>
 #include <Helpers/Logs.h>
 #include <Wrappers.h>
 #include <Texture/TextureScan.h>
@@ -40,8 +41,31 @@ namespace {
 
 bool generateBuiltinMapFiles = false; // change to true to enable map files generation
 
+bool keepMapsLoaded = false;
+QHash<int, QList<TextureMapEntry>> cachedBuiltinMaps;
+
+struct CachedMapFile
+{
+    QString path;
+    qint64 size;
+    qint64 modified;
+    QList<TextureMapEntry> textures;
+    QStringList packages;
+};
+CachedMapFile cachedMapFile;
+
 } // namespace
 
+void TreeScan::KeepMapsLoaded(bool enable)
+{
+    keepMapsLoaded = enable;
+    if (enable)
+        return;
+
+    cachedBuiltinMaps.clear();
+    cachedMapFile = CachedMapFile();
+}
+
 bool TreeScan::IsBlankTexture(uint crc)
 {
     const uint crcTable[] = {
@@ -99,6 +123,13 @@ bool TreeScan::IsBlankTexture(uint crc)
 
 void TreeScan::loadTexturesMap(MeType gameId, Resources &resources, QList<TextureMapEntry> &textures)
 {
+    if (keepMapsLoaded && cachedBuiltinMaps.contains(gameId))
+    {
+        textures.append(cachedBuiltinMaps[gameId]);
+        return;
+    }
+
+    int firstTexture = textures.count();
     QStringList pkgs;
     if (gameId == MeType::ME1_TYPE)
         pkgs = resources.tablePkgsME1;
@@ -148,6 +179,9 @@ void TreeScan::loadTexturesMap(MeType gameId, Resources &resources, QList<Textur
         }
         textures.push_back(texture);
     }
+
+    if (keepMapsLoaded)
+        cachedBuiltinMaps.insert(gameId, textures.mid(firstTexture));
 }
 
 bool TreeScan::loadTexturesMapFile(QString &path, QList<TextureMapEntry> &textures, bool ignoreCheck)
@@ -169,30 +203,51 @@ bool TreeScan::loadTexturesMapFile(QString &path, QList<TextureMapEntry> &textur
     bool foundRemoved = false;
     bool foundAdded = false;
 
-    FileStream fs = FileStream(path, FileMode::Open, FileAccess::ReadOnly);
-    uint tag = fs.ReadUInt32();
-    uint version = fs.ReadUInt32();
-    if (tag != textureMapBinTag || version > textureMapBinVersion)
+    QStringList packages = QStringList();
+
+    QFileInfo info(path);
+    qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    if (keepMapsLoaded && cachedMapFile.path == path &&
+        cachedMapFile.size == info.size() && cachedMapFile.modified == modified)
     {
-        if (g_ipc)
+        textures.append(cachedMapFile.textures);
+        packages = cachedMapFile.packages;
+    }
+    else
+    {
+        FileStream fs = FileStream(path, FileMode::Open, FileAccess::ReadOnly);
+        uint tag = fs.ReadUInt32();
+        uint version = fs.ReadUInt32();
+        if (tag != textureMapBinTag || version > textureMapBinVersion)
         {
-            ConsoleWrite("[IPC]ERROR_TEXTURE_MAP_WRONG");
-            ConsoleSync();
+            if (g_ipc)
+            {
+                ConsoleWrite("[IPC]ERROR_TEXTURE_MAP_WRONG");
+                ConsoleSync();
+            }
+            else
+            {
+                PERROR("Detected corrupt or old version of texture map scan file!\n");
+            }
+            return false;
         }
+
+        int firstTexture = textures.count();
+        if (version == 1)
+            loadTexturesMapFileV1(fs, textures, packages);
         else
+            CRASH();
+
+        if (keepMapsLoaded)
         {
-            PERROR("Detected corrupt or old version of texture map scan file!\n");
+            cachedMapFile.path = path;
+            cachedMapFile.size = info.size();
+            cachedMapFile.modified = modified;
+            cachedMapFile.textures = textures.mid(firstTexture);
+            cachedMapFile.packages = packages;
         }
-        return false;
     }
 
-    QStringList packages = QStringList();
-
-    if (version == 1)
-        loadTexturesMapFileV1(fs, textures, packages);
-    else
-        CRASH();
-
     if (!ignoreCheck)
     {
         for (int i = 0; i < packages.count(); i++)
@@ -403,6 +458,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
         ConsoleWrite(QString("[IPC]STAGE_TIMING %1").arg(elapsed));
         ConsoleSync();
     }
+    PackagePrefetcher::ReportStageStats();
 
     Misc::restartStageTimer();
     if (g_ipc)
@@ -428,7 +484,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
             bool modified = true;
             bool foundPkg = false;
             QString package = g_GameData->packageFiles[i].toLower();
-            long packageSize = QFile(g_GameData->GamePath() + g_GameData->packageFiles[i]).size();
+            long packageSize = g_GameData->InventoryFileSize(g_GameData->packageFiles[i]);
             auto range = std::equal_range(md5Entries.begin(), md5Entries.end(),
                                           package, Resources::ComparePath());
             for (auto it = range.first; it != range.second; it++)
@@ -457,6 +513,13 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
                 QString::number(((float)totalPackages / g_GameData->packageFiles.count())));
             ConsoleSync();
         }
+        QStringList packagesList;
+        for (int i = 0; i < modifiedFiles.count(); i++)
+            packagesList.append(g_GameData->GamePath() + modifiedFiles[i]);
+        for (int i = 0; i < addedFiles.count(); i++)
+            packagesList.append(g_GameData->GamePath() + addedFiles[i]);
+        PackagePrefetcher prefetcher(packagesList);
+
         for (int i = 0; i < modifiedFiles.count(); i++, currentPackage++)
         {
 #ifdef GUI
@@ -466,6 +529,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
                 timer.restart();
             }
 #endif
+            prefetcher.Advance(currentPackage);
             if (g_ipc)
             {
                 ConsoleWrite(QString("[IPC]PROCESSING_FILE ") + modifiedFiles[i]);
@@ -505,6 +569,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
                 timer.restart();
             }
 #endif
+            prefetcher.Advance(currentPackage);
             if (g_ipc)
             {
                 ConsoleWrite(QString("[IPC]PROCESSING_FILE ") + addedFiles[i]);
@@ -538,6 +603,11 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
     else
     {
         int lastProgress = -1;
+        QStringList packagesList;
+        for (int i = 0; i < g_GameData->packageFiles.count(); i++)
+            packagesList.append(g_GameData->GamePath() + g_GameData->packageFiles[i]);
+        PackagePrefetcher prefetcher(packagesList);
+
         for (int i = 0; i < g_GameData->packageFiles.count(); i++)
         {
 #ifdef GUI
@@ -547,6 +617,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
                 timer.restart();
             }
 #endif
+            prefetcher.Advance(i);
             if (g_ipc)
             {
                 ConsoleWrite(QString("[IPC]PROCESSING_FILE ") + g_GameData->packageFiles[i]);
@@ -672,6 +743,7 @@ bool TreeScan::PrepareListOfTextures(MeType gameId, Resources &resources,
         ConsoleWrite(QString("[IPC]STAGE_TIMING %1").arg(elapsed));
         ConsoleSync();
     }
+    PackagePrefetcher::ReportStageStats();
 
     return true;
 }
@@ -913,10 +985,8 @@ bool TreeScan::FindTextures(QList<TextureMapEntry> &textures, const QString &pac
                             foundTex.pixfmt == PixelFormat::R16G16B16A16)
                         {
                             ByteBuffer data = texture->getTopImageData();
-                            auto pixels = Image::convertRawToInternal(data, foundTex.width, foundTex.height, foundTex.pixfmt);
-                            matchTexture.hasAlphaData = Image::InternalDetectAlphaData(pixels, foundTex.width, foundTex.height);
+                            matchTexture.hasAlphaData = Image::RawDetectAlphaData(data, foundTex.width, foundTex.height, foundTex.pixfmt);
                             data.Free();
-                            pixels.Free();
                         }
                     }
                 }
@@ -73,6 +73,8 @@ public:
                                      QList<TextureMapEntry> &textures, bool saveMapFile,
                                      ProgressCallback callback, void *callbackHandle);
     static bool IsBlankTexture(uint crc);
+    // Parsed texture maps are kept for later loads, used by long running modes
+    static void KeepMapsLoaded(bool enable);
 };
 
 
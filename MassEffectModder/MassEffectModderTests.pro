@@ -0,0 +1,16 @@
+TEMPLATE = subdirs
+
+CONFIG += ordered
+
+SUBDIRS += \
+    Libs/bc7 \
+    Libs/dxtc
+
+!win32 {
+SUBDIRS += Libs/omp
+}
+
+SUBDIRS += \
+    Libs/png \
+    Libs/zlib \
+    Tests
@@ -0,0 +1,353 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Image/Image.h>
+#include <Helpers/Logs.h>
+
+namespace {
+
+const int BenchImageSize = 1024;
+const int BenchBc7ImageSize = 256;
+const float BenchBc7Quality = 0.2f;
+const qint64 BenchMinTimeMs = 500;
+const int BenchMipImageSize = 2048;
+const float Pi = 3.14159265358979323846f;
+
+// Mix of content found in game textures: smooth gradients, soft noise,
+// sharp edges and fine detail, values are whole bytes stored as floats
+ByteBuffer MakeBenchImage(int w, int h, quint32 seed)
+{
+    const int grid = 17;
+    float noise[grid][grid][4];
+    for (int y = 0; y < grid; y++)
+    {
+        for (int x = 0; x < grid; x++)
+        {
+            for (int c = 0; c < 4; c++)
+                noise[y][x][c] = (TestRandom(seed) & 0xFF) / 255.0f;
+        }
+    }
+
+    ByteBuffer image(w * h * 4 * sizeof(float));
+    float *ptr = image.ptrAsFloat();
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            float fx = (float)x / w, fy = (float)y / h;
+            float value[4];
+            if (fy < 0.25f)
+            {
+                value[0] = 0.5f + 0.5f * sinf(fx * 17.0f) * cosf(fy * 23.0f);
+                value[1] = fx;
+                value[2] = 1.0f - fy;
+            }
+            else if (fy < 0.5f)
+            {
+                float gx = fx * (grid - 1), gy = (fy - 0.25f) * 4 * (grid - 1);
+                int ix = (int)gx, iy = (int)gy;
+                float tx = gx - ix, ty = gy - iy;
+                for (int c = 0; c < 3; c++)
+                {
+                    value[c] = (noise[iy][ix][c] * (1 - tx) + noise[iy][ix + 1][c] * tx) * (1 - ty) +
+                               (noise[iy + 1][ix][c] * (1 - tx) + noise[iy + 1][ix + 1][c] * tx) * ty;
+                }
+            }
+            else if (fy < 0.75f)
+            {
+                bool inside = ((x / 24) ^ (y / 40)) & 1;
+                value[0] = inside ? 0.9f : 0.1f;
+                value[1] = inside ? 0.8f : 0.2f;
+                value[2] = (x % 64) < 8 ? 1.0f : 0.3f;
+            }
+            else
+            {
+                for (int c = 0; c < 3; c++)
+                    value[c] = 0.5f + ((int)(TestRandom(seed) & 0x3F) - 32) / 255.0f;
+            }
+            value[3] = qBound(0.0f, 1.5f - 2.0f * sqrtf((fx - 0.5f) * (fx - 0.5f) + (fy - 0.5f) * (fy - 0.5f)), 1.0f);
+            for (int c = 0; c < 4; c++)
+                ptr[(y * w + x) * 4 + c] = ROUND_FLOAT_TO_BYTE(qBound(0.0f, value[c], 1.0f)) / 255.0f;
+        }
+    }
+    return image;
+}
+
+double ComputePSNR(const ByteBuffer &source, const ByteBuffer &decoded, int w, int h, const int *channels, int count)
+{
+    const float *src = source.ptrAsFloat();
+    const float *dst = decoded.ptrAsFloat();
+    double error = 0;
+    for (int i = 0; i < w * h; i++)
+    {
+        for (int c = 0; c < count; c++)
+        {
+            int diff = ROUND_FLOAT_TO_BYTE(src[i * 4 + channels[c]]) - ROUND_FLOAT_TO_BYTE(dst[i * 4 + channels[c]]);
+            error += diff * diff;
+        }
+    }
+    error /= (double)w * h * count;
+    if (error == 0)
+        return 99.99;
+    return 10.0 * log10(255.0 * 255.0 / error);
+}
+
+struct EncodeResult
+{
+    double megaPixels;
+    double psnr;
+};
+
+EncodeResult MeasureEncoder(const ByteBuffer &source, int w, int h, PixelFormat format,
+                            const int *channels, int count, float bc7quality = 1.0f)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int iterations = 0;
+    ByteBuffer encoded;
+    do
+    {
+        encoded.Free();
+        encoded = Image::compressMipmap(format, source, w, h, false, 128, bc7quality);
+        iterations++;
+    } while (timer.elapsed() < BenchMinTimeMs);
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    auto decoded = Image::convertRawToInternal(encoded, w, h, format);
+    EncodeResult result{ (double)w * h * iterations / seconds / 1e6, ComputePSNR(source, decoded, w, h, channels, count) };
+    decoded.Free();
+    encoded.Free();
+    return result;
+}
+
+// Mip downscaling as it was before the SSE2 rewrite, kept as throughput baseline
+ByteBuffer DownscaleScalarBox(const ByteBuffer src, int w, int h)
+{
+    const float *srcPtr = src.ptrAsFloat();
+    ByteBuffer tmpData(w * h * sizeof(float));
+    float *ptr = tmpData.ptrAsFloat();
+    int pitch = w * 4;
+    for (int srcPos = 0, dstPos = 0; dstPos < w * h; srcPos += pitch)
+    {
+        for (int x = 0; x < (w / 2); x++, srcPos += 8)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                ptr[dstPos++] = (srcPtr[srcPos + c] + srcPtr[srcPos + 4 + c] +
+                                 srcPtr[srcPos + pitch + c] + srcPtr[srcPos + pitch + 4 + c]) / 4.0f;
+            }
+        }
+    }
+    return tmpData;
+}
+
+// Zone plate 0.5 + 0.5 * cos(k * r^2), local frequency k * r / pi cycles per source pixel
+// rises from zero in the centre to the source Nyquist limit at the edge midpoints
+float ZonePlate(float x, float y, int size)
+{
+    float dx = x - size * 0.5f, dy = y - size * 0.5f;
+    return 0.5f + 0.5f * cosf(Pi / size * (dx * dx + dy * dy));
+}
+
+ByteBuffer MakeZonePlate(int size)
+{
+    ByteBuffer image(size * size * 4 * sizeof(float));
+    float *ptr = image.ptrAsFloat();
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            float value = ZonePlate(x + 0.5f, y + 0.5f, size);
+            for (int c = 0; c < 4; c++)
+                ptr[(y * size + x) * 4 + c] = value;
+        }
+    }
+    return image;
+}
+
+struct MipFilterResult
+{
+    double passbandPsnr;
+    double aliasing;
+};
+
+// Below a quarter of the destination Nyquist limit the level should match the zone plate
+// sampled at destination pixel centres; above the limit it should fade to flat grey
+MipFilterResult MeasureZonePlate(const ByteBuffer &level, int size)
+{
+    const float *ptr = level.ptrAsFloat();
+    int dstSize = size / 2;
+    double passError = 0, stopError = 0;
+    qint64 passCount = 0, stopCount = 0;
+    for (int y = 0; y < dstSize; y++)
+    {
+        for (int x = 0; x < dstSize; x++)
+        {
+            float sx = 2.0f * x + 1.0f, sy = 2.0f * y + 1.0f;
+            float r = sqrtf((sx - size * 0.5f) * (sx - size * 0.5f) + (sy - size * 0.5f) * (sy - size * 0.5f));
+            float value = ptr[(y * dstSize + x) * 4];
+            if (r < size / 8.0f)
+            {
+                double diff = value - ZonePlate(sx, sy, size);
+                passError += diff * diff;
+                passCount++;
+            }
+            else if (r > size * 0.3f && r < size * 0.5f)
+            {
+                double diff = value - 0.5;
+                stopError += diff * diff;
+                stopCount++;
+            }
+        }
+    }
+    passError /= passCount;
+    MipFilterResult result;
+    result.passbandPsnr = passError == 0 ? 99.99 : 10.0 * log10(1.0 / passError);
+    result.aliasing = sqrt(stopError / stopCount);
+    return result;
+}
+
+double MeasureDownscale(ByteBuffer (*downscale)(const ByteBuffer, int, int), const ByteBuffer &source, int size)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int iterations = 0;
+    do
+    {
+        ByteBuffer level = downscale(source, size, size);
+        level.Free();
+        iterations++;
+    } while (timer.elapsed() < BenchMinTimeMs);
+    return (double)size * size * iterations / (timer.nsecsElapsed() / 1e9) / 1e6;
+}
+
+} // namespace
+
+bool BenchDxtEncoders()
+{
+    struct
+    {
+        PixelFormat format;
+        int channels[4];
+        int count;
+    } formats[] =
+    {
+        { PixelFormat::DXT1, { 0, 1, 2 }, 3 },
+        { PixelFormat::DXT5, { 0, 1, 2, 3 }, 4 },
+        { PixelFormat::ATI2, { 0, 1 }, 2 },
+    };
+
+    ByteBuffer source = MakeBenchImage(BenchImageSize, BenchImageSize, 23);
+    Image::DxtQuality previous = Image::GetDxtQuality();
+    PINFO(QString::asprintf("DXT encoders, %dx%d image, %d threads\n", BenchImageSize, BenchImageSize, omp_get_max_threads()));
+    for (const auto &entry : formats)
+    {
+        Image::SetDxtQuality(Image::DxtQuality::Normal);
+        EncodeResult normal = MeasureEncoder(source, BenchImageSize, BenchImageSize, entry.format, entry.channels, entry.count);
+        Image::SetDxtQuality(Image::DxtQuality::Fast);
+        EncodeResult fast = MeasureEncoder(source, BenchImageSize, BenchImageSize, entry.format, entry.channels, entry.count);
+        PINFO(QString::asprintf("  %-8s normal: %8.2f MPix/s %6.2f dB   fast: %8.2f MPix/s %6.2f dB\n",
+                                Image::getEngineFormatType(entry.format).toStdString().c_str(),
+                                normal.megaPixels, normal.psnr, fast.megaPixels, fast.psnr));
+    }
+    Image::SetDxtQuality(previous);
+    source.Free();
+    return true;
+}
+
+bool BenchBc7Encoder()
+{
+    const struct
+    {
+        Image::Bc7Profile profile;
+        const char *name;
+    } profiles[] =
+    {
+        { Image::Bc7Profile::VeryFast, "veryfast" },
+        { Image::Bc7Profile::Fast, "fast" },
+        { Image::Bc7Profile::Normal, "normal" },
+        { Image::Bc7Profile::Slow, "slow" },
+    };
+    const int channels[] = { 0, 1, 2, 3 };
+
+    ByteBuffer source = MakeBenchImage(BenchBc7ImageSize, BenchBc7ImageSize, 23);
+    Image::Bc7Profile previous = Image::GetBc7Profile();
+    PINFO(QString::asprintf("BC7 encoder, %dx%d image, quality %.1f, %d threads\n",
+                            BenchBc7ImageSize, BenchBc7ImageSize, BenchBc7Quality, omp_get_max_threads()));
+    for (const auto &entry : profiles)
+    {
+        Image::SetBc7Profile(entry.profile);
+        EncodeResult result = MeasureEncoder(source, BenchBc7ImageSize, BenchBc7ImageSize, PixelFormat::BC7,
+                                             channels, 4, BenchBc7Quality);
+        PINFO(QString::asprintf("  %-8s %8.3f MPix/s %6.2f dB\n", entry.name, result.megaPixels, result.psnr));
+    }
+    Image::SetBc7Profile(previous);
+    source.Free();
+    return true;
+}
+
+bool BenchMipFilters()
+{
+    const struct
+    {
+        Image::MipFilter filter;
+        const char *name;
+    } filters[] =
+    {
+        { Image::MipFilter::Box, "box" },
+        { Image::MipFilter::Kaiser, "kaiser" },
+        { Image::MipFilter::Lanczos, "lanczos" },
+    };
+
+    ByteBuffer source = MakeZonePlate(BenchMipImageSize);
+    Image::MipFilter previous = Image::GetMipFilter();
+    PINFO(QString::asprintf("Mip filters, %dx%d zone plate, source MPix/s, %d threads\n",
+                            BenchMipImageSize, BenchMipImageSize, omp_get_max_threads()));
+
+    ByteBuffer scalar = DownscaleScalarBox(source, BenchMipImageSize, BenchMipImageSize);
+    MipFilterResult scalarResult = MeasureZonePlate(scalar, BenchMipImageSize);
+    double scalarSpeed = MeasureDownscale(DownscaleScalarBox, source, BenchMipImageSize);
+    PINFO(QString::asprintf("  %-12s %8.1f MPix/s   passband %6.2f dB   aliasing %.4f\n",
+                            "scalar box", scalarSpeed, scalarResult.passbandPsnr, scalarResult.aliasing));
+
+    bool boxMatches = true;
+    for (const auto &entry : filters)
+    {
+        Image::SetMipFilter(entry.filter);
+        ByteBuffer level = Image::downscaleInternal(source, BenchMipImageSize, BenchMipImageSize);
+        MipFilterResult result = MeasureZonePlate(level, BenchMipImageSize);
+        if (entry.filter == Image::MipFilter::Box)
+            boxMatches = memcmp(level.ptr(), scalar.ptr(), scalar.size()) == 0;
+        level.Free();
+        double speed = MeasureDownscale(Image::downscaleInternal, source, BenchMipImageSize);
+        PINFO(QString::asprintf("  %-12s %8.1f MPix/s   passband %6.2f dB   aliasing %.4f   %.2fx scalar box\n",
+                                entry.name, speed, result.passbandPsnr, result.aliasing, speed / scalarSpeed));
+    }
+    if (!boxMatches)
+        PERROR("Box filter output differs from scalar box\n");
+
+    Image::SetMipFilter(previous);
+    scalar.Free();
+    source.Free();
+    return boxMatches;
+}
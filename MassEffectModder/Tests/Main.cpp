@@ -0,0 +1,133 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Helpers/Logs.h>
+#include <Misc/Misc.h>
+#include <Wrappers.h>
+
+bool g_ipc;
+
+bool GetBackTrace(std::string & /*output*/, bool  /*exceptionMode*/, bool  /*crashMode*/)
+{
+    return true;
+}
+
+// Misc.cpp depends on game data, conversion cache only needs these two
+bool Misc::checkWriteAccessDir(const QString &path)
+{
+    return QDir(path).exists();
+}
+
+QString Misc::getBytesFormat(quint64 size)
+{
+    return QString::number(size) + " Bytes";
+}
+
+namespace {
+
+const TestCase tests[] =
+{
+    { "StreamedDDSMatchesBuffered", TestStreamedDDSMatchesBuffered },
+    { "TruncatedDDSLoadsWithoutMips", TestTruncatedDDSLoadsWithoutMips },
+    { "DDSHeaderMatchesStoredImage", TestDDSHeaderMatchesStoredImage },
+    { "PngLoadMatchesSource", TestPngLoadMatchesSource },
+    { "PngLoadRejectsNonPowerOfTwo", TestPngLoadRejectsNonPowerOfTwo },
+    { "ConvertCacheRoundTrip", TestConvertCacheRoundTrip },
+    { "ConvertCacheKeyTracksParams", TestConvertCacheKeyTracksParams },
+    { "ConvertCacheRejectsBadEntries", TestConvertCacheRejectsBadEntries },
+    { "ConvertCacheTrimEvictsOldest", TestConvertCacheTrimEvictsOldest },
+    { "ByteBufferViewFreeKeepsMemory", TestByteBufferViewFreeKeepsMemory },
+    { "MipMapViewCopyOnWrite", TestMipMapViewCopyOnWrite },
+    { "ImageViewOutlivesCallerOwner", TestImageViewOutlivesCallerOwner },
+    { "ByteDecodingMatchesFloat", TestByteDecodingMatchesFloat },
+    { "FastDxtGroupsMatchSingleBlocks", TestFastDxtGroupsMatchSingleBlocks },
+    { "BlockMemoMatchesDirectEncoding", TestBlockMemoMatchesDirectEncoding },
+    { "RawAlphaDetectionDXT", TestRawAlphaDetectionDXT },
+    { "RawAlphaDetectionBC7", TestRawAlphaDetectionBC7 },
+    { "RawAlphaDetectionUncompressed", TestRawAlphaDetectionUncompressed },
+};
+
+const TestCase benchmarks[] =
+{
+    { "DxtEncoders", BenchDxtEncoders },
+    { "Bc7Encoder", BenchBc7Encoder },
+    { "MipFilters", BenchMipFilters },
+};
+
+} // namespace
+
+void TestFailed(const char *file, int line, const char *expression)
+{
+    PERROR(QString("FAIL: ") + expression + " (" + file + ":" + QString::number(line) + ")\n");
+}
+
+quint32 TestRandom(quint32 &seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+void TestFillRandom(quint8 *ptr, qint64 size, quint32 seed)
+{
+    for (qint64 i = 0; i < size; i++)
+        ptr[i] = TestRandom(seed) & 0xFF;
+}
+
+QString TestTempPath(const QString &name)
+{
+    return QDir::tempPath() + "/MEMTests-" + QString::number(QCoreApplication::applicationPid()) + "-" + name;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (!CreateLogs())
+        return 1;
+    g_logs->EnableOutputConsole(true);
+    g_logs->ChangeLogLevel(LOG_INFO);
+
+    BC7InitializeLibrary();
+
+    // Benchmarks only run on request: MassEffectModderTests --bench [filter]
+    bool bench = argc > 1 && QString(argv[1]) == "--bench";
+    int filterArg = bench ? 2 : 1;
+    QString filter = argc > filterArg ? QString(argv[filterArg]) : QString();
+    const TestCase *first = bench ? std::begin(benchmarks) : std::begin(tests);
+    const TestCase *last = bench ? std::end(benchmarks) : std::end(tests);
+    int failed = 0, count = 0;
+    for (const TestCase *test = first; test != last; test++)
+    {
+        if (!filter.isEmpty() && !QString(test->name).contains(filter))
+            continue;
+        count++;
+        bool passed = test->function();
+        PINFO(QString(passed ? "PASS: " : "FAIL: ") + test->name + "\n");
+        if (!passed)
+            failed++;
+    }
+    PINFO(QString::number(count - failed) + " of " + QString::number(count) + " tests passed\n");
+
+    BC7ShutdownLibrary();
+    ReleaseLogs();
+    return failed == 0 ? 0 : 1;
+}
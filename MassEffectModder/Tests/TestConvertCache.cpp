@@ -0,0 +1,254 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Helpers/FileStream.h>
+#include <Helpers/MemoryStream.h>
+#include <Helpers/MiscHelpers.h>
+#include <Image/Image.h>
+#include <Misc/ModConvertCache.h>
+#include <Texture/TextureScan.h>
+
+namespace {
+
+const int TestPayloadSize = 4096;
+
+QString WriteSourceFile(const QString &name, quint32 seed)
+{
+    QString fileName = TestTempPath(name);
+    ByteBuffer data(TestPayloadSize);
+    TestFillRandom(data.ptr(), data.size(), seed);
+    FileStream fs = FileStream(fileName, FileMode::Create, FileAccess::WriteOnly);
+    fs.WriteFromBuffer(data);
+    data.Free();
+    return fileName;
+}
+
+void StorePayload(ModConvertCache &cache, const QByteArray &key, quint32 seed)
+{
+    ByteBuffer data(TestPayloadSize);
+    TestFillRandom(data.ptr(), data.size(), seed);
+    MemoryStream payload(data);
+    cache.Store(key, payload, data.size());
+    data.Free();
+}
+
+// Returns fetched payload, empty buffer on miss
+ByteBuffer FetchPayload(ModConvertCache &cache, const QByteArray &key)
+{
+    QString fileName = TestTempPath("fetched.bin");
+    ByteBuffer data;
+    qint64 size = 0;
+    bool found;
+    {
+        FileStream fs = FileStream(fileName, FileMode::Create, FileAccess::WriteOnly);
+        found = cache.Fetch(key, fs, size);
+    }
+    if (found)
+    {
+        FileStream fs = FileStream(fileName, FileMode::Open, FileAccess::ReadOnly);
+        data = fs.ReadToBuffer(size);
+    }
+    QFile(fileName).remove();
+    return data;
+}
+
+bool PayloadMatches(const ByteBuffer &data, quint32 seed)
+{
+    if (data.ptr() == nullptr || data.size() != TestPayloadSize)
+        return false;
+    ByteBuffer expected(TestPayloadSize);
+    TestFillRandom(expected.ptr(), expected.size(), seed);
+    bool match = memcmp(data.ptr(), expected.ptr(), TestPayloadSize) == 0;
+    expected.Free();
+    return match;
+}
+
+QString CacheEntryPath(const QString &cacheDir, const QByteArray &key)
+{
+    QString name = QString(key.toHex());
+    return cacheDir + "/" + name.left(2) + "/" + name + ".bin";
+}
+
+QByteArray TestParams(const TextureMapEntry &f, int numMips, float bc7quality)
+{
+    return ModConvertCache::MakeParams(f, numMips, false, false, false, bc7quality,
+                                       CompressionDataType::Zlib);
+}
+
+} // namespace
+
+bool TestConvertCacheRoundTrip()
+{
+    QString cacheDir = TestTempPath("cache-roundtrip");
+    QString source = WriteSourceFile("cache-source.dds", 11);
+    ModConvertCache cache(cacheDir, 1024 * 1024, 0);
+    TEST_CHECK(cache.Enabled());
+
+    QByteArray key = ModConvertCache::MakeKey(source, "params");
+    TEST_CHECK(key == ModConvertCache::MakeKey(source, "params"));
+    ByteBuffer missing = FetchPayload(cache, key);
+    TEST_CHECK(missing.ptr() == nullptr);
+
+    StorePayload(cache, key, 12);
+    ByteBuffer fetched = FetchPayload(cache, key);
+    TEST_CHECK(PayloadMatches(fetched, 12));
+    fetched.Free();
+
+    // Same parameters but different source content must not hit
+    QString otherSource = WriteSourceFile("cache-other.dds", 13);
+    ByteBuffer other = FetchPayload(cache, ModConvertCache::MakeKey(otherSource, "params"));
+    TEST_CHECK(other.ptr() == nullptr);
+
+    QFile(source).remove();
+    QFile(otherSource).remove();
+    QDir(cacheDir).removeRecursively();
+    return true;
+}
+
+bool TestConvertCacheKeyTracksParams()
+{
+    QString source = WriteSourceFile("cache-params.dds", 21);
+    TextureMapEntry f{};
+    f.pixfmt = PixelFormat::DXT1;
+    f.type = TextureType::Diffuse;
+    f.width = 512;
+    f.height = 512;
+    auto dxtQuality = Image::GetDxtQuality();
+    auto bc7Profile = Image::GetBc7Profile();
+    auto mipFilter = Image::GetMipFilter();
+
+    QByteArray base = ModConvertCache::MakeKey(source, TestParams(f, 10, 1.0f));
+    TEST_CHECK(base == ModConvertCache::MakeKey(source, TestParams(f, 10, 1.0f)));
+
+    QList<QByteArray> keys;
+    TextureMapEntry otherFormat = f;
+    otherFormat.pixfmt = PixelFormat::DXT5;
+    keys.push_back(ModConvertCache::MakeKey(source, TestParams(otherFormat, 10, 1.0f)));
+    keys.push_back(ModConvertCache::MakeKey(source, TestParams(f, 1, 1.0f)));
+    keys.push_back(ModConvertCache::MakeKey(source, TestParams(f, 10, 0.5f)));
+
+    Image::SetDxtQuality(dxtQuality == Image::DxtQuality::Fast ?
+                         Image::DxtQuality::Normal : Image::DxtQuality::Fast);
+    keys.push_back(ModConvertCache::MakeKey(source, TestParams(f, 10, 1.0f)));
+    Image::SetDxtQuality(dxtQuality);
+
+    Image::SetBc7Profile(bc7Profile == Image::Bc7Profile::Fast ?
+                         Image::Bc7Profile::Slow : Image::Bc7Profile::Fast);
+    keys.push_back(ModConvertCache::MakeKey(source, TestParams(f, 10, 1.0f)));
+    Image::SetBc7Profile(bc7Profile);
+
+    Image::SetMipFilter(mipFilter == Image::MipFilter::Box ?
+                        Image::MipFilter::Kaiser : Image::MipFilter::Box);
+    keys.push_back(ModConvertCache::MakeKey(source, TestParams(f, 10, 1.0f)));
+    Image::SetMipFilter(mipFilter);
+
+    // Every parameter change misses, restored settings hit again
+    for (int i = 0; i < keys.count(); i++)
+    {
+        TEST_CHECK(keys[i] != base);
+        for (int j = i + 1; j < keys.count(); j++)
+            TEST_CHECK(keys[i] != keys[j]);
+    }
+    TEST_CHECK(base == ModConvertCache::MakeKey(source, TestParams(f, 10, 1.0f)));
+
+    QFile(source).remove();
+    return true;
+}
+
+bool TestConvertCacheRejectsBadEntries()
+{
+    QString cacheDir = TestTempPath("cache-bad");
+    QString source = WriteSourceFile("cache-bad.dds", 31);
+    ModConvertCache cache(cacheDir, 1024 * 1024, 0);
+    QByteArray key = ModConvertCache::MakeKey(source, "truncated");
+    QByteArray otherKey = ModConvertCache::MakeKey(source, "mismatched");
+    QString entryPath = CacheEntryPath(cacheDir, key);
+
+    // Truncated payload
+    StorePayload(cache, key, 32);
+    TEST_CHECK(QFile::exists(entryPath));
+    {
+        QFile entry(entryPath);
+        TEST_CHECK(entry.open(QIODevice::ReadWrite));
+        TEST_CHECK(entry.resize(entry.size() - 100));
+    }
+    ByteBuffer truncated = FetchPayload(cache, key);
+    TEST_CHECK(truncated.ptr() == nullptr);
+    TEST_CHECK(!QFile::exists(entryPath));
+
+    // Entry stored under other key
+    StorePayload(cache, otherKey, 33);
+    QString otherPath = CacheEntryPath(cacheDir, otherKey);
+    QDir().mkpath(DirName(entryPath));
+    TEST_CHECK(QFile::copy(otherPath, entryPath));
+    ByteBuffer mismatched = FetchPayload(cache, key);
+    TEST_CHECK(mismatched.ptr() == nullptr);
+    TEST_CHECK(!QFile::exists(entryPath));
+
+    // Valid entry is not affected
+    ByteBuffer valid = FetchPayload(cache, otherKey);
+    TEST_CHECK(PayloadMatches(valid, 33));
+    valid.Free();
+
+    QFile(source).remove();
+    QDir(cacheDir).removeRecursively();
+    return true;
+}
+
+bool TestConvertCacheTrimEvictsOldest()
+{
+    QString cacheDir = TestTempPath("cache-trim");
+    QString source = WriteSourceFile("cache-trim.dds", 41);
+    const int numEntries = 5;
+    const int keepEntries = 3;
+    QByteArray probeKey = ModConvertCache::MakeKey(source, "probe");
+    quint64 entrySize = 4 + 4 + probeKey.size() + 8 + TestPayloadSize;
+    ModConvertCache cache(cacheDir, entrySize * keepEntries, 0);
+
+    QList<QByteArray> keys;
+    QDateTime base = QDateTime::currentDateTime().addDays(-1);
+    for (int i = 0; i < numEntries; i++)
+    {
+        keys.push_back(ModConvertCache::MakeKey(source, QByteArray::number(i)));
+        StorePayload(cache, keys[i], 42 + i);
+        QFile entry(CacheEntryPath(cacheDir, keys[i]));
+        TEST_CHECK(entry.open(QIODevice::ReadWrite));
+        TEST_CHECK(entry.setFileTime(base.addSecs(i * 60), QFileDevice::FileModificationTime));
+    }
+
+    // Fetch marks oldest entry as recently used
+    ByteBuffer used = FetchPayload(cache, keys[0]);
+    TEST_CHECK(PayloadMatches(used, 42));
+    used.Free();
+
+    cache.Trim();
+    TEST_CHECK(QFile::exists(CacheEntryPath(cacheDir, keys[0])));
+    TEST_CHECK(!QFile::exists(CacheEntryPath(cacheDir, keys[1])));
+    TEST_CHECK(!QFile::exists(CacheEntryPath(cacheDir, keys[2])));
+    for (int i = keepEntries; i < numEntries; i++)
+        TEST_CHECK(QFile::exists(CacheEntryPath(cacheDir, keys[i])));
+
+    QFile(source).remove();
+    QDir(cacheDir).removeRecursively();
+    return true;
+}
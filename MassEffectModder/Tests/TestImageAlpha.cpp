@@ -0,0 +1,210 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Image/Image.h>
+#include <Helpers/Logs.h>
+
+namespace {
+
+// Reference result, alpha is checked on fully decoded float pixels
+bool FloatDetectAlphaData(const ByteBuffer &src, int w, int h, PixelFormat format)
+{
+    auto pixels = Image::convertRawToInternal(src, w, h, format);
+    bool hasAlpha = Image::InternalDetectAlphaData(pixels, qMax(w, 4), qMax(h, 4));
+    pixels.Free();
+    return hasAlpha;
+}
+
+bool CompareAlphaDetection(const ByteBuffer &src, int w, int h, PixelFormat format)
+{
+    bool raw = Image::RawDetectAlphaData(src, w, h, format);
+    bool reference = FloatDetectAlphaData(src, w, h, format);
+    if (raw != reference)
+    {
+        QString bytes;
+        for (int i = 0; i < qMin(src.size(), (qint64)16); i++)
+            bytes += QString::asprintf("%02X", src.ptr()[i]);
+        PERROR(QString("Alpha detection differs for format ") + Image::getEngineFormatType(format) +
+               " " + QString::number(w) + "x" + QString::number(h) +
+               ", raw: " + QString::number(raw) + ", float: " + QString::number(reference) +
+               ", data: " + bytes + "\n");
+    }
+    return raw == reference;
+}
+
+void WriteDXT5AlphaBlock(quint8 *block, int alpha0, int alpha1, quint64 indices)
+{
+    block[0] = alpha0;
+    block[1] = alpha1;
+    for (int i = 0; i < 6; i++)
+        block[2 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+} // namespace
+
+bool TestRawAlphaDetectionDXT()
+{
+    ByteBuffer block(16);
+    quint32 seed = 7;
+
+    // Every alpha ramp with each index used by the whole block,
+    // covers both ramp kinds and entries rounding next to 255
+    for (int alpha0 = 0; alpha0 < 256; alpha0++)
+    {
+        for (int alpha1 = 0; alpha1 < 256; alpha1++)
+        {
+            TestFillRandom(block.ptr() + 8, 8, seed++);
+            for (int index = 0; index < 8; index++)
+            {
+                quint64 indices = 0;
+                for (int i = 0; i < 16; i++)
+                    indices |= (quint64)index << (3 * i);
+                WriteDXT5AlphaBlock(block.ptr(), alpha0, alpha1, indices);
+                TEST_CHECK(CompareAlphaDetection(block, 4, 4, PixelFormat::DXT5));
+            }
+        }
+    }
+
+    // Mixed indices with ramps around the opaque edge
+    const int edges[] = { 0, 1, 127, 128, 248, 249, 250, 251, 252, 253, 254, 255 };
+    for (int alpha0 : edges)
+    {
+        for (int alpha1 : edges)
+        {
+            for (int i = 0; i < 64; i++)
+            {
+                TestFillRandom(block.ptr(), 16, seed++);
+                block.ptr()[0] = alpha0;
+                block.ptr()[1] = alpha1;
+                TEST_CHECK(CompareAlphaDetection(block, 4, 4, PixelFormat::DXT5));
+            }
+        }
+    }
+
+    // Random DXT1 blocks, half of them in three colors mode with transparent texel
+    for (int i = 0; i < 4096; i++)
+    {
+        TestFillRandom(block.ptr(), 8, seed++);
+        TEST_CHECK(CompareAlphaDetection(block, 4, 4, PixelFormat::DXT1));
+    }
+
+    // Images with several blocks, alpha appears only in one of them
+    const int width = 16, height = 8;
+    ByteBuffer image(MipMap::getBufferSize(width, height, PixelFormat::DXT5));
+    for (int i = 0; i < 256; i++)
+    {
+        for (int b = 0; b < image.size() / 16; b++)
+            WriteDXT5AlphaBlock(image.ptr() + b * 16, 255, 255, 0);
+        TestFillRandom(image.ptr() + (TestRandom(seed) % (image.size() / 16)) * 16, 16, seed++);
+        TEST_CHECK(CompareAlphaDetection(image, width, height, PixelFormat::DXT5));
+    }
+    image.Free();
+
+    // Mips smaller than block
+    TEST_CHECK(CompareAlphaDetection(block, 2, 2, PixelFormat::DXT5));
+    TEST_CHECK(CompareAlphaDetection(block, 1, 1, PixelFormat::DXT1));
+
+    block.Free();
+    return true;
+}
+
+bool TestRawAlphaDetectionBC7()
+{
+    ByteBuffer block(16);
+    quint32 seed = 11;
+
+    // Random blocks of every mode, mode is the lowest set bit of the first byte
+    for (int mode = 0; mode < 8; mode++)
+    {
+        for (int i = 0; i < 4096; i++)
+        {
+            TestFillRandom(block.ptr(), 16, seed++);
+            block.ptr()[0] = (block.ptr()[0] & ~((2 << mode) - 1)) | (1 << mode);
+            TEST_CHECK(CompareAlphaDetection(block, 4, 4, PixelFormat::BC7));
+        }
+    }
+
+    // Modes with alpha, forced to fully opaque endpoints
+    for (int i = 0; i < 4096; i++)
+    {
+        TestFillRandom(block.ptr(), 16, seed++);
+        memset(block.ptr() + 1, 0xFF, 15);
+        block.ptr()[0] = (block.ptr()[0] & ~0x3F) | 0x40;
+        TEST_CHECK(CompareAlphaDetection(block, 4, 4, PixelFormat::BC7));
+    }
+
+    // Images mixing opaque modes 0-3 with an alpha mode block
+    const int width = 16, height = 16;
+    ByteBuffer image(MipMap::getBufferSize(width, height, PixelFormat::BC7));
+    for (int i = 0; i < 256; i++)
+    {
+        TestFillRandom(image.ptr(), image.size(), seed++);
+        for (int b = 0; b < image.size() / 16; b++)
+        {
+            int mode = TestRandom(seed) % 4;
+            quint8 &first = image.ptr()[b * 16];
+            first = (first & ~((2 << mode) - 1)) | (1 << mode);
+        }
+        if (i & 1)
+        {
+            quint8 &first = image.ptr()[(TestRandom(seed) % (image.size() / 16)) * 16];
+            int mode = 4 + TestRandom(seed) % 4;
+            first = (first & ~((2 << mode) - 1)) | (1 << mode);
+        }
+        TEST_CHECK(CompareAlphaDetection(image, width, height, PixelFormat::BC7));
+    }
+    image.Free();
+
+    TEST_CHECK(CompareAlphaDetection(block, 2, 2, PixelFormat::BC7));
+
+    block.Free();
+    return true;
+}
+
+bool TestRawAlphaDetectionUncompressed()
+{
+    const PixelFormat formats[] =
+    {
+        PixelFormat::ARGB, PixelFormat::RGBA, PixelFormat::R10G10B10A2,
+        PixelFormat::R16G16B16A16, PixelFormat::RGB, PixelFormat::G8, PixelFormat::V8U8
+    };
+    const int width = 8, height = 4;
+    quint32 seed = 13;
+    for (auto format : formats)
+    {
+        ByteBuffer data(MipMap::getBufferSize(width, height, format));
+        int pixelSize = data.size() / (width * height);
+        for (int i = 0; i < 512; i++)
+        {
+            // Opaque pixels with single random one, alpha is stored in the top bytes
+            memset(data.ptr(), 0xFF, data.size());
+            int pixel = TestRandom(seed) % (width * height);
+            TestFillRandom(data.ptr() + pixel * pixelSize, pixelSize, seed++);
+            if (format == PixelFormat::R16G16B16A16 && (i & 1))
+                data.ptr()[pixel * pixelSize + 7] = 0xFF;
+            TEST_CHECK(CompareAlphaDetection(data, width, height, format));
+        }
+        data.Free();
+    }
+    return true;
+}
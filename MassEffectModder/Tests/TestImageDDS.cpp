@@ -0,0 +1,201 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Image/Image.h>
+#include <Helpers/FileStream.h>
+#include <Helpers/Logs.h>
+#include <Helpers/MemoryStream.h>
+
+namespace {
+
+bool CompareStreamedWithBuffered(PixelFormat format, int width, int height, quint32 seed)
+{
+    QList<MipMap *> mipmaps;
+    for (int w = width, h = height; ; w = qMax(w / 2, 1), h = qMax(h / 2, 1))
+    {
+        int alignedW = w, alignedH = h;
+        MipMap::alignToBlockSize(alignedW, alignedH, format);
+        ByteBuffer data(MipMap::getBufferSize(alignedW, alignedH, format));
+        TestFillRandom(data.ptr(), data.size(), seed++);
+        mipmaps.push_back(new MipMap(data, w, h, format));
+        data.Free();
+        if (w == 1 && h == 1)
+            break;
+    }
+
+    MemoryStream memoryStream;
+    {
+        DDSStreamWriter writer(memoryStream, format);
+        for (int i = 0; i < mipmaps.count(); i++)
+        {
+            writer.WriteMipMap(mipmaps[i]->getRefData(), mipmaps[i]->getOrigWidth(), mipmaps[i]->getOrigHeight());
+        }
+        writer.Finish();
+    }
+    ByteBuffer streamed = memoryStream.ToArray();
+
+    QString fileName = TestTempPath("streamed.dds");
+    {
+        FileStream fileStream = FileStream(fileName, FileMode::Create, FileAccess::WriteOnly);
+        DDSStreamWriter writer(fileStream, format);
+        for (int i = 0; i < mipmaps.count(); i++)
+        {
+            writer.WriteMipMap(mipmaps[i]->getRefData(), mipmaps[i]->getOrigWidth(), mipmaps[i]->getOrigHeight());
+        }
+        writer.Finish();
+    }
+    ByteBuffer streamedFile;
+    {
+        FileStream fileStream = FileStream(fileName, FileMode::Open, FileAccess::ReadOnly);
+        streamedFile = fileStream.ReadToBuffer(fileStream.Length());
+    }
+    QFile(fileName).remove();
+
+    Image image(mipmaps, format);
+    ByteBuffer buffered = image.StoreImageToDDS();
+
+    bool identical = streamed.size() == buffered.size() &&
+                     memcmp(streamed.ptr(), buffered.ptr(), buffered.size()) == 0 &&
+                     streamedFile.size() == buffered.size() &&
+                     memcmp(streamedFile.ptr(), buffered.ptr(), buffered.size()) == 0;
+    if (!identical)
+    {
+        PERROR(QString("Streamed DDS differs for format ") + Image::getEngineFormatType(format) +
+               " " + QString::number(width) + "x" + QString::number(height) + "\n");
+    }
+    streamed.Free();
+    streamedFile.Free();
+    buffered.Free();
+    return identical;
+}
+
+} // namespace
+
+bool TestStreamedDDSMatchesBuffered()
+{
+    const PixelFormat formats[] =
+    {
+        PixelFormat::DXT1, PixelFormat::DXT3, PixelFormat::DXT5, PixelFormat::ATI2,
+        PixelFormat::BC5, PixelFormat::BC7, PixelFormat::ARGB, PixelFormat::RGB,
+        PixelFormat::RGBA, PixelFormat::G8, PixelFormat::V8U8,
+        PixelFormat::R10G10B10A2, PixelFormat::R16G16B16A16
+    };
+    const int sizes[][2] = { { 256, 256 }, { 512, 128 }, { 8, 2 }, { 1, 1 } };
+
+    quint32 seed = 1;
+    for (auto format : formats)
+    {
+        for (auto size : sizes)
+        {
+            TEST_CHECK(CompareStreamedWithBuffered(format, size[0], size[1], seed));
+            seed += 100;
+        }
+    }
+    return true;
+}
+
+bool TestTruncatedDDSLoadsWithoutMips()
+{
+    QList<MipMap *> mipmaps;
+    for (int size = 64; size >= 1; size /= 2)
+    {
+        int alignedW = size, alignedH = size;
+        MipMap::alignToBlockSize(alignedW, alignedH, PixelFormat::DXT1);
+        ByteBuffer data(MipMap::getBufferSize(alignedW, alignedH, PixelFormat::DXT1));
+        TestFillRandom(data.ptr(), data.size(), size);
+        mipmaps.push_back(new MipMap(data, size, size, PixelFormat::DXT1));
+        data.Free();
+    }
+    int mipsCount = mipmaps.count();
+    Image source(mipmaps, PixelFormat::DXT1);
+    ByteBuffer dds = source.StoreImageToDDS();
+
+    const qint64 headerSize = 128;
+    const qint64 lengths[] = { dds.size(), dds.size() - 1, headerSize + (dds.size() - headerSize) / 2, headerSize };
+    QString fileName = TestTempPath("truncated.dds");
+    bool passed = true;
+    for (qint64 length : lengths)
+    {
+        {
+            FileStream fileStream = FileStream(fileName, FileMode::Create, FileAccess::WriteOnly);
+            fileStream.WriteFromBuffer(dds.ptr(), length);
+        }
+        Image image(fileName, ImageFormat::DDS);
+        int expected = length == dds.size() ? mipsCount : 0;
+        if (image.getMipMaps().count() != expected)
+        {
+            PERROR(QString("DDS of ") + QString::number(length) + " bytes loaded with " +
+                   QString::number(image.getMipMaps().count()) + " mips\n");
+            passed = false;
+        }
+    }
+    QFile(fileName).remove();
+    dds.Free();
+    TEST_CHECK(passed);
+    return true;
+}
+
+bool TestDDSHeaderMatchesStoredImage()
+{
+    const PixelFormat formats[] =
+    {
+        PixelFormat::DXT1, PixelFormat::DXT5, PixelFormat::ATI2, PixelFormat::BC5,
+        PixelFormat::BC7, PixelFormat::ARGB, PixelFormat::RGB, PixelFormat::RGBA,
+        PixelFormat::G8, PixelFormat::V8U8, PixelFormat::R10G10B10A2, PixelFormat::R16G16B16A16
+    };
+    const int sizes[][2] = { { 64, 64 }, { 128, 16 }, { 4, 8 } };
+
+    quint32 seed = 1;
+    for (auto format : formats)
+    {
+        for (auto size : sizes)
+        {
+            QList<MipMap *> mipmaps;
+            for (int w = size[0], h = size[1]; ; w = qMax(w / 2, 1), h = qMax(h / 2, 1))
+            {
+                int alignedW = w, alignedH = h;
+                MipMap::alignToBlockSize(alignedW, alignedH, format);
+                ByteBuffer data(MipMap::getBufferSize(alignedW, alignedH, format));
+                TestFillRandom(data.ptr(), data.size(), seed++);
+                mipmaps.push_back(new MipMap(data, w, h, format));
+                data.Free();
+                if (w == 1 && h == 1)
+                    break;
+            }
+            int mipsCount = mipmaps.count();
+            Image image(mipmaps, format);
+            ByteBuffer dds = image.StoreImageToDDS();
+            MemoryStream stream(dds);
+            Image::DDSHeader header{};
+            bool parsed = Image::ReadDDSHeader(stream, header);
+            qint64 ddsSize = dds.size();
+            dds.Free();
+            TEST_CHECK(parsed);
+            TEST_CHECK(header.pixelFormat == format);
+            TEST_CHECK(header.width == size[0] && header.height == size[1]);
+            TEST_CHECK(header.mipsCount == mipsCount);
+            TEST_CHECK(header.dataOffset + header.dataSize == ddsSize);
+        }
+    }
+    return true;
+}
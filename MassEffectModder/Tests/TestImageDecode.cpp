@@ -0,0 +1,117 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Image/Image.h>
+#include <Helpers/Logs.h>
+
+namespace {
+
+enum class Layout
+{
+    RGBA, ARGB, RGB, BGR, AlphaGreyscale
+};
+
+ByteBuffer DecodeToBytes(const ByteBuffer &src, int w, int h, PixelFormat format, Layout layout, bool clearAlpha)
+{
+    switch (layout)
+    {
+        case Layout::RGBA: return Image::convertRawToRGBA(src, w, h, format);
+        case Layout::ARGB: return Image::convertRawToARGB(src, w, h, format);
+        case Layout::RGB: return Image::convertRawToRGB(src, w, h, format);
+        case Layout::BGR: return Image::convertRawToBGR(src, w, h, format, clearAlpha);
+        case Layout::AlphaGreyscale: return Image::convertRawToAlphaGreyscale(src, w, h, format, clearAlpha);
+    }
+    return ByteBuffer();
+}
+
+// Reference result, image is fully decoded to floats and converted after
+ByteBuffer DecodeThroughFloat(const ByteBuffer &src, int w, int h, PixelFormat format, Layout layout, bool clearAlpha)
+{
+    auto pixels = Image::convertRawToInternal(src, w, h, format, clearAlpha);
+    ByteBuffer output;
+    switch (layout)
+    {
+        case Layout::RGBA: output = Image::InternalToRGBA(pixels, w, h); break;
+        case Layout::ARGB: output = Image::InternalToARGB(pixels, w, h); break;
+        case Layout::RGB: output = Image::InternalToRGB(pixels, w, h); break;
+        case Layout::BGR: output = Image::InternalToBGR(pixels, w, h); break;
+        case Layout::AlphaGreyscale: output = Image::InternalToAlphaGreyscale(pixels, w, h); break;
+    }
+    pixels.Free();
+    return output;
+}
+
+bool CompareDecoding(const ByteBuffer &src, int w, int h, PixelFormat format, Layout layout, bool clearAlpha)
+{
+    ByteBuffer bytes = DecodeToBytes(src, w, h, format, layout, clearAlpha);
+    ByteBuffer reference = DecodeThroughFloat(src, w, h, format, layout, clearAlpha);
+    bool identical = bytes.size() == reference.size() &&
+                     memcmp(bytes.ptr(), reference.ptr(), reference.size()) == 0;
+    if (!identical)
+    {
+        PERROR(QString("Byte decoding differs for format ") + Image::getEngineFormatType(format) +
+               " " + QString::number(w) + "x" + QString::number(h) +
+               ", layout: " + QString::number((int)layout) + ", clear alpha: " + QString::number(clearAlpha) + "\n");
+    }
+    bytes.Free();
+    reference.Free();
+    return identical;
+}
+
+} // namespace
+
+bool TestByteDecodingMatchesFloat()
+{
+    const PixelFormat formats[] =
+    {
+        PixelFormat::DXT1, PixelFormat::DXT3, PixelFormat::DXT5,
+        PixelFormat::ATI2, PixelFormat::BC5, PixelFormat::BC7
+    };
+    const int sizes[][2] = { { 4, 4 }, { 64, 32 }, { 8, 256 }, { 256, 256 } };
+    const Layout layouts[] = { Layout::RGBA, Layout::ARGB, Layout::RGB, Layout::BGR, Layout::AlphaGreyscale };
+
+    quint32 seed = 17;
+    for (auto format : formats)
+    {
+        for (auto size : sizes)
+        {
+            int w = size[0], h = size[1];
+            ByteBuffer data(MipMap::getBufferSize(w, h, format));
+            TestFillRandom(data.ptr(), data.size(), seed++);
+            if (format == PixelFormat::BC7)
+            {
+                // Reserved mode decodes to undefined texels
+                for (int b = 0; b < data.size(); b += 16)
+                    data.ptr()[b] |= 1 << (TestRandom(seed) % 8);
+            }
+            for (auto layout : layouts)
+            {
+                TEST_CHECK(CompareDecoding(data, w, h, format, layout, false));
+                if (layout == Layout::BGR || layout == Layout::AlphaGreyscale)
+                    TEST_CHECK(CompareDecoding(data, w, h, format, layout, true));
+            }
+            data.Free();
+        }
+    }
+    return true;
+}
@@ -0,0 +1,181 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Image/Image.h>
+#include <Helpers/Logs.h>
+
+namespace {
+
+// Mix of noise, flat and gradient blocks, values are whole bytes stored as floats
+ByteBuffer MakeEncodeImage(int w, int h, quint32 seed)
+{
+    ByteBuffer image(w * h * 4 * sizeof(float));
+    float *ptr = image.ptrAsFloat();
+    for (int by = 0; by < h / 4; by++)
+    {
+        for (int bx = 0; bx < w / 4; bx++)
+        {
+            int kind = TestRandom(seed) % 3;
+            int base[4], step[4];
+            for (int c = 0; c < 4; c++)
+            {
+                base[c] = TestRandom(seed) & 0xFF;
+                step[c] = (int)(TestRandom(seed) % 33) - 16;
+            }
+            for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    int value = base[c];
+                    if (kind == 0)
+                        value = TestRandom(seed) & 0xFF;
+                    else if (kind == 1)
+                        value = qBound(0, base[c] + step[c] * i, 255);
+                    ptr[((by * 4 + i / 4) * w + bx * 4 + i % 4) * 4 + c] = value / 255.0f;
+                }
+            }
+        }
+    }
+    return image;
+}
+
+// Single block fast alpha encoding: endpoints from the value range, index
+// from the nearest of the 8 interpolated values
+quint64 EncodeAlphaBlockReference(const float *src, int w, int bx, int by, int channel)
+{
+    int values[BLOCK_SIZE_4X4];
+    int minAlpha = 255, maxAlpha = 0;
+    for (int i = 0; i < BLOCK_SIZE_4X4; i++)
+    {
+        values[i] = ROUND_FLOAT_TO_BYTE(src[((by * 4 + i / 4) * w + bx * 4 + i % 4) * 4 + channel]);
+        minAlpha = qMin(minAlpha, values[i]);
+        maxAlpha = qMax(maxAlpha, values[i]);
+    }
+    quint64 bits = maxAlpha | (minAlpha << 8);
+    int range = maxAlpha - minAlpha;
+    for (int i = 0; i < BLOCK_SIZE_4X4 && range != 0; i++)
+    {
+        int step = ((values[i] - minAlpha) * 14 + range) / (2 * range);
+        quint64 index = step == 7 ? 0 : (step == 0 ? 1 : 8 - step);
+        bits |= index << (16 + 3 * i);
+    }
+    return bits;
+}
+
+} // namespace
+
+bool TestFastDxtGroupsMatchSingleBlocks()
+{
+    const int sizes[][2] = { { 4, 4 }, { 20, 8 }, { 32, 4 }, { 36, 20 }, { 132, 12 } };
+    Image::DxtQuality previous = Image::GetDxtQuality();
+    Image::SetDxtQuality(Image::DxtQuality::Fast);
+    bool passed = true;
+    quint32 seed = 11;
+    for (const auto &size : sizes)
+    {
+        int w = size[0], h = size[1];
+        ByteBuffer image = MakeEncodeImage(w, h, seed++);
+
+        // DXT1 punch-through alpha with zero threshold takes the single block encoder
+        ByteBuffer groups = Image::compressMipmap(PixelFormat::DXT1, image, w, h, false, 0, 1.0f);
+        ByteBuffer single = Image::compressMipmap(PixelFormat::DXT1, image, w, h, true, 0, 1.0f);
+        if (groups.size() != single.size() || memcmp(groups.ptr(), single.ptr(), single.size()) != 0)
+        {
+            PERROR(QString("Fast DXT1 groups differ from single blocks, size ") +
+                   QString::number(w) + "x" + QString::number(h) + "\n");
+            passed = false;
+        }
+        groups.Free();
+        single.Free();
+
+        ByteBuffer dxt5 = Image::compressMipmap(PixelFormat::DXT5, image, w, h, false, 0, 1.0f);
+        ByteBuffer ati2 = Image::compressMipmap(PixelFormat::ATI2, image, w, h, false, 0, 1.0f);
+        for (int by = 0; by < h / 4; by++)
+        {
+            for (int bx = 0; bx < w / 4; bx++)
+            {
+                qint64 offset = (by * (w / 4) + bx) * BLOCK_SIZE_4X4BPP8;
+                quint64 alpha = 0, x = 0, y = 0;
+                memcpy(&alpha, dxt5.ptr() + offset, 8);
+                memcpy(&x, ati2.ptr() + offset, 8);
+                memcpy(&y, ati2.ptr() + offset + 8, 8);
+                if (alpha != EncodeAlphaBlockReference(image.ptrAsFloat(), w, bx, by, 3) ||
+                    x != EncodeAlphaBlockReference(image.ptrAsFloat(), w, bx, by, 1) ||
+                    y != EncodeAlphaBlockReference(image.ptrAsFloat(), w, bx, by, 0))
+                {
+                    PERROR(QString("Fast alpha block differs from reference, size ") +
+                           QString::number(w) + "x" + QString::number(h) +
+                           ", block " + QString::number(bx) + "," + QString::number(by) + "\n");
+                    passed = false;
+                }
+            }
+        }
+        dxt5.Free();
+        ati2.Free();
+        image.Free();
+    }
+    Image::SetDxtQuality(previous);
+    TEST_CHECK(passed);
+    return true;
+}
+
+bool TestBlockMemoMatchesDirectEncoding()
+{
+    const PixelFormat formats[] = { PixelFormat::DXT1, PixelFormat::DXT3, PixelFormat::DXT5, PixelFormat::ATI2, PixelFormat::BC7 };
+    const int w = 32, h = 16;
+    ByteBuffer image = MakeEncodeImage(w, h, 5);
+
+    // Repeat a few blocks so the memo gets hits
+    float *ptr = image.ptrAsFloat();
+    for (int by = 0; by < h / 4; by++)
+    {
+        for (int bx = (by & 1) + 1; bx < w / 4; bx += 2)
+        {
+            for (int row = 0; row < 4; row++)
+                memcpy(ptr + ((by * 4 + row) * w + bx * 4) * 4, ptr + (row * w + (by % 2) * 4) * 4, 4 * 4 * sizeof(float));
+        }
+    }
+
+    Image::DxtQuality previousQuality = Image::GetDxtQuality();
+    Image::SetDxtQuality(Image::DxtQuality::Normal);
+    bool passed = true;
+    for (PixelFormat format : formats)
+    {
+        Image::SetBlockMemo(true);
+        ByteBuffer memo = Image::compressMipmap(format, image, w, h, false, 128, 0.2f);
+        Image::SetBlockMemo(false);
+        ByteBuffer direct = Image::compressMipmap(format, image, w, h, false, 128, 0.2f);
+        if (memo.size() != direct.size() || memcmp(memo.ptr(), direct.ptr(), direct.size()) != 0)
+        {
+            PERROR(QString("Block memo output differs for format ") + Image::getEngineFormatType(format) + "\n");
+            passed = false;
+        }
+        memo.Free();
+        direct.Free();
+    }
+    Image::SetBlockMemo(true);
+    Image::SetDxtQuality(previousQuality);
+    image.Free();
+    TEST_CHECK(passed);
+    return true;
+}
@@ -0,0 +1,103 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Image/Image.h>
+#include <Helpers/Logs.h>
+#include <Wrappers.h>
+
+namespace {
+
+bool CheckPngLoad(int bits, int width, int height, quint32 seed)
+{
+    qint64 count = static_cast<qint64>(width) * height * 4;
+    ByteBuffer source(count * bits / 8);
+    TestFillRandom(source.ptr(), source.size(), seed);
+
+    quint8 *png;
+    quint32 pngSize;
+    if (PngWriteBytes(source.ptr(), &png, &pngSize, width, height, bits, 1, PngFilterAdaptive, 1) != 0)
+    {
+        source.Free();
+        return false;
+    }
+    ByteBuffer pngData(png, pngSize);
+    free(png);
+
+    Image image(pngData, ImageFormat::PNG);
+    pngData.Free();
+    bool matches = image.getMipMaps().count() == 1 &&
+                   image.getPixelFormat() == PixelFormat::Internal &&
+                   image.isSource8Bits() == (bits == 8) &&
+                   image.getMipMaps().first()->getWidth() == width &&
+                   image.getMipMaps().first()->getHeight() == height;
+    if (matches)
+    {
+        const float *pixels = image.getMipMaps().first()->getRefData().ptrAsFloat();
+        const auto *source16 = reinterpret_cast<const quint16 *>(source.ptr());
+        for (qint64 i = 0; i < count && matches; i++)
+        {
+            float expected = bits == 16 ? source16[i] / 65535.0f : source.ptr()[i] / 255.0f;
+            matches = pixels[i] == expected;
+        }
+    }
+    if (!matches)
+    {
+        PERROR(QString("PNG load differs for ") + QString::number(bits) + " bits " +
+               QString::number(width) + "x" + QString::number(height) + "\n");
+    }
+    source.Free();
+    return matches;
+}
+
+} // namespace
+
+bool TestPngLoadMatchesSource()
+{
+    const int sizes[][2] = { { 64, 64 }, { 128, 16 }, { 1, 1 } };
+
+    quint32 seed = 1;
+    for (auto size : sizes)
+    {
+        TEST_CHECK(CheckPngLoad(8, size[0], size[1], seed++));
+        TEST_CHECK(CheckPngLoad(16, size[0], size[1], seed++));
+    }
+    return true;
+}
+
+bool TestPngLoadRejectsNonPowerOfTwo()
+{
+    ByteBuffer source(48 * 32 * 4);
+    TestFillRandom(source.ptr(), source.size(), 7);
+    quint8 *png;
+    quint32 pngSize;
+    bool written = PngWriteBytes(source.ptr(), &png, &pngSize, 48, 32, 8, 1, PngFilterNone, 1) == 0;
+    source.Free();
+    TEST_CHECK(written);
+    ByteBuffer pngData(png, pngSize);
+    free(png);
+
+    Image image(pngData, ImageFormat::PNG);
+    pngData.Free();
+    TEST_CHECK(image.getMipMaps().count() == 0);
+    return true;
+}
@@ -0,0 +1,130 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "Tests.h"
+#include <Image/Image.h>
+
+namespace {
+
+const int TestMipSize = 16;
+
+} // namespace
+
+bool TestByteBufferViewFreeKeepsMemory()
+{
+    quint8 memory[64];
+    TestFillRandom(memory, sizeof(memory), 3);
+    quint8 expected[64];
+    memcpy(expected, memory, sizeof(memory));
+
+    ByteBuffer view = ByteBuffer::view(memory, sizeof(memory));
+    TEST_CHECK(!view.isOwned());
+    ByteBuffer copy = view;
+    TEST_CHECK(!copy.isOwned());
+    view.Free();
+    copy.Free();
+    TEST_CHECK(view.ptr() == nullptr);
+    TEST_CHECK(memcmp(memory, expected, sizeof(memory)) == 0);
+
+    ByteBuffer owned(memory, sizeof(memory));
+    TEST_CHECK(owned.isOwned());
+    owned.Free();
+    return true;
+}
+
+bool TestMipMapViewCopyOnWrite()
+{
+    int size = MipMap::getBufferSize(TestMipSize, TestMipSize, PixelFormat::RGBA);
+    ByteBuffer source(size);
+    TestFillRandom(source.ptr(), source.size(), 5);
+    ByteBuffer expected(source.ptr(), source.size());
+    quint8 *sourcePtr = source.ptr();
+
+    auto owner = MipMap::shareBuffer(source);
+    std::weak_ptr<const void> watcher = owner;
+    auto first = new MipMap(owner, ByteBuffer::view(sourcePtr, size), TestMipSize, TestMipSize, PixelFormat::RGBA);
+    auto second = new MipMap(owner, ByteBuffer::view(sourcePtr, size), TestMipSize, TestMipSize, PixelFormat::RGBA);
+    owner.reset();
+
+    // Views share the source and keep it alive
+    TEST_CHECK(first->isView() && second->isView());
+    TEST_CHECK(first->getRefData().ptr() == sourcePtr);
+    TEST_CHECK(!first->getRefData().isOwned());
+    TEST_CHECK(!watcher.expired());
+
+    // Writing detaches into a private copy and leaves the source and other views untouched
+    ByteBuffer &writable = first->getWritableData();
+    TEST_CHECK(!first->isView());
+    TEST_CHECK(writable.isOwned());
+    TEST_CHECK(writable.ptr() != sourcePtr);
+    TEST_CHECK(memcmp(writable.ptr(), expected.ptr(), size) == 0);
+    memset(writable.ptr(), 0, size);
+    TEST_CHECK(memcmp(sourcePtr, expected.ptr(), size) == 0);
+    TEST_CHECK(memcmp(second->getRefData().ptr(), expected.ptr(), size) == 0);
+    TEST_CHECK(!watcher.expired());
+
+    // Source is released with the last view
+    first->Free();
+    delete first;
+    TEST_CHECK(!watcher.expired());
+    second->Free();
+    TEST_CHECK(watcher.expired());
+    TEST_CHECK(second->getRefData().ptr() == nullptr);
+    delete second;
+
+    expected.Free();
+    return true;
+}
+
+bool TestImageViewOutlivesCallerOwner()
+{
+    QList<MipMap *> mipmaps;
+    for (int size = TestMipSize; size >= 1; size /= 2)
+    {
+        ByteBuffer data(MipMap::getBufferSize(size, size, PixelFormat::RGBA));
+        TestFillRandom(data.ptr(), data.size(), size);
+        mipmaps.push_back(new MipMap(data, size, size, PixelFormat::RGBA));
+        data.Free();
+    }
+    Image source(mipmaps, PixelFormat::RGBA);
+    ByteBuffer dds = source.StoreImageToDDS();
+    ByteBuffer expected(dds.ptr(), dds.size());
+
+    auto owner = MipMap::shareBuffer(dds);
+    std::weak_ptr<const void> watcher = owner;
+    {
+        Image image(dds, owner, ImageFormat::DDS);
+        owner.reset();
+        TEST_CHECK(image.getMipMaps().count() == source.getMipMaps().count());
+        TEST_CHECK(image.getMipMaps().first()->isView());
+        TEST_CHECK(!watcher.expired());
+
+        memset(image.getMipMaps().first()->getWritableData().ptr(), 0xFF,
+               image.getMipMaps().first()->getRefData().size());
+        TEST_CHECK(memcmp(dds.ptr(), expected.ptr(), dds.size()) == 0);
+        TEST_CHECK(image.getMipMaps().last()->isView());
+    }
+    TEST_CHECK(watcher.expired());
+
+    expected.Free();
+    return true;
+}
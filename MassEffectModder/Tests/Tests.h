@@ -0,0 +1,82 @@
+/*
+ * MassEffectModder
+ *
+ * Copyright (C) 2018-2022 Pawel Kolodziejski
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef TESTS_H
+#define TESTS_H
+
+#include <Types/MemTypes.h>
+
+typedef bool (*TestFunction)();
+
+struct TestCase
+{
+    const char *name;
+    TestFunction function;
+};
+
+void TestFailed(const char *file, int line, const char *expression);
+
+#define TEST_CHECK(expression) \
+    do { if (!(expression)) { TestFailed(__FILE__, __LINE__, #expression); return false; } } while (0)
+
+quint32 TestRandom(quint32 &seed);
+void TestFillRandom(quint8 *ptr, qint64 size, quint32 seed);
+QString TestTempPath(const QString &name);
+
+// ImageDDS
+bool TestStreamedDDSMatchesBuffered();
+bool TestTruncatedDDSLoadsWithoutMips();
+bool TestDDSHeaderMatchesStoredImage();
+
+// ImagePng
+bool TestPngLoadMatchesSource();
+bool TestPngLoadRejectsNonPowerOfTwo();
+
+// ConvertCache
+bool TestConvertCacheRoundTrip();
+bool TestConvertCacheKeyTracksParams();
+bool TestConvertCacheRejectsBadEntries();
+bool TestConvertCacheTrimEvictsOldest();
+
+// MipMap
+bool TestByteBufferViewFreeKeepsMemory();
+bool TestMipMapViewCopyOnWrite();
+bool TestImageViewOutlivesCallerOwner();
+
+// ImageDecode
+bool TestByteDecodingMatchesFloat();
+
+// ImageEncode
+bool TestFastDxtGroupsMatchSingleBlocks();
+bool TestBlockMemoMatchesDirectEncoding();
+
+// ImageAlpha
+bool TestRawAlphaDetectionDXT();
+bool TestRawAlphaDetectionBC7();
+bool TestRawAlphaDetectionUncompressed();
+
+// BenchImage
+bool BenchDxtEncoders();
+bool BenchBc7Encoder();
+bool BenchMipFilters();
+
+#endif
@@ -0,0 +1,95 @@
+QT += core
+QT -= gui
+
+CONFIG += c++17 static precompile_header console testcase
+CONFIG -= app_bundle
+CONFIG += sdk_no_version_check
+
+TARGET = MassEffectModderTests
+
+TEMPLATE = app
+
+SOURCES += \
+    ../MassEffectModder/Helpers/FileStream.cpp \
+    ../MassEffectModder/Helpers/Logs.cpp \
+    ../MassEffectModder/Helpers/MemoryStream.cpp \
+    ../MassEffectModder/Helpers/MiscHelpers.cpp \
+    ../MassEffectModder/Helpers/Stream.cpp \
+    ../MassEffectModder/Image/Image.cpp \
+    ../MassEffectModder/Image/ImageBMP.cpp \
+    ../MassEffectModder/Image/ImageDDS.cpp \
+    ../MassEffectModder/Image/ImageScale.cpp \
+    ../MassEffectModder/Image/ImageTGA.cpp \
+    ../MassEffectModder/MipMaps/MipMap.cpp \
+    ../MassEffectModder/Misc/ModConvertCache.cpp \
+    ../MassEffectModder/Program/SignalHandler.cpp \
+    ../Wrappers/WrapperBc7.cpp \
+    ../Wrappers/WrapperDxtc.cpp \
+    ../Wrappers/WrapperPng.cpp \
+    ../Wrappers/WrapperZlib.cpp \
+    BenchImage.cpp \
+    Main.cpp \
+    TestConvertCache.cpp \
+    TestImageAlpha.cpp \
+    TestImageDDS.cpp \
+    TestImageDecode.cpp \
+    TestImageEncode.cpp \
+    TestImagePng.cpp \
+    TestMipMap.cpp
+
+PRECOMPILED_HEADER = ../MassEffectModder/Types/Precompiled.h
+
+HEADERS += \
+    Tests.h
+
+DEFINES += QT_DEPRECATED_WARNINGS
+# Conversion cache keys only need a stable version string
+DEFINES += MEM_VERSION=\"0\"
+
+precompile_header:!isEmpty(PRECOMPILED_HEADER) {
+    DEFINES += USING_PCH
+}
+PRECOMPILED_DIR = ".pch"
+
+QMAKE_CXXFLAGS +=
+
+QMAKE_CXXFLAGS_DEBUG += -g
+
+INCLUDEPATH += $$PWD/../Wrappers $$PWD/../MassEffectModder \
+    $$PWD/../Libs/bc7 $$PWD/../Libs/dxtc $$PWD/../Libs/png $$PWD/../Libs/zlib
+!win32 {
+    INCLUDEPATH += $$PWD/../Libs/omp
+}
+
+win32-g++: {
+# Disable compiler warning
+QMAKE_CXXFLAGS += -Wno-deprecated-copy
+Release:LIBS += \
+    -L$$OUT_PWD/../Libs/bc7/release -lbc7 \
+    -L$$OUT_PWD/../Libs/dxtc/release -ldxtc \
+    -L$$OUT_PWD/../Libs/png/release -lpng \
+    -L$$OUT_PWD/../Libs/zlib/release -lzlib
+Debug:LIBS += \
+    -L$$OUT_PWD/../Libs/bc7/debug -lbc7 \
+    -L$$OUT_PWD/../Libs/dxtc/debug -ldxtc \
+    -L$$OUT_PWD/../Libs/png/debug -lpng \
+    -L$$OUT_PWD/../Libs/zlib/debug -lzlib
+QMAKE_CXXFLAGS += -fopenmp
+LIBS += -lgomp
+} else:unix: {
+LIBS += \
+    -L$$OUT_PWD/../Libs/bc7 -lbc7 \
+    -L$$OUT_PWD/../Libs/dxtc -ldxtc \
+    -L$$OUT_PWD/../Libs/omp -lomp \
+    -L$$OUT_PWD/../Libs/png -lpng \
+    -L$$OUT_PWD/../Libs/zlib -lzlib
+}
+
+macos {
+    QMAKE_CXXFLAGS += -Xpreprocessor -fopenmp
+}
+
+linux {
+    QMAKE_CXXFLAGS += -fopenmp
+    LIBS += -ldl
+}
@@ -51,12 +51,12 @@ class BC7BlockDecoder;
 
 int CMP_InitializeBC7Library();
 int CMP_ShutdownBC7Library();
-int CMP_CreateBC7Encoder(double quality, bool restrictColour, bool restrictAlpha, CODEC_DWORD modeMask, double performance, BC7BlockEncoder **encoder);
+int CMP_CreateBC7Encoder(float quality, bool restrictColour, bool restrictAlpha, CODEC_DWORD modeMask, float performance, BC7BlockEncoder **encoder);
 int CMP_CreateBC7Decoder(BC7BlockDecoder **decoder);
 int CMP_DestroyBC7Encoder(BC7BlockEncoder *encoder);
 int CMP_DestroyBC7Decoder(BC7BlockDecoder *decoder);
-int CMP_EncodeBC7Block(BC7BlockEncoder *encoder, double in[BLOCK_SIZE_4X4][BC7_COMPONENT_COUNT], CODEC_BYTE *out);
-int CMP_DecodeBC7Block(BC7BlockDecoder *decoder, CODEC_BYTE *in, double out[BLOCK_SIZE_4X4][BC7_COMPONENT_COUNT]);
+int CMP_EncodeBC7Block(BC7BlockEncoder *encoder, float in[BLOCK_SIZE_4X4][BC7_COMPONENT_COUNT], CODEC_BYTE *out);
+int CMP_DecodeBC7Block(BC7BlockDecoder *decoder, CODEC_BYTE *in, float out[BLOCK_SIZE_4X4][BC7_COMPONENT_COUNT]);
 
 LIB_EXPORT int BC7InitializeLibrary()
 {
@@ -68,7 +68,7 @@ LIB_EXPORT int BC7ShutdownLibrary()
     return CMP_ShutdownBC7Library();
 }
 
-LIB_EXPORT int BC7CreateEncoder(double quality, bool restrictColour, bool restrictAlpha, CODEC_DWORD modeMask, double performance, BC7BlockEncoder **encoder)
+LIB_EXPORT int BC7CreateEncoder(float quality, bool restrictColour, bool restrictAlpha, CODEC_DWORD modeMask, float performance, BC7BlockEncoder **encoder)
 {
     return CMP_CreateBC7Encoder(quality, restrictColour, restrictAlpha, modeMask, performance, encoder);
 }
@@ -88,12 +88,12 @@ LIB_EXPORT int BC7DestoyDecoder(BC7BlockDecoder *decoder)
     return CMP_DestroyBC7Decoder(decoder);
 }
 
-LIB_EXPORT int BC7CompressBlock(BC7BlockEncoder *encoder, double in[BLOCK_SIZE_4X4][BC7_COMPONENT_COUNT], CODEC_BYTE *out)
+LIB_EXPORT int BC7CompressBlock(BC7BlockEncoder *encoder, float in[BLOCK_SIZE_4X4][BC7_COMPONENT_COUNT], CODEC_BYTE *out)
 {
     return CMP_EncodeBC7Block(encoder, in, out);
 }
 
-LIB_EXPORT int BC7DecompressBlock(BC7BlockDecoder *decoder, CODEC_BYTE *in, double out[BLOCK_SIZE_4X4][BC7_COMPONENT_COUNT])
+LIB_EXPORT int BC7DecompressBlock(BC7BlockDecoder *decoder, CODEC_BYTE *in, float out[BLOCK_SIZE_4X4][BC7_COMPONENT_COUNT])
 {
     return CMP_DecodeBC7Block(decoder, in, out);
 }
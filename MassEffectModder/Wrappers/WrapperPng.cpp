@@ -21,12 +21,24 @@
 
 #define PNG_DEBUG 3
 #include <png.h>
+#include <zlib.h>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Wrappers.h"
 
 enum {
-    PNG_SIGN_LEN = 8
+    PNG_SIGN_LEN = 8,
+    PNG_CHUNK_OVERHEAD = 12,
+    PNG_IHDR_LEN = 13,
+    PNG_ZLIB_HEADER_LEN = 2,
+    PNG_ZLIB_WINDOW = 32768,
+    PNG_STRIP_MIN_SIZE = 0x40000
 };
 
 typedef struct {
@@ -35,8 +47,21 @@ typedef struct {
     png_size_t bufferSize;
 } IoHandle;
 
+// Range of rows compressed as separate deflate stream, stored as own IDAT chunk
+typedef struct {
+    size_t firstRow;
+    size_t numRows;
+    size_t offset;
+    size_t capacity;
+    size_t length;
+    uLong adler;
+    bool failed;
+} PngStrip;
+
 namespace {
 
+const unsigned char pngSignature[PNG_SIGN_LEN] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
 void ReadFunction(png_structp pngStruct, png_bytep buffer, png_size_t count)
 {
     auto *handle = static_cast<IoHandle *>(png_get_io_ptr(pngStruct));
@@ -47,35 +72,16 @@ void ReadFunction(png_structp pngStruct, png_bytep buffer, png_size_t count)
     handle->bufferOffset += count;
 }
 
-void WriteFunction(png_structp pngStruct, png_bytep buffer, png_size_t count)
-{
-    auto *handle = static_cast<IoHandle *>(png_get_io_ptr(pngStruct));
-    if (!handle->bufferPtr)
-        handle->bufferPtr = static_cast<unsigned char *>(malloc(count));
-    else
-    {
-        png_size_t newPosition = handle->bufferOffset + count;
-        if (newPosition > handle->bufferSize)
-        {
-            handle->bufferSize = newPosition + handle->bufferSize * 2;
-            handle->bufferPtr = static_cast<unsigned char *>(realloc(handle->bufferPtr, handle->bufferSize));
-        }
-    }
-    memcpy(handle->bufferPtr + handle->bufferOffset, buffer, count);
-    handle->bufferOffset += count;
-}
-
-} // namespace
-
-int PngRead(unsigned char *src, unsigned int srcSize,
-             float **dst, unsigned int *dstSize,
-             unsigned int *width, unsigned int *height, bool &source8Bits)
+// Output is RGBA, 8 bits per channel or 16 bits in host byte order
+int ReadPngImage(unsigned char *src, unsigned int srcSize,
+                 unsigned char **dst, unsigned int *dstSize,
+                 unsigned int *width, unsigned int *height, int &sourceBits, int &bits)
 {
     IoHandle handle;
     png_structp pngStruct;
     png_infop pngInfo;
     png_uint_32 pngWidth, pngHeight;
-    int bits, colorType;
+    int colorType;
 
     if (!png_check_sig(src, PNG_SIGN_LEN) || srcSize < PNG_SIGN_LEN)
         return -1;
@@ -101,19 +107,19 @@ int PngRead(unsigned char *src, unsigned int srcSize,
 
     png_read_info(pngStruct, pngInfo);
 
-    if (png_get_IHDR(pngStruct, pngInfo, &pngWidth, &pngHeight, &bits, &colorType, nullptr, nullptr, nullptr) == 0)
+    if (png_get_IHDR(pngStruct, pngInfo, &pngWidth, &pngHeight, &sourceBits, &colorType, nullptr, nullptr, nullptr) == 0)
     {
         png_destroy_read_struct(&pngStruct, &pngInfo, nullptr);
         return -1;
     }
     *width = pngWidth;
     *height = pngHeight;
-    source8Bits = bits == 8;
+    bits = sourceBits == 16 ? 16 : 8;
 
     png_set_packing(pngStruct);
     if (colorType == PNG_COLOR_TYPE_PALETTE)
         png_set_palette_to_rgb(pngStruct);
-    if (colorType == PNG_COLOR_TYPE_GRAY && bits < 8)
+    if (colorType == PNG_COLOR_TYPE_GRAY && sourceBits < 8)
         png_set_expand_gray_1_2_4_to_8(pngStruct);
     png_set_invert_mono(pngStruct);
     if (png_get_valid(pngStruct, pngInfo, PNG_INFO_tRNS) != 0)
@@ -128,44 +134,46 @@ int PngRead(unsigned char *src, unsigned int srcSize,
 
     png_read_update_info(pngStruct, pngInfo);
 
-    *dstSize = pngWidth * pngHeight * 4 * sizeof(float);
-    float *dstPtr = *dst = new float[*dstSize];
+    size_t channelSize = bits / 8;
+    *dstSize = pngWidth * pngHeight * 4 * channelSize;
+    unsigned char *dstPtr = *dst = new unsigned char[*dstSize];
     if (*dst == nullptr)
     {
         png_destroy_read_struct(&pngStruct, &pngInfo, nullptr);
         return -1;
     }
 
-    unsigned char lineData8[png_get_rowbytes(pngStruct, pngInfo)];
-    unsigned short lineData16[png_get_rowbytes(pngStruct, pngInfo)];
-    int dstOffset = 0;
+    // Rows come as A, B, G, R after transforms above
+    std::vector<unsigned char> lineData(png_get_rowbytes(pngStruct, pngInfo));
+    size_t dstOffset = 0;
     for (png_uint_32 y = 0; y < pngHeight; y++)
     {
-        int lineOffset = 0;
+        png_read_row(pngStruct, lineData.data(), nullptr);
         if (bits == 16)
         {
-            png_read_row(pngStruct, (png_bytep)lineData16, nullptr);
-            for (png_uint_32 x = 0; x < pngWidth; x++)
+            auto *line16 = reinterpret_cast<const unsigned short *>(lineData.data());
+            auto *dst16 = reinterpret_cast<unsigned short *>(dstPtr + dstOffset);
+            for (png_uint_32 x = 0; x < pngWidth; x++, line16 += 4, dst16 += 4)
             {
-                dstPtr[dstOffset + 3] = lineData16[lineOffset++] / 65535.0f;
-                dstPtr[dstOffset + 2] = lineData16[lineOffset++] / 65535.0f;
-                dstPtr[dstOffset + 1] = lineData16[lineOffset++] / 65535.0f;
-                dstPtr[dstOffset + 0] = lineData16[lineOffset++] / 65535.0f;
-                dstOffset += 4;
+                dst16[3] = line16[0];
+                dst16[2] = line16[1];
+                dst16[1] = line16[2];
+                dst16[0] = line16[3];
             }
         }
         else
         {
-            png_read_row(pngStruct, (png_bytep)lineData8, nullptr);
-            for (png_uint_32 x = 0; x < pngWidth; x++)
+            const unsigned char *line8 = lineData.data();
+            unsigned char *dst8 = dstPtr + dstOffset;
+            for (png_uint_32 x = 0; x < pngWidth; x++, line8 += 4, dst8 += 4)
             {
-                dstPtr[dstOffset + 3] = lineData8[lineOffset++] / 255.0f;
-                dstPtr[dstOffset + 2] = lineData8[lineOffset++] / 255.0f;
-                dstPtr[dstOffset + 1] = lineData8[lineOffset++] / 255.0f;
-                dstPtr[dstOffset + 0] = lineData8[lineOffset++] / 255.0f;
-                dstOffset += 4;
+                dst8[3] = line8[0];
+                dst8[2] = line8[1];
+                dst8[1] = line8[2];
+                dst8[0] = line8[3];
             }
         }
+        dstOffset += pngWidth * 4 * channelSize;
     }
     png_read_end(pngStruct, pngInfo);
 
@@ -174,86 +182,324 @@ int PngRead(unsigned char *src, unsigned int srcSize,
     return 0;
 }
 
-int PngWrite(const float *src, unsigned char **dst, unsigned int *dstSize,
-             unsigned int width, unsigned int height, bool storeAs8bits)
+void WriteUInt32BE(unsigned char *dst, unsigned int value)
 {
-    IoHandle handle;
-    png_structp pngStruct;
-    png_infop pngInfo;
+    dst[0] = (value >> 24) & 0xFF;
+    dst[1] = (value >> 16) & 0xFF;
+    dst[2] = (value >> 8) & 0xFF;
+    dst[3] = value & 0xFF;
+}
 
-    handle.bufferOffset = 0;
-    handle.bufferSize = 0;
-    handle.bufferPtr = nullptr;
+// Chunk data must be already placed after 8 bytes of length and type
+size_t WriteChunk(unsigned char *dst, const char *type, size_t length)
+{
+    WriteUInt32BE(dst, length);
+    memcpy(dst + 4, type, 4);
+    uLong crc = crc32(0, dst + 4, length + 4);
+    WriteUInt32BE(dst + 8 + length, crc);
+    return length + PNG_CHUNK_OVERHEAD;
+}
 
-    pngStruct = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-    if (!pngStruct)
-        return -1;
+// PNG stores 16 bits samples as big endian
+void ConvertRowToPng(const unsigned char *src, unsigned char *dst, size_t rowBytes, int bits)
+{
+    if (bits == 8)
+    {
+        memcpy(dst, src, rowBytes);
+        return;
+    }
+    auto *src16 = reinterpret_cast<const unsigned short *>(src);
+    for (size_t i = 0; i < rowBytes / 2; i++)
+    {
+        dst[i * 2 + 0] = src16[i] >> 8;
+        dst[i * 2 + 1] = src16[i] & 0xFF;
+    }
+}
 
-    pngInfo = png_create_info_struct(pngStruct);
-    if (!pngInfo)
+unsigned char PaethPredictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
+
+void FilterRowWith(int filter, const unsigned char *row, const unsigned char *prev,
+                   unsigned char *out, size_t rowBytes, size_t bpp)
+{
+    switch (filter)
     {
-        png_destroy_write_struct(&pngStruct, &pngInfo);
-        return -1;
+    case PngFilterSub:
+        for (size_t i = 0; i < rowBytes; i++)
+            out[i] = row[i] - (i >= bpp ? row[i - bpp] : 0);
+        break;
+    case PngFilterUp:
+        for (size_t i = 0; i < rowBytes; i++)
+            out[i] = row[i] - prev[i];
+        break;
+    case PngFilterAverage:
+        for (size_t i = 0; i < rowBytes; i++)
+            out[i] = row[i] - (((i >= bpp ? row[i - bpp] : 0) + prev[i]) >> 1);
+        break;
+    case PngFilterPaeth:
+        for (size_t i = 0; i < rowBytes; i++)
+        {
+            out[i] = row[i] - PaethPredictor(i >= bpp ? row[i - bpp] : 0, prev[i],
+                                             i >= bpp ? prev[i - bpp] : 0);
+        }
+        break;
+    default:
+        memcpy(out, row, rowBytes);
+        break;
     }
+}
 
-    int bits = 16;
-    float scale = 65535.0f;
-    if (storeAs8bits)
+// Adaptive mode picks filter with minimum sum of absolute differences, same as libpng heuristic
+void FilterRow(int filterMode, const unsigned char *row, const unsigned char *prev,
+               unsigned char *out, size_t rowBytes, size_t bpp, unsigned char *scratch)
+{
+    if (filterMode != PngFilterAdaptive)
     {
-        bits = 8;
-        scale = 255.0f;
+        out[0] = filterMode;
+        FilterRowWith(filterMode, row, prev, out + 1, rowBytes, bpp);
+        return;
     }
-    png_set_IHDR(pngStruct, pngInfo, width, height,
-                 bits, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
-                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
 
-    png_set_write_fn(pngStruct, &handle, WriteFunction, nullptr);
+    unsigned long bestSum = ~0UL;
+    for (int filter = PngFilterNone; filter <= PngFilterPaeth; filter++)
+    {
+        FilterRowWith(filter, row, prev, scratch, rowBytes, bpp);
+        unsigned long sum = 0;
+        for (size_t i = 0; i < rowBytes && sum < bestSum; i++)
+            sum += abs(static_cast<signed char>(scratch[i]));
+        if (sum < bestSum)
+        {
+            bestSum = sum;
+            out[0] = filter;
+            memcpy(out + 1, scratch, rowBytes);
+        }
+    }
+}
 
-    png_write_info(pngStruct, pngInfo);
+// Filters rows of strip together with rows preceding it which become deflate dictionary
+void CompressStrip(const unsigned char *src, unsigned char *dst, PngStrip &strip, size_t rowBytes,
+                   int bits, int compressionLevel, int filterMode, bool firstStrip, bool lastStrip)
+{
+    size_t bpp = 4 * bits / 8;
+    size_t filteredRowBytes = rowBytes + 1;
+    size_t dictRows = (PNG_ZLIB_WINDOW + filteredRowBytes - 1) / filteredRowBytes;
+    size_t startRow = strip.firstRow > dictRows ? strip.firstRow - dictRows : 0;
+    size_t numRows = strip.firstRow + strip.numRows - startRow;
+
+    std::vector<unsigned char> filtered(numRows * filteredRowBytes);
+    std::vector<unsigned char> prevRow(rowBytes, 0), curRow(rowBytes), scratch(rowBytes);
+    if (startRow != 0)
+        ConvertRowToPng(src + (startRow - 1) * rowBytes, prevRow.data(), rowBytes, bits);
+    for (size_t y = 0; y < numRows; y++)
+    {
+        ConvertRowToPng(src + (startRow + y) * rowBytes, curRow.data(), rowBytes, bits);
+        FilterRow(filterMode, curRow.data(), prevRow.data(), filtered.data() + y * filteredRowBytes,
+                  rowBytes, bpp, scratch.data());
+        prevRow.swap(curRow);
+    }
 
-    png_set_swap(pngStruct);
-    png_set_swap_alpha(pngStruct);
-    png_set_bgr(pngStruct);
+    size_t dictLength = (strip.firstRow - startRow) * filteredRowBytes;
+    const unsigned char *input = filtered.data() + dictLength;
+    size_t inputLength = strip.numRows * filteredRowBytes;
+    strip.adler = adler32(adler32(0, Z_NULL, 0), input, inputLength);
+
+    z_stream stream{};
+    int strategy = filterMode == PngFilterNone ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    if (deflateInit2(&stream, compressionLevel, Z_DEFLATED, -15, 8, strategy) != Z_OK)
+    {
+        strip.failed = true;
+        return;
+    }
+    if (dictLength != 0)
+    {
+        const size_t zlibWindow = PNG_ZLIB_WINDOW;
+        size_t windowLength = dictLength < zlibWindow ? dictLength : zlibWindow;
+        deflateSetDictionary(&stream, input - windowLength, windowLength);
+    }
+
+    unsigned char *data = dst + strip.offset + 8;
+    size_t headerLength = 0;
+    if (firstStrip)
+    {
+        int level = compressionLevel == Z_DEFAULT_COMPRESSION ? 6 : compressionLevel;
+        unsigned int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+        unsigned int header = (0x78 << 8) | (flevel << 6);
+        header += 31 - (header % 31);
+        data[0] = header >> 8;
+        data[1] = header & 0xFF;
+        headerLength = PNG_ZLIB_HEADER_LEN;
+    }
+
+    // Non final strips end with sync flush so streams concatenate on byte boundary
+    stream.next_in = const_cast<unsigned char *>(input);
+    stream.avail_in = inputLength;
+    stream.next_out = data + headerLength;
+    stream.avail_out = strip.capacity - headerLength;
+    int status = deflate(&stream, lastStrip ? Z_FINISH : Z_SYNC_FLUSH);
+    if ((lastStrip && status != Z_STREAM_END) || (!lastStrip && status != Z_OK) ||
+        stream.avail_in != 0 || stream.avail_out == 0)
+    {
+        strip.failed = true;
+    }
+    strip.length = headerLength + stream.total_out;
+    deflateEnd(&stream);
 
-    unsigned char lineData8[width * 4];
-    unsigned short lineData16[width * 4];
-    int srcOffset = 0;
-    for (png_uint_32 y = 0; y < height; y++)
+    if (!strip.failed)
+        WriteChunk(dst + strip.offset, "IDAT", strip.length);
+}
+
+} // namespace
+
+int PngReadBytes(unsigned char *src, unsigned int srcSize,
+                 unsigned char **dst, unsigned int *dstSize,
+                 unsigned int *width, unsigned int *height, int *bits, int *sourceBits)
+{
+    int pngSourceBits;
+    if (ReadPngImage(src, srcSize, dst, dstSize, width, height, pngSourceBits, *bits) != 0)
+        return -1;
+    if (sourceBits != nullptr)
+        *sourceBits = pngSourceBits;
+    return 0;
+}
+
+int PngWriteBytes(const unsigned char *src, unsigned char **dst, unsigned int *dstSize,
+                  unsigned int width, unsigned int height, int bits,
+                  int compressionLevel, int filterMode, int numThreads)
+{
+    if ((bits != 8 && bits != 16) || width == 0 || height == 0 ||
+        filterMode < PngFilterNone || filterMode > PngFilterAdaptive)
+    {
+        return -1;
+    }
+    if (compressionLevel < Z_DEFAULT_COMPRESSION || compressionLevel > Z_BEST_COMPRESSION)
+        compressionLevel = Z_DEFAULT_COMPRESSION;
+    if (numThreads <= 0)
+        numThreads = std::thread::hardware_concurrency();
+    if (numThreads <= 0)
+        numThreads = 1;
+
+    size_t rowBytes = static_cast<size_t>(width) * 4 * bits / 8;
+    size_t filteredRowBytes = rowBytes + 1;
+    size_t totalSize = filteredRowBytes * height;
+
+    size_t numStrips = 1;
+    if (numThreads > 1)
     {
-        if (bits == 8)
+        numStrips = totalSize / PNG_STRIP_MIN_SIZE;
+        if (numStrips > static_cast<size_t>(numThreads) * 4)
+            numStrips = numThreads * 4;
+        if (numStrips > height)
+            numStrips = height;
+        if (numStrips == 0)
+            numStrips = 1;
+    }
+    size_t rowsPerStrip = (height + numStrips - 1) / numStrips;
+    numStrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+
+    // Output is sized for worst case up front, strips are compacted in place afterwards
+    std::vector<PngStrip> strips(numStrips);
+    size_t offset = PNG_SIGN_LEN + PNG_CHUNK_OVERHEAD + PNG_IHDR_LEN;
+    for (size_t i = 0; i < numStrips; i++)
+    {
+        PngStrip &strip = strips[i];
+        strip.firstRow = i * rowsPerStrip;
+        strip.numRows = height - strip.firstRow < rowsPerStrip ? height - strip.firstRow : rowsPerStrip;
+        strip.offset = offset;
+        strip.capacity = compressBound(strip.numRows * filteredRowBytes) + 16 +
+                         (i == 0 ? PNG_ZLIB_HEADER_LEN : 0);
+        strip.length = 0;
+        strip.adler = 0;
+        strip.failed = false;
+        offset += strip.capacity + PNG_CHUNK_OVERHEAD;
+    }
+    size_t bufferSize = offset + 4 + PNG_CHUNK_OVERHEAD + PNG_CHUNK_OVERHEAD;
+    auto *buffer = static_cast<unsigned char *>(malloc(bufferSize));
+    if (buffer == nullptr)
+        return -1;
+
+    std::atomic<size_t> nextStrip(0);
+    auto worker = [&]() {
+        for (size_t i = nextStrip++; i < numStrips; i = nextStrip++)
         {
-            int lineOffset = 0;
-            for (png_uint_32 x = 0; x < width; x++)
-            {
-                lineData8[lineOffset++] = roundf(src[srcOffset + 3] * scale);
-                lineData8[lineOffset++] = roundf(src[srcOffset + 2] * scale);
-                lineData8[lineOffset++] = roundf(src[srcOffset + 1] * scale);
-                lineData8[lineOffset++] = roundf(src[srcOffset + 0] * scale);
-                srcOffset += 4;
-            }
-            png_write_row(pngStruct, (png_bytep)lineData8);
+            CompressStrip(src, buffer, strips[i], rowBytes, bits, compressionLevel, filterMode,
+                          i == 0, i == numStrips - 1);
         }
-        else
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < static_cast<size_t>(numThreads) && t < numStrips; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+        thread.join();
+
+    memcpy(buffer, pngSignature, PNG_SIGN_LEN);
+    size_t pos = PNG_SIGN_LEN;
+    unsigned char *ihdr = buffer + pos + 8;
+    WriteUInt32BE(ihdr, width);
+    WriteUInt32BE(ihdr + 4, height);
+    ihdr[8] = bits;
+    ihdr[9] = PNG_COLOR_TYPE_RGB_ALPHA;
+    ihdr[10] = PNG_COMPRESSION_TYPE_DEFAULT;
+    ihdr[11] = PNG_FILTER_TYPE_DEFAULT;
+    ihdr[12] = PNG_INTERLACE_NONE;
+    pos += WriteChunk(buffer + pos, "IHDR", PNG_IHDR_LEN);
+
+    uLong adler = adler32(0, Z_NULL, 0);
+    for (size_t i = 0; i < numStrips; i++)
+    {
+        if (strips[i].failed)
         {
-            int lineOffset = 0;
-            for (png_uint_32 x = 0; x < width; x++)
-            {
-                lineData16[lineOffset++] = roundf(src[srcOffset + 3] * scale);
-                lineData16[lineOffset++] = roundf(src[srcOffset + 2] * scale);
-                lineData16[lineOffset++] = roundf(src[srcOffset + 1] * scale);
-                lineData16[lineOffset++] = roundf(src[srcOffset + 0] * scale);
-                srcOffset += 4;
-            }
-            png_write_row(pngStruct, (png_bytep)lineData16);
+            free(buffer);
+            return -1;
         }
+        size_t chunkLength = strips[i].length + PNG_CHUNK_OVERHEAD;
+        if (pos != strips[i].offset)
+            memmove(buffer + pos, buffer + strips[i].offset, chunkLength);
+        pos += chunkLength;
+        adler = adler32_combine(adler, strips[i].adler, strips[i].numRows * filteredRowBytes);
     }
 
-    png_write_end(pngStruct, nullptr);
-
-    png_destroy_write_struct(&pngStruct, &pngInfo);
+    WriteUInt32BE(buffer + pos + 8, adler);
+    pos += WriteChunk(buffer + pos, "IDAT", 4);
+    pos += WriteChunk(buffer + pos, "IEND", 0);
 
-    *dst = handle.bufferPtr;
-    *dstSize = handle.bufferOffset;
+    *dst = static_cast<unsigned char *>(realloc(buffer, pos));
+    if (*dst == nullptr)
+        *dst = buffer;
+    *dstSize = pos;
 
     return 0;
 }
+
+int PngWrite(const float *src, unsigned char **dst, unsigned int *dstSize,
+             unsigned int width, unsigned int height, bool storeAs8bits)
+{
+    size_t count = static_cast<size_t>(width) * height * 4;
+    int status;
+    if (storeAs8bits)
+    {
+        std::vector<unsigned char> pixels(count);
+        for (size_t i = 0; i < count; i++)
+            pixels[i] = roundf(src[i] * 255.0f);
+        status = PngWriteBytes(pixels.data(), dst, dstSize, width, height, 8);
+    }
+    else
+    {
+        std::vector<unsigned short> pixels(count);
+        for (size_t i = 0; i < count; i++)
+            pixels[i] = roundf(src[i] * 65535.0f);
+        status = PngWriteBytes(reinterpret_cast<const unsigned char *>(pixels.data()),
+                               dst, dstSize, width, height, 16);
+    }
+    return status;
+}
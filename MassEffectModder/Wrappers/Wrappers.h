@@ -71,11 +71,24 @@ int ZstdCompress(BYTE *src, UINT32 src_len, BYTE **dst, UINT32 *dst_len, int com
 
 int LzxDecompress(BYTE *src, UINT32 src_len, BYTE *dst, const UINT32 *dst_len);
 
-int PngRead(BYTE *src, UINT32 srcSize,
-             float **dst, UINT32 *dstSize,
-             UINT32 *width, UINT32 *height, bool &source8Bits);
+typedef enum
+{
+    PngFilterNone = 0,
+    PngFilterSub,
+    PngFilterUp,
+    PngFilterAverage,
+    PngFilterPaeth,
+    PngFilterAdaptive
+} PngFilterMode;
+
+int PngReadBytes(BYTE *src, UINT32 srcSize,
+                 BYTE **dst, UINT32 *dstSize,
+                 UINT32 *width, UINT32 *height, int *bits, int *sourceBits = nullptr);
 int PngWrite(const float *src, BYTE **dst, UINT32 *dstSize,
               UINT32 width, UINT32 height, bool storeAs8bits = true);
+int PngWriteBytes(const BYTE *src, BYTE **dst, UINT32 *dstSize,
+                  UINT32 width, UINT32 height, int bits,
+                  int compressionLevel = -1, int filterMode = PngFilterAdaptive, int numThreads = 0);
 
 #define BLOCK_SIZE_4X4        16
 #define BLOCK_SIZE_4X4X4      64
@@ -93,12 +106,12 @@ void DxtcDecompressAlphaBlock(float alphaBlock[BLOCK_SIZE_4X4], UINT32 compresse
 
 int BC7InitializeLibrary();
 int BC7ShutdownLibrary();
-int BC7CreateEncoder(double quality, bool restrictColour, bool restrictAlpha, UINT32 modeMask, double performance, BC7BlockEncoder **encoder);
+int BC7CreateEncoder(float quality, bool restrictColour, bool restrictAlpha, UINT32 modeMask, float performance, BC7BlockEncoder **encoder);
 int BC7CreateDecoder(BC7BlockDecoder **decoder);
 int BC7DestoyEncoder(BC7BlockEncoder *encoder);
 int BC7DestoyDecoder(BC7BlockDecoder *decoder);
-int BC7CompressBlock(BC7BlockEncoder *encoder, double in[BLOCK_SIZE_4X4][4], BYTE *out);
-int BC7DecompressBlock(BC7BlockDecoder *decoder, BYTE *in, double out[BLOCK_SIZE_4X4][4]);
+int BC7CompressBlock(BC7BlockEncoder *encoder, float in[BLOCK_SIZE_4X4][4], BYTE *out);
+int BC7DecompressBlock(BC7BlockDecoder *decoder, BYTE *in, float out[BLOCK_SIZE_4X4][4]);
 
 void BacktraceGetFilename(char *dst, const char *src, int maxLen);
 int BacktraceGetInfoFromModule(char *moduleFilePath, UINT64 offset, char *sourceFile,